@@ -0,0 +1,79 @@
+#ifndef DATETIMECOLUMN_TEST_H
+#define DATETIMECOLUMN_TEST_H
+
+#include "DateTimeColumn.h"
+#include <QtTest>
+#include <cmath>
+
+/// Tests of parsing and formatting ISO 8601 date/times.
+class DateTimeColumn_Test
+		: public QObject
+{
+	Q_OBJECT
+
+protected:
+	//parses a date/time and returns the formatted value (or 'invalid')
+	static QString roundTrip(QString value)
+	{
+		qint64 ms;
+		char format;
+		if (!DateTimeColumn::parse(value, ms, format)) return "invalid";
+		return DateTimeColumn::toString(ms, format);
+	}
+
+	//parses a date/time and returns the milliseconds since epoch (or -1)
+	static qint64 ms(QString value)
+	{
+		qint64 ms;
+		char format;
+		if (!DateTimeColumn::parse(value, ms, format)) return -1;
+		return ms;
+	}
+
+private slots:
+	void roundTrips()
+	{
+		foreach(QString value, QStringList() << "2024-03-01" << "2024-03-01T12:30:00" << "2024-03-01 12:30:00.2" << "2024-03-01T12:30:00.250Z" << "2024-03-01T12:30" << "2024-03-01 12:30Z" << "1969-12-31T23:59:59.999" << "2000-02-29")
+		{
+			QCOMPARE(roundTrip(value), value);
+		}
+	}
+
+	void normalizedForms()
+	{
+		//fractions finer than milliseconds are truncated
+		QCOMPARE(roundTrip("2024-03-01T12:30:00.123456"), QString("2024-03-01T12:30:00.123"));
+		QCOMPARE(ms("2024-03-01T12:30:00.123456789"), ms("2024-03-01T12:30:00.123"));
+
+		//time zone offsets are converted to UTC
+		QCOMPARE(roundTrip("2024-03-01T12:30:00+02:00"), QString("2024-03-01T10:30:00Z"));
+		QCOMPARE(roundTrip("2024-03-01T01:30-0230"), QString("2024-03-01T04:00Z"));
+		QCOMPARE(roundTrip("2024-03-01T00:30:00+01"), QString("2024-02-29T23:30:00Z"));
+	}
+
+	void missingValues()
+	{
+		qint64 value;
+		char format;
+		QVERIFY(DateTimeColumn::parse("", value, format));
+		QCOMPARE(value, DateTimeColumn::MISSING);
+		QCOMPARE(DateTimeColumn::toString(DateTimeColumn::MISSING, 0), QString());
+
+		DateTimeColumn column;
+		column.appendString("2024-03-01");
+		column.appendString("");
+		QCOMPARE(column.string(1), QString());
+		QVERIFY(std::isnan(column.valuesAsDouble()[1]));
+		QCOMPARE(column.sortOrder(), QVector<int>() << 1 << 0);
+	}
+
+	void invalidValues()
+	{
+		foreach(QString value, QStringList() << " " << "2024-3-01" << "2024-02-30" << "2024-03-01T" << "2024-03-01T24:00" << "2024-03-01T12:3" << "2024-03-01T12:30:" << "2024-03-01T12:30.5" << "2024-03-01T12:30:00." << "2024-03-01T12:30+2" << "2024-03-01T12:30+02:" << "2024-03-01T12:30Zx")
+		{
+			QCOMPARE(roundTrip(value), QString("invalid"));
+		}
+	}
+};
+
+#endif // DATETIMECOLUMN_TEST_H
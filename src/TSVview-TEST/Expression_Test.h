@@ -0,0 +1,149 @@
+#ifndef EXPRESSION_TEST_H
+#define EXPRESSION_TEST_H
+
+#include "Expression.h"
+#include <QtTest>
+#include <cmath>
+#include <limits>
+
+/// Tests of the formula parser and the evaluation of formulas (operator precedence, NaN semantics, strings).
+class Expression_Test
+		: public QObject
+{
+	Q_OBJECT
+
+protected:
+	//dataset with a numeric, a string and a date/time column (row 1 contains NaN and missing values)
+	static void createData(DataSet& data)
+	{
+		const double nan = std::numeric_limits<double>::quiet_NaN();
+		data.addColumn("num", QVector<double>() << 4.0 << nan << -2.5, QVector<char>() << 0 << 0 << 1);
+		data.addColumn("name", QVector<QString>() << "chr1" << "" << "chrX");
+		data.addColumn("date", QVector<qint64>() << 86400000ll << DateTimeColumn::MISSING << 0ll, QVector<char>() << 0 << 0 << 0);
+	}
+
+	//evaluates a numeric formula for all rows
+	static QVector<double> evaluate(QString formula)
+	{
+		DataSet data;
+		createData(data);
+		Expression expression(formula, data);
+		if (expression.isString()) THROW(ArgumentException, "Formula '" + formula + "' is not numeric!");
+		return expression.evaluate(data);
+	}
+
+	//evaluates a numeric formula for the first row
+	static double value(QString formula)
+	{
+		return evaluate(formula)[0];
+	}
+
+	//evaluates a string formula for all rows
+	static QVector<QString> strings(QString formula)
+	{
+		DataSet data;
+		createData(data);
+		Expression expression(formula, data);
+		if (!expression.isString()) THROW(ArgumentException, "Formula '" + formula + "' is not a string formula!");
+		return expression.evaluateStrings(data);
+	}
+
+private slots:
+	void precedence()
+	{
+		QCOMPARE(value("1 + 2 * 3"), 7.0);
+		QCOMPARE(value("(1 + 2) * 3"), 9.0);
+		QCOMPARE(value("10 - 4 - 3"), 3.0);
+		QCOMPARE(value("12 / 2 / 3"), 2.0);
+		QCOMPARE(value("7 % 4 * 2"), 6.0);
+		QCOMPARE(value("-2^2"), -4.0);
+		QCOMPARE(value("(-2)^2"), 4.0);
+		QCOMPARE(value("2^3^2"), 512.0);
+		QCOMPARE(value("2**-1"), 0.5);
+		QCOMPARE(value("1 + 1 == 2"), 1.0);
+		QCOMPARE(value("1 < 2 == 1"), 1.0);
+		QCOMPARE(value("1 || 0 && 0"), 1.0);
+		QCOMPARE(value("!0 && 1"), 1.0);
+		QCOMPARE(value("0 ? 1 : 0 ? 2 : 3"), 3.0);
+		QCOMPARE(value("1 ? 2 : 3 + 4"), 2.0);
+	}
+
+	void functions()
+	{
+		QCOMPARE(value("max(1, 5, 3)"), 5.0);
+		QCOMPARE(value("min(4, -1)"), -1.0);
+		QCOMPARE(value("Math.abs(-3)"), 3.0);
+		QCOMPARE(value("pow(2, 10)"), 1024.0);
+		QCOMPARE(value("sqrt(16) + log2(8) + log10(100)"), 9.0);
+		QCOMPARE(value("round(2.5) + floor(-1.5) + ceil(1.2)"), 3.0);
+		QCOMPARE(value("if(1 > 2, 10, 20)"), 20.0);
+		QCOMPARE(value("length('abc') + number('1.5')"), 4.5);
+		QCOMPARE(value("contains('chr12', 'r1')"), 1.0);
+	}
+
+	void columns()
+	{
+		QVector<double> result = evaluate("[0] * 2 + [num]");
+		QCOMPARE(result.count(), 3);
+		QCOMPARE(result[0], 12.0);
+		QVERIFY(std::isnan(result[1]));
+		QCOMPARE(result[2], -7.5);
+
+		//date/time columns are milliseconds since epoch, missing values are NaN
+		result = evaluate("[date] / 86400000");
+		QCOMPARE(result[0], 1.0);
+		QVERIFY(std::isnan(result[1]));
+		QCOMPARE(result[2], 0.0);
+	}
+
+	void nanSemantics()
+	{
+		QVERIFY(std::isnan(value("nan + 1")));
+		QVERIFY(std::isnan(value("-nan")));
+		QVERIFY(std::isnan(value("nan < 1")));
+		QVERIFY(std::isnan(value("nan == nan")));
+		QVERIFY(std::isnan(value("!nan")));
+		QVERIFY(std::isnan(value("nan && 0")));
+		QVERIFY(std::isnan(value("nan || 1")));
+		QVERIFY(std::isnan(value("nan ? 1 : 2")));
+		QVERIFY(std::isnan(value("if(nan, 1, 2)")));
+		QVERIFY(std::isnan(value("min(1, nan)")));
+		QVERIFY(std::isnan(value("max(nan, 1)")));
+		QVERIFY(std::isnan(value("log(-1)")));
+
+		//rows with NaN values stay NaN, other rows are not affected
+		QVector<double> result = evaluate("[num] > 0 ? 1 : 0");
+		QCOMPARE(result[0], 1.0);
+		QVERIFY(std::isnan(result[1]));
+		QCOMPARE(result[2], 0.0);
+	}
+
+	void stringFormulas()
+	{
+		QCOMPARE(strings("concat([name], ':', [0])"), QVector<QString>() << "chr1:4" << ":nan" << "chrX:-2.5");
+		QCOMPARE(strings("upper([1]) + '_' + 1"), QVector<QString>() << "CHR1_1" << "_1" << "CHRX_1");
+		QCOMPARE(strings("substr([name], 3)"), QVector<QString>() << "1" << "" << "X");
+		QCOMPARE(strings("split('a;b;c', ';', 1)")[0], QString("b"));
+		QCOMPARE(strings("regex([name], 'chr(.+)', 1)")[2], QString("X"));
+		QCOMPARE(strings("[num] > 0 ? 'pos' : 'neg'"), QVector<QString>() << "pos" << "" << "neg");
+		QCOMPARE(strings("str([date])")[0], QString("1970-01-02"));
+
+		//numbers are formatted with 15 significant digits, independent of the locale
+		QCOMPARE(strings("str(0.1 + 0.2)")[0], QString("0.3"));
+		QCOMPARE(strings("str(1/3)")[0], QString("0.333333333333333"));
+		QCOMPARE(strings("str(1e20)")[0], QString("1e+20"));
+	}
+
+	void invalidFormulas()
+	{
+		QVERIFY_THROWS_EXCEPTION(ArgumentException, evaluate("1 +"));
+		QVERIFY_THROWS_EXCEPTION(ArgumentException, evaluate("(1 + 2"));
+		QVERIFY_THROWS_EXCEPTION(ArgumentException, evaluate("1 2"));
+		QVERIFY_THROWS_EXCEPTION(ArgumentException, evaluate("[3]"));
+		QVERIFY_THROWS_EXCEPTION(ArgumentException, evaluate("[unknown]"));
+		QVERIFY_THROWS_EXCEPTION(ArgumentException, evaluate("foo(1)"));
+		QVERIFY_THROWS_EXCEPTION(ArgumentException, evaluate("'a' * 2"));
+	}
+};
+
+#endif // EXPRESSION_TEST_H
@@ -0,0 +1,167 @@
+#ifndef FILEFORMAT_TEST_H
+#define FILEFORMAT_TEST_H
+
+#include "DataSet.h"
+#include "ArrowFile.h"
+#include "BgzfReader.h"
+#include "BgzfWriter.h"
+#include <QtTest>
+#include <QTemporaryDir>
+#include <cmath>
+#include <limits>
+
+/// Round-trip tests of the file formats (TSV, BGZF-compressed TSV, TSVB and Arrow IPC).
+class FileFormat_Test
+		: public QObject
+{
+	Q_OBJECT
+
+protected:
+	QTemporaryDir dir_;
+
+	//dataset with all column types, incl. NaN, empty strings, non-ASCII characters and missing date/times
+	static void createData(DataSet& data)
+	{
+		const double nan = std::numeric_limits<double>::quiet_NaN();
+		data.addColumn("num", QVector<double>() << 1.0 << -2.5 << nan << 1e10 << 0.125, QVector<char>() << 0 << 2 << 0 << 0 << 3);
+		data.addColumn("text", QVector<QString>() << "chr1" << "" << "äöü µ" << "with space" << "x");
+
+		QVector<qint64> times;
+		QVector<char> formats;
+		foreach(QString value, QStringList() << "2024-03-01" << "2024-03-01T12:30:00.250Z" << "" << "1969-12-31 23:59" << "2000-02-29T00:00:01")
+		{
+			qint64 ms;
+			char format;
+			if (!DateTimeColumn::parse(value, ms, format)) THROW(ProgrammingException, "Invalid test date/time '" + value + "'!");
+			times << ms;
+			formats << format;
+		}
+		data.addColumn("time", times, formats);
+	}
+
+	//compares types, headers and values. If @p exact is set, the string representations have to be equal, otherwise the native values.
+	static void compare(const DataSet& expected, const DataSet& actual, bool exact)
+	{
+		QCOMPARE(actual.columnCount(), expected.columnCount());
+		QCOMPARE(actual.rowCount(), expected.rowCount());
+		for (int c=0; c<expected.columnCount(); ++c)
+		{
+			QCOMPARE(actual.column(c).type(), expected.column(c).type());
+			QCOMPARE(actual.column(c).header(), expected.column(c).header());
+			for (int r=0; r<expected.rowCount(); ++r)
+			{
+				if (exact || expected.column(c).type()==BaseColumn::STRING)
+				{
+					QCOMPARE(actual.column(c).string(r), expected.column(c).string(r));
+				}
+				else if (expected.column(c).type()==BaseColumn::NUMERIC)
+				{
+					const double e = expected.numericColumn(c).value(r);
+					const double a = actual.numericColumn(c).value(r);
+					QVERIFY(a==e || (std::isnan(a) && std::isnan(e)));
+				}
+				else
+				{
+					QCOMPARE(actual.dateTimeColumn(c).value(r), expected.dateTimeColumn(c).value(r));
+				}
+			}
+		}
+	}
+
+	//stores the test data and loads it again
+	void roundTrip(QString filename, int compression_level, bool exact)
+	{
+		DataSet data;
+		createData(data);
+		const QString path = dir_.filePath(filename);
+		data.store(path, QList<int>(data.columnCount(), -1), compression_level);
+
+		DataSet loaded;
+		loaded.load(path);
+		compare(data, loaded, exact);
+	}
+
+private slots:
+	void initTestCase()
+	{
+		QVERIFY(dir_.isValid());
+	}
+
+	void tsv()
+	{
+		roundTrip("data.tsv", -1, true);
+	}
+
+	void tsvGz()
+	{
+		roundTrip("data.tsv.gz", 6, true);
+		QVERIFY(BgzfReader::isBgzf(dir_.filePath("data.tsv.gz")));
+	}
+
+	void tsvb()
+	{
+		roundTrip("data.tsvb", 0, true);
+		QVERIFY(DataSet::isBinary(dir_.filePath("data.tsvb")));
+		QCOMPARE(DataSet::fileHeaders(dir_.filePath("data.tsvb")), QStringList() << "num" << "text" << "time");
+	}
+
+	void tsvbCompressed()
+	{
+		roundTrip("data_compressed.tsvb", 6, true);
+	}
+
+	void tsvbColumnSubset()
+	{
+		DataSet data;
+		createData(data);
+		const QString path = dir_.filePath("subset.tsvb");
+		data.store(path, QList<int>(data.columnCount(), -1), 0);
+
+		DataSet loaded;
+		loaded.load(path, "", QStringList() << "time");
+		QCOMPARE(loaded.columnCount(), 1);
+		QCOMPARE(loaded.column(0).header(), QString("time"));
+		QCOMPARE(loaded.dateTimeColumn(0).values(), data.dateTimeColumn(2).values());
+	}
+
+	void arrow()
+	{
+		DataSet data;
+		createData(data);
+		const QString path = dir_.filePath("data.arrow");
+		data.storeAs(path, ExportFormat::ARROW);
+		QVERIFY(ArrowFile::isArrow(path));
+		QCOMPARE(DataSet::fileHeaders(path), QStringList() << "num" << "text" << "time");
+
+		//Arrow stores native values, i.e. the decimals and date/time formats are not kept
+		DataSet loaded;
+		loaded.load(path);
+		compare(data, loaded, false);
+	}
+
+	void bgzfBlocks()
+	{
+		//data of several blocks, incl. a partial last block
+		QByteArray data;
+		for (int i=0; data.size()<3*BgzfWriter::BLOCK_SIZE+1000; ++i)
+		{
+			data.append("line " + QByteArray::number(i) + "\t" + QByteArray::number(i * 7919 % 10007) + "\n");
+		}
+		const QString path = dir_.filePath("blocks.txt.gz");
+		BgzfWriter writer(path, 6);
+		writer.write(data.left(1000));
+		writer.write(data.mid(1000));
+		writer.close();
+
+		QVERIFY(BgzfReader::isBgzf(path));
+		BgzfReader reader(path);
+		QCOMPARE(reader.readAll(), data);
+
+		//the file ends with the BGZF EOF marker block
+		QFile file(path);
+		QVERIFY(file.open(QFile::ReadOnly));
+		QCOMPARE(file.readAll().right(28).toHex(), QByteArray("1f8b08040000000000ff0600424302001b0003000000000000000000"));
+	}
+};
+
+#endif // FILEFORMAT_TEST_H
@@ -0,0 +1,254 @@
+#ifndef KEYHASHING_TEST_H
+#define KEYHASHING_TEST_H
+
+#include "DataSet.h"
+#include "GroupBy.h"
+#include "Join.h"
+#include "ValueCounts.h"
+#include "RadixSort.h"
+#include <QtTest>
+#include <QHash>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+
+/// Tests of the hash kernels (duplicates, group-by, value counts and joins) against plain QHash-based implementations.
+class KeyHashing_Test
+		: public QObject
+{
+	Q_OBJECT
+
+protected:
+	//numeric key with NaN values, string key and numeric value. There are enough rows to group hash partitions in parallel.
+	DataSet data_;
+
+	//returns the key of a row formed by the numeric and the string key column (NaN values are equal)
+	QString key(int row) const
+	{
+		const double number = data_.numericColumn(0).value(row);
+		return (std::isnan(number) ? "nan" : QString::number(number)) + "\t" + data_.stringColumn(1).value(row);
+	}
+
+	//creates a dataset for joins: row id, string key and numeric value
+	static void createJoinData(DataSet& data, int rows, int keys, QString prefix)
+	{
+		QVector<double> ids;
+		QVector<QString> strings;
+		QVector<double> values;
+		for (int i=0; i<rows; ++i)
+		{
+			ids << i;
+			strings << "k" + QString::number((i * 7) % keys);
+			values << i * 10;
+		}
+		data.addColumn(prefix + "id", ids, QVector<char>(rows, 0));
+		data.addColumn(prefix + "key", strings);
+		data.addColumn(prefix + "value", values, QVector<char>(rows, 0));
+	}
+
+	//checks the result of a join of the test data (see createJoinData): row ids of the dataset and joined values (-1 for NaN)
+	static void checkJoin(Join::Type type, const QVector<QPair<int, int>>& expected)
+	{
+		DataSet data;
+		createJoinData(data, 20000, 500, "");
+		DataSet other;
+		createJoinData(other, 600, 400, "other_");
+		Join::run(data, QList<int>() << 1, other, QList<int>() << 1, QList<int>() << 2, type);
+
+		QCOMPARE(data.rowCount(), expected.count());
+		QCOMPARE(data.columnCount(), type==Join::ANTI ? 3 : 4);
+		for (int r=0; r<expected.count(); ++r)
+		{
+			QCOMPARE((int)data.numericColumn(0).value(r), expected[r].first);
+			if (type==Join::ANTI) continue;
+			const double value = data.numericColumn(3).value(r);
+			QCOMPARE(std::isnan(value) ? -1 : (int)value, expected[r].second);
+		}
+	}
+
+	//returns the expected join result (see checkJoin)
+	static QVector<QPair<int, int>> expectedJoin(Join::Type type)
+	{
+		QHash<QString, QVector<int>> other_values;
+		for (int i=0; i<600; ++i)
+		{
+			other_values["k" + QString::number((i * 7) % 400)] << i * 10;
+		}
+
+		QVector<QPair<int, int>> output;
+		for (int i=0; i<20000; ++i)
+		{
+			const QVector<int> values = other_values.value("k" + QString::number((i * 7) % 500));
+			if (values.isEmpty())
+			{
+				if (type==Join::LEFT) output << qMakePair(i, -1);
+				if (type==Join::ANTI) output << qMakePair(i, -1);
+			}
+			else if (type!=Join::ANTI)
+			{
+				foreach(int value, values)
+				{
+					output << qMakePair(i, value);
+				}
+			}
+		}
+		return output;
+	}
+
+private slots:
+	void initTestCase()
+	{
+		const int n = RadixSort::PARALLEL_MIN + 4321;
+		std::mt19937_64 rng(3);
+		QVector<double> numbers;
+		QVector<QString> strings;
+		QVector<double> values;
+		numbers.reserve(n);
+		strings.reserve(n);
+		values.reserve(n);
+		for (int i=0; i<n; ++i)
+		{
+			numbers << (rng()%50==0 ? std::numeric_limits<double>::quiet_NaN() : (double)(rng()%1000));
+			strings << "k" + QString::number(rng()%300);
+			values << (double)(rng()%100);
+		}
+		data_.addColumn("number", numbers, QVector<char>(n, 0));
+		data_.addColumn("string", strings);
+		data_.addColumn("value", values, QVector<char>(n, 0));
+	}
+
+	void firstRowsOfKeys()
+	{
+		//every third row is not grouped
+		const int n = data_.rowCount();
+		QBitArray rows(n, true);
+		for (int r=0; r<n; r+=3)
+		{
+			rows.clearBit(r);
+		}
+
+		QHash<QString, int> first_rows;
+		QVector<int> expected_first(n, -1);
+		QVector<int> expected_counts(n, 0);
+		for (int r=0; r<n; ++r)
+		{
+			if (!rows.testBit(r)) continue;
+			const int first = first_rows.value(key(r), r);
+			first_rows[key(r)] = first;
+			expected_first[r] = first;
+			++expected_counts[first];
+		}
+
+		QVector<int> counts;
+		QVector<int> first = data_.firstRowsOfKeys(QList<int>() << 0 << 1, counts, rows);
+		QCOMPARE(first, expected_first);
+		for (int r=0; r<n; ++r)
+		{
+			if (first[r]==r) QCOMPARE(counts[r], expected_counts[r]);
+		}
+	}
+
+	void uniqueAndDuplicateRows()
+	{
+		QHash<QString, int> key_counts;
+		for (int r=0; r<data_.rowCount(); ++r)
+		{
+			++key_counts[data_.stringColumn(1).value(r)];
+		}
+
+		QSet<QString> seen;
+		QBitArray expected_unique(data_.rowCount(), false);
+		QBitArray expected_duplicate(data_.rowCount(), false);
+		for (int r=0; r<data_.rowCount(); ++r)
+		{
+			const QString& value = data_.stringColumn(1).value(r);
+			if (!seen.contains(value))
+			{
+				seen << value;
+				expected_unique.setBit(r);
+			}
+			if (key_counts[value]>1) expected_duplicate.setBit(r);
+		}
+
+		QCOMPARE(data_.uniqueRows(QList<int>() << 1), expected_unique);
+		QCOMPARE(data_.duplicateRows(QList<int>() << 1), expected_duplicate);
+	}
+
+	void groupBy()
+	{
+		QHash<QString, int> groups;
+		QVector<int> group_rows;
+		QVector<int> counts;
+		QVector<double> sums;
+		for (int r=0; r<data_.rowCount(); ++r)
+		{
+			const QString k = key(r);
+			if (!groups.contains(k))
+			{
+				groups[k] = group_rows.count();
+				group_rows << r;
+				counts << 0;
+				sums << 0.0;
+			}
+			const int group = groups[k];
+			++counts[group];
+			sums[group] += data_.numericColumn(2).value(r);
+		}
+
+		DataSet output;
+		QList<GroupBy::Aggregation> aggregations;
+		aggregations << GroupBy::Aggregation{2, GroupBy::COUNT} << GroupBy::Aggregation{2, GroupBy::SUM};
+		GroupBy::run(data_, QList<int>() << 0 << 1, -1, aggregations, QBitArray(), output);
+
+		QCOMPARE(output.rowCount(), group_rows.count());
+		QCOMPARE(output.columnCount(), 4);
+		for (int g=0; g<group_rows.count(); ++g)
+		{
+			QCOMPARE(output.column(0).string(g), data_.column(0).string(group_rows[g]));
+			QCOMPARE(output.stringColumn(1).value(g), data_.stringColumn(1).value(group_rows[g]));
+			QCOMPARE(output.numericColumn(2).value(g), (double)counts[g]);
+			QCOMPARE(output.numericColumn(3).value(g), sums[g]);
+		}
+	}
+
+	void valueCounts()
+	{
+		//numeric column (hash tables) and string column with sort ranks (dictionary codes)
+		data_.stringColumn(1).sortRanks();
+		QVERIFY(data_.stringColumn(1).hasSortRanks());
+		foreach(int c, QList<int>() << 0 << 1)
+		{
+			QHash<QString, int> indices;
+			QVector<ValueCounts::Entry> expected;
+			for (int r=0; r<data_.rowCount(); ++r)
+			{
+				const QString value = data_.column(c).string(r);
+				if (!indices.contains(value))
+				{
+					indices[value] = expected.count();
+					expected << ValueCounts::Entry{r, 0};
+				}
+				++expected[indices[value]].count;
+			}
+			std::stable_sort(expected.begin(), expected.end(), [](const ValueCounts::Entry& a, const ValueCounts::Entry& b) { return a.count>b.count; });
+
+			QVector<ValueCounts::Entry> entries = ValueCounts::count(data_, c, QBitArray());
+			QCOMPARE(entries.count(), expected.count());
+			for (int i=0; i<expected.count(); ++i)
+			{
+				QCOMPARE(entries[i].row, expected[i].row);
+				QCOMPARE(entries[i].count, expected[i].count);
+			}
+		}
+	}
+
+	void joins()
+	{
+		checkJoin(Join::INNER, expectedJoin(Join::INNER));
+		checkJoin(Join::LEFT, expectedJoin(Join::LEFT));
+		checkJoin(Join::ANTI, expectedJoin(Join::ANTI));
+	}
+};
+
+#endif // KEYHASHING_TEST_H
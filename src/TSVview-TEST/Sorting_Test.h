@@ -0,0 +1,140 @@
+#ifndef SORTING_TEST_H
+#define SORTING_TEST_H
+
+#include "DataSet.h"
+#include "RadixSort.h"
+#include <QtTest>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <random>
+
+/// Tests of the radix sort, the multi-key sort and the string sort modes against std::stable_sort.
+class Sorting_Test
+		: public QObject
+{
+	Q_OBJECT
+
+protected:
+	//random doubles with duplicates, NaN, -0.0 and infinite values
+	static QVector<double> randomValues(int count)
+	{
+		std::mt19937_64 rng(42);
+		std::uniform_int_distribution<int> kind(0, 9);
+		std::uniform_real_distribution<double> real(-1e6, 1e6);
+		QVector<double> values;
+		values.reserve(count);
+		for (int i=0; i<count; ++i)
+		{
+			const int k = kind(rng);
+			if (k==0) values << std::numeric_limits<double>::quiet_NaN();
+			else if (k==1) values << (i%2==0 ? -0.0 : 0.0);
+			else if (k==2) values << (i%2==0 ? std::numeric_limits<double>::infinity() : -std::numeric_limits<double>::infinity());
+			else if (k<6) values << (double)(rng()%100); //duplicates
+			else values << real(rng);
+		}
+		return values;
+	}
+
+	//stable sort order with NaN values at the end (at the start if @p reverse is set)
+	static QVector<int> stableOrder(const QVector<double>& values, bool reverse)
+	{
+		QVector<int> order(values.count());
+		std::iota(order.begin(), order.end(), 0);
+		std::stable_sort(order.begin(), order.end(), [&values, reverse](int a, int b)
+		{
+			const double va = values[a];
+			const double vb = values[b];
+			if (std::isnan(va) || std::isnan(vb)) return reverse ? (std::isnan(va) && !std::isnan(vb)) : (!std::isnan(va) && std::isnan(vb));
+			return reverse ? va>vb : va<vb;
+		});
+		return order;
+	}
+
+	//sorts the values of a string column in the given sort mode
+	static QStringList sorted(const QStringList& values, StringColumn::SortMode mode)
+	{
+		StringColumn column;
+		column.setValues(values.toVector());
+		column.setSortMode(mode);
+		QStringList output;
+		foreach(int row, column.sortOrder())
+		{
+			output << values[row];
+		}
+		return output;
+	}
+
+private slots:
+	void radixSortSmall()
+	{
+		const QVector<double> values = randomValues(10000);
+		QCOMPARE(RadixSort::order(values), stableOrder(values, false));
+		QCOMPARE(RadixSort::order(values, true), stableOrder(values, true));
+	}
+
+	void radixSortParallel()
+	{
+		//enough values to sort chunks in parallel
+		const QVector<double> values = randomValues(RadixSort::PARALLEL_MIN + 12345);
+		QCOMPARE(RadixSort::order(values), stableOrder(values, false));
+		QCOMPARE(RadixSort::order(values, true), stableOrder(values, true));
+	}
+
+	void radixSortIntegers()
+	{
+		QVector<qint64> values = QVector<qint64>() << 5 << -3 << std::numeric_limits<qint64>::max() << 0 << std::numeric_limits<qint64>::min() << -3 << 5;
+		QVector<quint64> keys;
+		foreach(qint64 value, values)
+		{
+			keys << RadixSort::key(value);
+		}
+		QCOMPARE(RadixSort::order(keys), QVector<int>() << 4 << 1 << 5 << 3 << 0 << 6 << 2);
+		QCOMPARE(RadixSort::order(keys, true), QVector<int>() << 2 << 0 << 6 << 3 << 1 << 5 << 4);
+	}
+
+	void naturalSortKeys()
+	{
+		//numbers before text and by value, case is ignored. Values that are equal in natural order are ordered by their UTF-16 code units.
+		QStringList values = QStringList() << "chr10" << "chr2" << "b" << "Chr1" << "10" << "9" << "chr02" << "chr1" << "a";
+		QCOMPARE(sorted(values, StringColumn::NATURAL), QStringList() << "9" << "10" << "a" << "b" << "Chr1" << "chr1" << "chr02" << "chr2" << "chr10");
+		QCOMPARE(sorted(values, StringColumn::BINARY), QStringList() << "10" << "9" << "Chr1" << "a" << "b" << "chr02" << "chr1" << "chr10" << "chr2");
+
+		//leading zeros and long numbers
+		QVERIFY(StringColumn::naturalSortKey("x007") < StringColumn::naturalSortKey("x10"));
+		QVERIFY(StringColumn::naturalSortKey("123456789012345678901") > StringColumn::naturalSortKey("99999999999999999999"));
+	}
+
+	void multiKeySort()
+	{
+		//string key (ascending) and numeric key with NaN values (descending)
+		const int n = 100000;
+		std::mt19937_64 rng(7);
+		QVector<QString> strings;
+		QVector<double> numbers;
+		for (int i=0; i<n; ++i)
+		{
+			strings << "k" + QString::number(rng()%50);
+			numbers << (rng()%10==0 ? std::numeric_limits<double>::quiet_NaN() : (double)(rng()%20));
+		}
+		DataSet data;
+		data.addColumn("key", strings);
+		data.addColumn("value", numbers, QVector<char>(n, 0));
+
+		QVector<int> expected(n);
+		std::iota(expected.begin(), expected.end(), 0);
+		std::stable_sort(expected.begin(), expected.end(), [&](int a, int b)
+		{
+			if (strings[a]!=strings[b]) return strings[a]<strings[b];
+			const bool nan_a = std::isnan(numbers[a]);
+			const bool nan_b = std::isnan(numbers[b]);
+			if (nan_a || nan_b) return nan_a && !nan_b;
+			return numbers[a]>numbers[b];
+		});
+
+		QCOMPARE(data.sortOrder(QList<int>() << 0 << 1, QList<bool>() << false << true), expected);
+	}
+};
+
+#endif // SORTING_TEST_H
@@ -0,0 +1,60 @@
+# -------------------------------------------------
+# Unit tests of the TSVview data model (Qt Test)
+# -------------------------------------------------
+QT += core gui widgets concurrent testlib
+TARGET = TSVview-TEST
+TEMPLATE = app
+CONFIG += console testcase
+CONFIG -= app_bundle
+
+INCLUDEPATH += ../TSVview/Base
+INCLUDEPATH += ../TSVview/Statistics
+
+#include zlib library
+LIBS += -lz
+
+SOURCES += \
+    main.cpp \
+    ../TSVview/Base/Parameters.cpp \
+    ../TSVview/Base/CustomExceptions.cpp \
+    ../TSVview/Base/DataSet.cpp \
+    ../TSVview/Base/BaseColumn.cpp \
+    ../TSVview/Base/NumericColumn.cpp \
+    ../TSVview/Base/StringColumn.cpp \
+    ../TSVview/Base/DateTimeColumn.cpp \
+    ../TSVview/Base/RadixSort.cpp \
+    ../TSVview/Base/RowKeys.cpp \
+    ../TSVview/Base/IntervalIndex.cpp \
+    ../TSVview/Base/BgzfReader.cpp \
+    ../TSVview/Base/BgzfWriter.cpp \
+    ../TSVview/Base/ArrowFile.cpp \
+    ../TSVview/Base/TabixIndex.cpp \
+    ../TSVview/Base/PagedFile.cpp \
+    ../TSVview/Base/Filter.cpp \
+    ../TSVview/Base/GroupBy.cpp \
+    ../TSVview/Base/Join.cpp \
+    ../TSVview/Base/ValueCounts.cpp \
+    ../TSVview/Base/Expression.cpp \
+    ../TSVview/Base/VirtualColumn.cpp \
+    ../TSVview/Statistics/StatisticsSummary.cpp
+
+HEADERS += \
+    Expression_Test.h \
+    DateTimeColumn_Test.h \
+    FileFormat_Test.h \
+    Sorting_Test.h \
+    KeyHashing_Test.h \
+    ../TSVview/Base/Parameters.h \
+    ../TSVview/Base/DataSet.h \
+    ../TSVview/Base/BaseColumn.h \
+    ../TSVview/Base/NumericColumn.h \
+    ../TSVview/Base/StringColumn.h \
+    ../TSVview/Base/DateTimeColumn.h \
+    ../TSVview/Base/VirtualColumn.h
+
+#include cppCORE library
+INCLUDEPATH += $$PWD/../cppCORE
+LIBS += -L$$PWD/../../bin -lcppCORE
+
+#copy EXE to bin folder
+DESTDIR = $$PWD/../../bin
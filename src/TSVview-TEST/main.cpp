@@ -0,0 +1,37 @@
+#include <QCoreApplication>
+#include <QtTest>
+#include "Expression_Test.h"
+#include "DateTimeColumn_Test.h"
+#include "FileFormat_Test.h"
+#include "Sorting_Test.h"
+#include "KeyHashing_Test.h"
+
+//runs all test classes. Returns the number of failed tests.
+int main(int argc, char *argv[])
+{
+	QCoreApplication app(argc, argv);
+
+	int failed = 0;
+	{
+		Expression_Test test;
+		failed += QTest::qExec(&test, argc, argv);
+	}
+	{
+		DateTimeColumn_Test test;
+		failed += QTest::qExec(&test, argc, argv);
+	}
+	{
+		FileFormat_Test test;
+		failed += QTest::qExec(&test, argc, argv);
+	}
+	{
+		Sorting_Test test;
+		failed += QTest::qExec(&test, argc, argv);
+	}
+	{
+		KeyHashing_Test test;
+		failed += QTest::qExec(&test, argc, argv);
+	}
+
+	return failed;
+}
@@ -4,7 +4,9 @@ CONFIG += console
 #Library targets and depdendencies
 SUBDIRS = cppCORE\
         cppGUI\
-        TSVview
+        TSVview\
+        TSVview-TEST
 
 cppGUI.depends = cppCORE
 TSVview.depends = cppCORE cppGUI
+TSVview-TEST.depends = cppCORE
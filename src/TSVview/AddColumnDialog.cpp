@@ -41,6 +41,11 @@ bool AddColumnDialog::isFormula()
 	return ui->formula->isChecked();
 }
 
+bool AddColumnDialog::isVirtual()
+{
+	return ui->formula->isChecked() && ui->virtual_column->isChecked();
+}
+
 int AddColumnDialog::decimals()
 {
     return ui->decimals->value();
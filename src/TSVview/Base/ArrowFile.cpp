@@ -0,0 +1,988 @@
+#include "ArrowFile.h"
+#include "DateTimeColumn.h"
+#include "NumericColumn.h"
+#include "StringColumn.h"
+#include "Exceptions.h"
+#include <QFile>
+#include <QSaveFile>
+#include <QPair>
+#include <cstring>
+#include <cmath>
+#include <charconv>
+#include <algorithm>
+#include <functional>
+#include <limits>
+
+namespace
+{
+	const QByteArray ARROW_MAGIC("ARROW1");
+	const qint16 METADATA_V5 = 4;
+
+	//message header types
+	const quint8 HEADER_SCHEMA = 1;
+	const quint8 HEADER_DICTIONARY_BATCH = 2;
+	const quint8 HEADER_RECORD_BATCH = 3;
+
+	//field types (only the supported ones)
+	const quint8 TYPE_INT = 2;
+	const quint8 TYPE_FLOATING_POINT = 3;
+	const quint8 TYPE_UTF8 = 5;
+	const quint8 TYPE_BOOL = 6;
+	const quint8 TYPE_DATE = 8;
+	const quint8 TYPE_TIMESTAMP = 10;
+	const quint8 TYPE_LARGE_UTF8 = 20;
+
+	const qint64 MS_PER_DAY = 86400000;
+
+	qint64 alignTo8(qint64 value)
+	{
+		return (value + 7) & ~7ll;
+	}
+
+	//Read-only access to a flatbuffer table (see https://flatbuffers.dev/internals/). All accesses are bounds-checked.
+	class FlatTable
+	{
+	public:
+		FlatTable(const uchar* data, qint64 size, qint64 pos)
+			: data_(data)
+			, size_(size)
+			, pos_(pos)
+		{
+			check(pos, 4);
+			vtable_ = pos - read<qint32>(pos);
+			check(vtable_, 4);
+			vtable_size_ = read<quint16>(vtable_);
+			check(vtable_, vtable_size_);
+		}
+
+		//root table of a flatbuffer
+		static FlatTable root(const uchar* data, qint64 size)
+		{
+			if (size<4) THROW(FileParseException, "Invalid flatbuffer meta data in Arrow file!");
+			quint32 offset;
+			memcpy(&offset, data, 4);
+			return FlatTable(data, size, offset);
+		}
+
+		bool has(int field) const
+		{
+			return fieldOffset(field)!=0;
+		}
+		template<typename T>
+		T scalar(int field, T default_value) const
+		{
+			const int offset = fieldOffset(field);
+			if (offset==0) return default_value;
+			check(pos_ + offset, sizeof(T));
+			return read<T>(pos_ + offset);
+		}
+		FlatTable table(int field) const
+		{
+			return FlatTable(data_, size_, indirect(field));
+		}
+		QByteArray string(int field) const
+		{
+			if (!has(field)) return QByteArray();
+			const qint64 pos = indirect(field);
+			const quint32 length = read<quint32>(pos);
+			check(pos + 4, length);
+			return QByteArray((const char*)data_ + pos + 4, length);
+		}
+		int vectorLength(int field) const
+		{
+			if (!has(field)) return 0;
+			const quint32 length = read<quint32>(indirect(field));
+			if (length>(quint32)std::numeric_limits<int>::max()) THROW(FileParseException, "Invalid flatbuffer meta data in Arrow file!");
+			return length;
+		}
+		FlatTable vectorTable(int field, int index) const
+		{
+			const qint64 pos = vectorElement(field, index, 4);
+			return FlatTable(data_, size_, pos + read<quint32>(pos));
+		}
+		const uchar* vectorStruct(int field, int index, int struct_size) const
+		{
+			return data_ + vectorElement(field, index, struct_size);
+		}
+
+	private:
+		const uchar* data_;
+		qint64 size_;
+		qint64 pos_;
+		qint64 vtable_;
+		int vtable_size_;
+
+		int fieldOffset(int field) const
+		{
+			const int entry = 4 + 2*field;
+			if (entry+2>vtable_size_) return 0;
+			return read<quint16>(vtable_ + entry);
+		}
+		qint64 indirect(int field) const
+		{
+			const int offset = fieldOffset(field);
+			if (offset==0) THROW(FileParseException, "Missing field in flatbuffer meta data of Arrow file!");
+			const qint64 pos = pos_ + offset;
+			check(pos, 4);
+			const qint64 target = pos + read<quint32>(pos);
+			check(target, 4);
+			return target;
+		}
+		qint64 vectorElement(int field, int index, int element_size) const
+		{
+			if (index<0 || index>=vectorLength(field)) THROW(FileParseException, "Invalid flatbuffer meta data in Arrow file!");
+			const qint64 pos = indirect(field) + 4 + (qint64)index * element_size;
+			check(pos, element_size);
+			return pos;
+		}
+		void check(qint64 pos, qint64 bytes) const
+		{
+			if (pos<0 || bytes<0 || pos+bytes>size_) THROW(FileParseException, "Invalid flatbuffer meta data in Arrow file!");
+		}
+		template<typename T>
+		T read(qint64 pos) const
+		{
+			T value;
+			memcpy(&value, data_ + pos, sizeof(T));
+			return value;
+		}
+	};
+
+	//Minimal flatbuffer builder. As in the flatbuffers library, the buffer is built back to front, i.e. children have to be created before their parents.
+	class FlatBuilder
+	{
+	public:
+		FlatBuilder()
+			: buffer_()
+			, min_align_(1)
+			, table_start_(0)
+			, fields_()
+		{
+		}
+
+		//size of the buffer, which is used as offset of objects (from the end of the buffer)
+		quint32 size() const
+		{
+			return buffer_.size();
+		}
+
+		quint32 createString(const QByteArray& string)
+		{
+			align(4, string.size() + 1);
+			buffer_.prepend('\0');
+			buffer_.prepend(string);
+			push<quint32>(string.size());
+			return size();
+		}
+		quint32 createStructVector(const QByteArray& data, int count, int alignment)
+		{
+			align(4, data.size());
+			align(alignment, data.size());
+			buffer_.prepend(data);
+			push<quint32>(count);
+			return size();
+		}
+		quint32 createOffsetVector(const QVector<quint32>& offsets)
+		{
+			align(4, 4 * offsets.count());
+			for (int i=offsets.count()-1; i>=0; --i)
+			{
+				pushOffset(offsets[i]);
+			}
+			push<quint32>(offsets.count());
+			return size();
+		}
+
+		void startTable()
+		{
+			table_start_ = size();
+			fields_.clear();
+		}
+		template<typename T>
+		void addScalar(int field, T value)
+		{
+			push<T>(value);
+			fields_ << qMakePair(field, size());
+		}
+		void addOffset(int field, quint32 offset)
+		{
+			pushOffset(offset);
+			fields_ << qMakePair(field, size());
+		}
+		quint32 endTable()
+		{
+			//table: offset to vtable (patched below) and fields
+			push<qint32>(0);
+			const quint32 object = size();
+
+			//vtable: vtable size, table size and offset of each field in the table
+			int field_count = 0;
+			foreach(const auto& field, fields_)
+			{
+				field_count = std::max(field_count, field.first + 1);
+			}
+			QVector<quint16> offsets(field_count, 0);
+			foreach(const auto& field, fields_)
+			{
+				offsets[field.first] = (quint16)(object - field.second);
+			}
+			for (int i=field_count-1; i>=0; --i)
+			{
+				push<quint16>(offsets[i]);
+			}
+			push<quint16>((quint16)(object - table_start_));
+			push<quint16>((quint16)(4 + 2*field_count));
+
+			const qint32 vtable_offset = (qint32)(size() - object);
+			memcpy(buffer_.data() + buffer_.size() - object, &vtable_offset, 4);
+
+			return object;
+		}
+
+		QByteArray finish(quint32 root)
+		{
+			align(std::max(min_align_, 4), 4);
+			pushOffset(root);
+			return buffer_;
+		}
+
+	private:
+		QByteArray buffer_;
+		int min_align_;
+		quint32 table_start_;
+		QList<QPair<int, quint32>> fields_;
+
+		void align(int alignment, int additional = 0)
+		{
+			min_align_ = std::max(min_align_, alignment);
+			const int padding = (alignment - (int)((size() + additional) % alignment)) % alignment;
+			buffer_.prepend(padding, '\0');
+		}
+		template<typename T>
+		void push(T value)
+		{
+			align(sizeof(T));
+			buffer_.prepend((const char*)&value, sizeof(T));
+		}
+		void pushOffset(quint32 offset)
+		{
+			align(4);
+			push<quint32>(size() - offset + 4);
+		}
+	};
+
+	//field of the Arrow schema
+	struct Field
+	{
+		QString name;
+		quint8 type;
+		int bit_width; //INT
+		bool is_signed; //INT
+		int unit; //precision (FLOATING_POINT), unit (DATE, TIMESTAMP)
+		bool has_timezone; //TIMESTAMP
+		bool dictionary;
+		qint64 dictionary_id;
+		int index_bit_width;
+		bool index_signed;
+	};
+
+	//buffer of a record batch (absolute position in the file)
+	struct Buffer
+	{
+		const uchar* data;
+		qint64 length;
+	};
+
+	//number of decimals of the shortest representation that converts back to the same value
+	char decimalsOf(double value)
+	{
+		if (!std::isfinite(value)) return 0;
+
+		char buffer[400];
+		std::to_chars_result result = std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::fixed);
+		if (result.ec!=std::errc()) return 17;
+		const char* dot = std::find(buffer, result.ptr, '.');
+		if (dot==result.ptr) return 0;
+		return (char)std::min((qint64)(result.ptr - dot - 1), (qint64)17);
+	}
+
+	//column under construction
+	struct ColumnReader
+	{
+		Field field;
+		ArrowFile::Column column;
+		bool fraction; //DATETIME: any value with milliseconds
+	};
+}
+
+bool ArrowFile::isArrow(QString filename)
+{
+	QFile file(filename);
+	if (!file.open(QFile::ReadOnly)) return false;
+
+	return file.read(6)==ARROW_MAGIC;
+}
+
+QStringList ArrowFile::columnNames(QString filename)
+{
+	if (Q_BYTE_ORDER!=Q_LITTLE_ENDIAN) THROW(NotImplementedException, "Arrow files are only supported on little-endian systems!");
+
+	//map file (only the footer is accessed)
+	QFile file(filename);
+	if (!file.open(QFile::ReadOnly)) THROW(FileAccessException, "Could not open file '" + filename + "' for reading.");
+	const qint64 file_size = file.size();
+	const uchar* data = file_size>=22 ? file.map(0, file_size) : nullptr;
+	if (data==nullptr || QByteArray::fromRawData((const char*)data, 6)!=ARROW_MAGIC || QByteArray::fromRawData((const char*)data + file_size - 6, 6)!=ARROW_MAGIC)
+	{
+		THROW(FileParseException, "File '" + filename + "' is not an Arrow IPC file!");
+	}
+
+	//footer
+	qint32 footer_size;
+	memcpy(&footer_size, data + file_size - 10, 4);
+	if (footer_size<=0 || footer_size>file_size - 18) THROW(FileParseException, "Invalid footer in Arrow file '" + filename + "'!");
+	FlatTable footer = FlatTable::root(data + file_size - 10 - footer_size, footer_size);
+
+	//schema fields
+	QStringList output;
+	FlatTable schema = footer.table(1);
+	for (int i=0; i<schema.vectorLength(1); ++i)
+	{
+		output << QString::fromUtf8(schema.vectorTable(1, i).string(0));
+	}
+	return output;
+}
+
+QList<ArrowFile::Column> ArrowFile::read(QString filename, QByteArray& metadata)
+{
+	if (Q_BYTE_ORDER!=Q_LITTLE_ENDIAN) THROW(NotImplementedException, "Arrow files are only supported on little-endian systems!");
+
+	//map file
+	QFile file(filename);
+	if (!file.open(QFile::ReadOnly)) THROW(FileAccessException, "Could not open file '" + filename + "' for reading.");
+	const qint64 file_size = file.size();
+	const uchar* data = file_size>=22 ? file.map(0, file_size) : nullptr;
+	if (data==nullptr || QByteArray::fromRawData((const char*)data, 6)!=ARROW_MAGIC || QByteArray::fromRawData((const char*)data + file_size - 6, 6)!=ARROW_MAGIC)
+	{
+		THROW(FileParseException, "File '" + filename + "' is not an Arrow IPC file!");
+	}
+
+	//footer
+	qint32 footer_size;
+	memcpy(&footer_size, data + file_size - 10, 4);
+	if (footer_size<=0 || footer_size>file_size - 18) THROW(FileParseException, "Invalid footer in Arrow file '" + filename + "'!");
+	const uchar* footer_data = data + file_size - 10 - footer_size;
+	FlatTable footer = FlatTable::root(footer_data, footer_size);
+
+	//schema
+	FlatTable schema = footer.table(1);
+	if (schema.scalar<qint16>(0, 0)!=0) THROW(NotImplementedException, "Big-endian Arrow file '" + filename + "' is not supported!");
+	metadata.clear();
+	for (int i=0; i<schema.vectorLength(2); ++i)
+	{
+		FlatTable key_value = schema.vectorTable(2, i);
+		if (key_value.string(0)=="TSVVIEW") metadata = key_value.string(1);
+	}
+
+	QList<ColumnReader> columns;
+	for (int i=0; i<schema.vectorLength(1); ++i)
+	{
+		FlatTable field_table = schema.vectorTable(1, i);
+
+		Field field;
+		field.name = QString::fromUtf8(field_table.string(0));
+		field.type = field_table.scalar<quint8>(2, 0);
+		field.bit_width = 0;
+		field.is_signed = false;
+		field.unit = 0;
+		field.has_timezone = false;
+		field.dictionary = field_table.has(4);
+		field.dictionary_id = 0;
+		field.index_bit_width = 32;
+		field.index_signed = true;
+		if (field_table.vectorLength(5)>0) THROW(NotImplementedException, "Column '" + field.name + "' of Arrow file '" + filename + "' has a nested type, which is not supported!");
+
+		FlatTable type = field_table.table(3);
+		if (field.type==TYPE_INT)
+		{
+			field.bit_width = type.scalar<qint32>(0, 0);
+			field.is_signed = type.scalar<quint8>(1, 0);
+			if (field.bit_width!=8 && field.bit_width!=16 && field.bit_width!=32 && field.bit_width!=64) THROW(FileParseException, "Invalid integer width in column '" + field.name + "' of Arrow file '" + filename + "'!");
+		}
+		else if (field.type==TYPE_FLOATING_POINT)
+		{
+			field.unit = type.scalar<qint16>(0, 0);
+			if (field.unit==0) THROW(NotImplementedException, "Column '" + field.name + "' of Arrow file '" + filename + "' has type float16, which is not supported!");
+		}
+		else if (field.type==TYPE_DATE)
+		{
+			field.unit = type.scalar<qint16>(0, 1);
+		}
+		else if (field.type==TYPE_TIMESTAMP)
+		{
+			field.unit = type.scalar<qint16>(0, 0);
+			field.has_timezone = !type.string(1).isEmpty();
+		}
+		else if (field.type!=TYPE_UTF8 && field.type!=TYPE_LARGE_UTF8 && field.type!=TYPE_BOOL)
+		{
+			THROW(NotImplementedException, "Column '" + field.name + "' of Arrow file '" + filename + "' has an unsupported type (" + QString::number(field.type) + ")!");
+		}
+
+		if (field.dictionary)
+		{
+			if (field.type!=TYPE_UTF8 && field.type!=TYPE_LARGE_UTF8) THROW(NotImplementedException, "Column '" + field.name + "' of Arrow file '" + filename + "' is dictionary-encoded with non-string values, which is not supported!");
+			FlatTable encoding = field_table.table(4);
+			field.dictionary_id = encoding.scalar<qint64>(0, 0);
+			if (encoding.has(1))
+			{
+				FlatTable index_type = encoding.table(1);
+				field.index_bit_width = index_type.scalar<qint32>(0, 32);
+				field.index_signed = index_type.scalar<quint8>(1, 0);
+			}
+		}
+
+		ColumnReader reader;
+		reader.field = field;
+		reader.column.name = field.name;
+		reader.column.type = (field.type==TYPE_UTF8 || field.type==TYPE_LARGE_UTF8) ? BaseColumn::STRING : ((field.type==TYPE_DATE || field.type==TYPE_TIMESTAMP) ? BaseColumn::DATETIME : BaseColumn::NUMERIC);
+		reader.fraction = false;
+		columns << reader;
+	}
+
+	//returns the record batch of a message block. The message body buffers are returned in @p buffers.
+	auto recordBatch = [&](int blocks_field, int block_index, quint8 expected_header, QVector<Buffer>& buffers, QVector<QPair<qint64, qint64>>& nodes) -> FlatTable
+	{
+		const uchar* block = footer.vectorStruct(blocks_field, block_index, 24);
+		qint64 offset, body_length;
+		qint32 meta_length;
+		memcpy(&offset, block, 8);
+		memcpy(&meta_length, block + 8, 4);
+		memcpy(&body_length, block + 16, 8);
+		if (offset<8 || meta_length<8 || body_length<0 || offset + meta_length + body_length>file_size) THROW(FileParseException, "Invalid record batch in Arrow file '" + filename + "'!");
+
+		//message meta data (with or without continuation marker)
+		qint32 prefix;
+		memcpy(&prefix, data + offset, 4);
+		const qint64 flatbuffer_start = offset + (prefix==-1 ? 8 : 4);
+		FlatTable message = FlatTable::root(data + flatbuffer_start, offset + meta_length - flatbuffer_start);
+		if (message.scalar<quint8>(1, 0)!=expected_header) THROW(FileParseException, "Unexpected message type in Arrow file '" + filename + "'!");
+		FlatTable header = message.table(2);
+		FlatTable batch = expected_header==HEADER_DICTIONARY_BATCH ? header.table(1) : header;
+		if (batch.has(3)) THROW(NotImplementedException, "Compressed Arrow file '" + filename + "' is not supported!");
+
+		//field nodes and buffers
+		nodes.clear();
+		for (int i=0; i<batch.vectorLength(1); ++i)
+		{
+			const uchar* node = batch.vectorStruct(1, i, 16);
+			qint64 length, null_count;
+			memcpy(&length, node, 8);
+			memcpy(&null_count, node + 8, 8);
+			nodes << qMakePair(length, null_count);
+		}
+		buffers.clear();
+		const uchar* body = data + offset + meta_length;
+		for (int i=0; i<batch.vectorLength(2); ++i)
+		{
+			const uchar* buffer = batch.vectorStruct(2, i, 16);
+			qint64 buffer_offset, buffer_length;
+			memcpy(&buffer_offset, buffer, 8);
+			memcpy(&buffer_length, buffer + 8, 8);
+			if (buffer_offset<0 || buffer_length<0 || buffer_offset + buffer_length>body_length) THROW(FileParseException, "Invalid buffer in Arrow file '" + filename + "'!");
+			buffers << Buffer{body + buffer_offset, buffer_length};
+		}
+
+		return header;
+	};
+
+	//decodes a string array (plain or large offsets)
+	auto decodeStrings = [&](const Buffer& validity, const Buffer& offsets, const Buffer& values, qint64 length, qint64 null_count, bool large, QVector<QString>& output)
+	{
+		if (length==0) return;
+		const int offset_size = large ? 8 : 4;
+		if (offsets.length<(length+1)*offset_size || (null_count>0 && validity.length>0 && validity.length*8<length)) THROW(FileParseException, "Invalid string buffer in Arrow file '" + filename + "'!");
+		for (qint64 r=0; r<length; ++r)
+		{
+			if (null_count>0 && validity.length>0 && !(validity.data[r/8] & (1 << (r%8))))
+			{
+				output << QString();
+				continue;
+			}
+
+			qint64 start, end;
+			if (large)
+			{
+				memcpy(&start, offsets.data + r*8, 8);
+				memcpy(&end, offsets.data + r*8 + 8, 8);
+			}
+			else
+			{
+				qint32 start32, end32;
+				memcpy(&start32, offsets.data + r*4, 4);
+				memcpy(&end32, offsets.data + r*4 + 4, 4);
+				start = start32;
+				end = end32;
+			}
+			if (start<0 || start>end || end>values.length) THROW(FileParseException, "Invalid string offsets in Arrow file '" + filename + "'!");
+			output << QString::fromUtf8((const char*)values.data + start, end - start);
+		}
+	};
+
+	//dictionaries
+	QHash<qint64, QVector<QString>> dictionaries;
+	QVector<Buffer> buffers;
+	QVector<QPair<qint64, qint64>> nodes;
+	for (int d=0; d<footer.vectorLength(2); ++d)
+	{
+		FlatTable header = recordBatch(2, d, HEADER_DICTIONARY_BATCH, buffers, nodes);
+		const qint64 id = header.scalar<qint64>(0, 0);
+		const bool delta = header.scalar<quint8>(2, 0);
+
+		const Field* field = nullptr;
+		foreach(const ColumnReader& column, columns)
+		{
+			if (column.field.dictionary && column.field.dictionary_id==id) field = &column.field;
+		}
+		if (field==nullptr) continue;
+		if (nodes.count()<1 || buffers.count()<3) THROW(FileParseException, "Invalid dictionary batch in Arrow file '" + filename + "'!");
+
+		QVector<QString>& values = dictionaries[id];
+		if (!delta) values.clear();
+		decodeStrings(buffers[0], buffers[1], buffers[2], nodes[0].first, nodes[0].second, field->type==TYPE_LARGE_UTF8, values);
+	}
+
+	//record batches
+	for (int b=0; b<footer.vectorLength(3); ++b)
+	{
+		recordBatch(3, b, HEADER_RECORD_BATCH, buffers, nodes);
+
+		int node_index = 0;
+		int buffer_index = 0;
+		for (int c=0; c<columns.count(); ++c)
+		{
+			ColumnReader& reader = columns[c];
+			const Field& field = reader.field;
+			ArrowFile::Column& column = reader.column;
+
+			const bool has_offsets = !field.dictionary && (field.type==TYPE_UTF8 || field.type==TYPE_LARGE_UTF8);
+			if (node_index>=nodes.count() || buffer_index + (has_offsets ? 3 : 2)>buffers.count()) THROW(FileParseException, "Record batch does not match schema in Arrow file '" + filename + "'!");
+			const qint64 length = nodes[node_index].first;
+			const qint64 null_count = nodes[node_index].second;
+			++node_index;
+			const Buffer validity = buffers[buffer_index++];
+			const Buffer values = buffers[buffer_index++];
+			if (null_count>0 && validity.length>0 && validity.length*8<length) THROW(FileParseException, "Invalid validity buffer in Arrow file '" + filename + "'!");
+			auto isNull = [&](qint64 r)
+			{
+				return null_count>0 && validity.length>0 && !(validity.data[r/8] & (1 << (r%8)));
+			};
+
+			//strings
+			if (has_offsets)
+			{
+				const Buffer data_buffer = buffers[buffer_index++];
+				decodeStrings(validity, values, data_buffer, length, null_count, field.type==TYPE_LARGE_UTF8, column.strings);
+				continue;
+			}
+
+			//integers (dictionary indices or values)
+			const int int_width = field.dictionary ? field.index_bit_width : (field.type==TYPE_INT ? field.bit_width : 0);
+			const bool int_signed = field.dictionary ? field.index_signed : field.is_signed;
+			auto integer = [&](qint64 r) -> qint64
+			{
+				if (int_width==8) return int_signed ? (qint64)(qint8)values.data[r] : (qint64)values.data[r];
+				if (int_width==16)
+				{
+					quint16 v;
+					memcpy(&v, values.data + r*2, 2);
+					return int_signed ? (qint64)(qint16)v : (qint64)v;
+				}
+				if (int_width==32)
+				{
+					quint32 v;
+					memcpy(&v, values.data + r*4, 4);
+					return int_signed ? (qint64)(qint32)v : (qint64)v;
+				}
+				qint64 v;
+				memcpy(&v, values.data + r*8, 8);
+				return v;
+			};
+
+			//check value buffer size
+			qint64 value_bits = int_width;
+			if (field.type==TYPE_BOOL) value_bits = 1;
+			if (field.type==TYPE_FLOATING_POINT) value_bits = field.unit==1 ? 32 : 64;
+			if (!field.dictionary && field.type==TYPE_DATE) value_bits = field.unit==0 ? 32 : 64;
+			if (!field.dictionary && field.type==TYPE_TIMESTAMP) value_bits = 64;
+			if (values.length*8<length*value_bits) THROW(FileParseException, "Invalid value buffer in column '" + field.name + "' of Arrow file '" + filename + "'!");
+
+			if (field.dictionary)
+			{
+				const QVector<QString>& dictionary = dictionaries[field.dictionary_id];
+				for (qint64 r=0; r<length; ++r)
+				{
+					if (isNull(r))
+					{
+						column.strings << QString();
+						continue;
+					}
+					qint64 index = integer(r);
+					if (index<0 || index>=dictionary.count()) THROW(FileParseException, "Invalid dictionary index in column '" + field.name + "' of Arrow file '" + filename + "'!");
+					column.strings << dictionary[index];
+				}
+			}
+			else if (column.type==BaseColumn::NUMERIC)
+			{
+				const qint64 start = column.numbers.count();
+				column.numbers.resize(start + length);
+				column.formats.resize(start + length);
+				double* numbers = column.numbers.data() + start;
+				char* decimals = column.formats.data() + start;
+				for (qint64 r=0; r<length; ++r)
+				{
+					if (isNull(r))
+					{
+						numbers[r] = NAN;
+						decimals[r] = 0;
+					}
+					else if (field.type==TYPE_FLOATING_POINT)
+					{
+						if (field.unit==1)
+						{
+							float v;
+							memcpy(&v, values.data + r*4, 4);
+							numbers[r] = v;
+						}
+						else
+						{
+							memcpy(&numbers[r], values.data + r*8, 8);
+						}
+						decimals[r] = decimalsOf(numbers[r]);
+					}
+					else if (field.type==TYPE_BOOL)
+					{
+						numbers[r] = (values.data[r/8] & (1 << (r%8))) ? 1.0 : 0.0;
+						decimals[r] = 0;
+					}
+					else
+					{
+						numbers[r] = (!int_signed && int_width==64) ? (double)(quint64)integer(r) : (double)integer(r);
+						decimals[r] = 0;
+					}
+				}
+			}
+			else //DATETIME
+			{
+				const qint64 start = column.datetimes.count();
+				column.datetimes.resize(start + length);
+				qint64* ms = column.datetimes.data() + start;
+				for (qint64 r=0; r<length; ++r)
+				{
+					if (isNull(r))
+					{
+						ms[r] = DateTimeColumn::MISSING;
+						continue;
+					}
+
+					if (field.type==TYPE_DATE && field.unit==0)
+					{
+						qint32 days;
+						memcpy(&days, values.data + r*4, 4);
+						ms[r] = days * MS_PER_DAY;
+					}
+					else
+					{
+						qint64 v;
+						memcpy(&v, values.data + r*8, 8);
+						if (field.type==TYPE_TIMESTAMP && field.unit==0) v *= 1000;
+						else if (field.type==TYPE_TIMESTAMP && field.unit==2) v = (v - ((v%1000 + 1000)%1000)) / 1000;
+						else if (field.type==TYPE_TIMESTAMP && field.unit==3) v = (v - ((v%1000000 + 1000000)%1000000)) / 1000000;
+						ms[r] = v;
+					}
+					if (field.type==TYPE_TIMESTAMP && ms[r]%1000!=0) reader.fraction = true;
+				}
+			}
+		}
+	}
+
+	//finalize columns
+	QList<Column> output;
+	for (int c=0; c<columns.count(); ++c)
+	{
+		ColumnReader& reader = columns[c];
+		Column& column = reader.column;
+		if (column.type==BaseColumn::DATETIME)
+		{
+			char format = 0;
+			if (reader.field.type==TYPE_TIMESTAMP)
+			{
+				format = DateTimeColumn::HAS_TIME;
+				if (reader.fraction) format |= 3 << 3;
+				if (reader.field.has_timezone) format |= DateTimeColumn::UTC_SUFFIX;
+			}
+			column.formats.fill(format, column.datetimes.count());
+		}
+		output << column;
+	}
+
+	return output;
+}
+
+void ArrowFile::write(QString filename, const QList<const BaseColumn*>& columns, const QByteArray& metadata)
+{
+	if (Q_BYTE_ORDER!=Q_LITTLE_ENDIAN) THROW(NotImplementedException, "Arrow files are only supported on little-endian systems!");
+
+	const int rows = columns.isEmpty() ? 0 : columns[0]->count();
+
+	//string columns with more than 2GB in a record batch need 64-bit offsets (large_utf8). UTF-8 needs at most 3 bytes per UTF-16 character.
+	QVector<bool> large(columns.count(), false);
+	for (int c=0; c<columns.count(); ++c)
+	{
+		if (columns[c]->type()!=BaseColumn::STRING) continue;
+
+		const QVector<QString>& values = dynamic_cast<const StringColumn*>(columns[c])->values();
+		for (int start=0; start<rows && !large[c]; start+=BATCH_ROWS)
+		{
+			qint64 bytes = 0;
+			for (int r=start; r<std::min(rows, start+BATCH_ROWS); ++r)
+			{
+				bytes += 3 * values[r].length();
+			}
+			large[c] = bytes>std::numeric_limits<qint32>::max();
+		}
+	}
+
+	//schema (written into the first message and the footer)
+	auto addSchema = [&](FlatBuilder& builder)
+	{
+		QVector<quint32> fields;
+		foreach(const BaseColumn* column, columns)
+		{
+			const quint32 name = builder.createString(column->header().toUtf8());
+			const quint32 children = builder.createOffsetVector(QVector<quint32>());
+
+			quint8 type_type;
+			builder.startTable();
+			if (column->type()==BaseColumn::NUMERIC)
+			{
+				type_type = TYPE_FLOATING_POINT;
+				builder.addScalar<qint16>(0, 2); //double precision
+			}
+			else if (column->type()==BaseColumn::DATETIME)
+			{
+				type_type = TYPE_TIMESTAMP;
+				builder.addScalar<qint16>(0, 1); //milliseconds
+			}
+			else
+			{
+				type_type = large[fields.count()] ? TYPE_LARGE_UTF8 : TYPE_UTF8;
+			}
+			const quint32 type = builder.endTable();
+
+			builder.startTable();
+			builder.addOffset(0, name);
+			builder.addOffset(3, type);
+			builder.addOffset(5, children);
+			builder.addScalar<quint8>(1, 1); //nullable
+			builder.addScalar<quint8>(2, type_type);
+			fields << builder.endTable();
+		}
+		const quint32 fields_vector = builder.createOffsetVector(fields);
+
+		quint32 metadata_vector = 0;
+		if (!metadata.isEmpty())
+		{
+			const quint32 key = builder.createString("TSVVIEW");
+			const quint32 value = builder.createString(metadata);
+			builder.startTable();
+			builder.addOffset(0, key);
+			builder.addOffset(1, value);
+			metadata_vector = builder.createOffsetVector(QVector<quint32>() << builder.endTable());
+		}
+
+		builder.startTable();
+		builder.addOffset(1, fields_vector);
+		if (metadata_vector!=0) builder.addOffset(2, metadata_vector);
+		builder.addScalar<qint16>(0, 0); //little endian
+		return builder.endTable();
+	};
+
+	//creates an encapsulated message
+	auto message = [](quint8 header_type, std::function<quint32(FlatBuilder&)> header, qint64 body_length)
+	{
+		FlatBuilder builder;
+		const quint32 header_offset = header(builder);
+		builder.startTable();
+		builder.addScalar<qint64>(3, body_length);
+		builder.addOffset(2, header_offset);
+		builder.addScalar<qint16>(0, METADATA_V5);
+		builder.addScalar<quint8>(1, header_type);
+		return builder.finish(builder.endTable());
+	};
+
+	QSaveFile file(filename);
+	if (!file.open(QFile::WriteOnly)) THROW(FileAccessException, "Could not open file '" + filename + "' for writing.");
+	auto write = [&](const char* data, qint64 size)
+	{
+		if (file.write(data, size)!=size) THROW(FileAccessException, "Could not write to file '" + filename + "'.");
+	};
+	auto pad = [&]()
+	{
+		static const char zeros[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+		write(zeros, alignTo8(file.pos()) - file.pos());
+	};
+	//writes a message with body and returns the block (offset, meta data length, body length)
+	QByteArray blocks;
+	auto writeMessage = [&](const QByteArray& meta_data, const QList<QByteArray>& body, bool add_block)
+	{
+		const qint64 offset = file.pos();
+		const qint32 continuation = -1;
+		const qint32 meta_length = (qint32)alignTo8(meta_data.size());
+		write((const char*)&continuation, 4);
+		write((const char*)&meta_length, 4);
+		write(meta_data.constData(), meta_data.size());
+		pad();
+		const qint64 body_start = file.pos();
+		foreach(const QByteArray& buffer, body)
+		{
+			write(buffer.constData(), buffer.size());
+			pad();
+		}
+
+		if (add_block)
+		{
+			const qint32 block_meta_length = 8 + meta_length;
+			const qint32 padding = 0;
+			const qint64 body_length = file.pos() - body_start;
+			blocks.append((const char*)&offset, 8);
+			blocks.append((const char*)&block_meta_length, 4);
+			blocks.append((const char*)&padding, 4);
+			blocks.append((const char*)&body_length, 8);
+		}
+	};
+
+	//magic
+	write(ARROW_MAGIC.constData(), 6);
+	pad();
+
+	//schema
+	writeMessage(message(HEADER_SCHEMA, addSchema, 0), QList<QByteArray>(), false);
+
+	//record batches
+	for (int start=0; start<rows; start+=BATCH_ROWS)
+	{
+		const int end = std::min(rows, start + BATCH_ROWS);
+		const qint64 length = end - start;
+
+		//body buffers (numeric data refers to the column data without copying)
+		QList<QByteArray> body;
+		QByteArray nodes;
+		QByteArray buffers;
+		qint64 body_length = 0;
+		auto addBuffer = [&](const QByteArray& buffer)
+		{
+			buffers.append((const char*)&body_length, 8);
+			const qint64 size = buffer.size();
+			buffers.append((const char*)&size, 8);
+			if (size>0) body << buffer;
+			body_length += alignTo8(size);
+		};
+		for (int c=0; c<columns.count(); ++c)
+		{
+			const BaseColumn* column = columns[c];
+
+			//validity bitmap (only needed for missing date/time values)
+			qint64 null_count = 0;
+			QByteArray validity;
+			if (column->type()==BaseColumn::DATETIME)
+			{
+				const qint64* values = dynamic_cast<const DateTimeColumn*>(column)->values().constData() + start;
+				validity.fill((char)0xFF, (length + 7) / 8);
+				for (qint64 r=0; r<length; ++r)
+				{
+					if (values[r]!=DateTimeColumn::MISSING) continue;
+					validity[r/8] = (char)(validity[r/8] & ~(1 << (r%8)));
+					++null_count;
+				}
+				if (null_count==0) validity.clear();
+			}
+			nodes.append((const char*)&length, 8);
+			nodes.append((const char*)&null_count, 8);
+
+			addBuffer(validity);
+			if (column->type()==BaseColumn::NUMERIC)
+			{
+				const QVector<double>& values = dynamic_cast<const NumericColumn*>(column)->values();
+				addBuffer(QByteArray::fromRawData((const char*)(values.constData() + start), length * 8));
+			}
+			else if (column->type()==BaseColumn::DATETIME)
+			{
+				const QVector<qint64>& values = dynamic_cast<const DateTimeColumn*>(column)->values();
+				addBuffer(QByteArray::fromRawData((const char*)(values.constData() + start), length * 8));
+			}
+			else
+			{
+				QByteArray offsets;
+				QByteArray data;
+				offsets.append(QByteArray(large[c] ? 8 : 4, 0));
+				for (int chunk_start=start; chunk_start<end; chunk_start+=16384)
+				{
+					//chunks of rows (end positions are stored as int)
+					QByteArray chunk;
+					QVector<int> ends;
+					column->appendUtf8(chunk_start, std::min(end, chunk_start+16384), chunk, ends);
+					foreach(int chunk_end, ends)
+					{
+						const qint64 offset = data.size() + chunk_end;
+						if (large[c])
+						{
+							offsets.append((const char*)&offset, 8);
+						}
+						else
+						{
+							const qint32 offset32 = (qint32)offset;
+							offsets.append((const char*)&offset32, 4);
+						}
+					}
+					data.append(chunk);
+				}
+				addBuffer(offsets);
+				addBuffer(data);
+			}
+		}
+
+		QByteArray meta_data = message(HEADER_RECORD_BATCH, [&](FlatBuilder& builder)
+		{
+			const quint32 nodes_vector = builder.createStructVector(nodes, columns.count(), 8);
+			const quint32 buffers_vector = builder.createStructVector(buffers, buffers.size()/16, 8);
+			builder.startTable();
+			builder.addScalar<qint64>(0, length);
+			builder.addOffset(1, nodes_vector);
+			builder.addOffset(2, buffers_vector);
+			return builder.endTable();
+		}, body_length);
+		writeMessage(meta_data, body, true);
+	}
+
+	//end of stream marker
+	const qint64 eos = 0x00000000FFFFFFFFll;
+	write((const char*)&eos, 8);
+
+	//footer
+	FlatBuilder builder;
+	const quint32 schema = addSchema(builder);
+	const quint32 dictionaries = builder.createStructVector(QByteArray(), 0, 8);
+	const quint32 record_batches = builder.createStructVector(blocks, blocks.size()/24, 8);
+	builder.startTable();
+	builder.addOffset(1, schema);
+	builder.addOffset(2, dictionaries);
+	builder.addOffset(3, record_batches);
+	builder.addScalar<qint16>(0, METADATA_V5);
+	const QByteArray footer = builder.finish(builder.endTable());
+	const qint32 footer_size = footer.size();
+	write(footer.constData(), footer.size());
+	write((const char*)&footer_size, 4);
+	write(ARROW_MAGIC.constData(), 6);
+
+	if (!file.commit()) THROW(FileAccessException, "Could not write to file '" + filename + "': " + file.errorString());
+}
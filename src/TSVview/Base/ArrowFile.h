@@ -0,0 +1,41 @@
+#ifndef ARROWFILE_H
+#define ARROWFILE_H
+
+#include "BaseColumn.h"
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QList>
+#include <QByteArray>
+
+/// Reader/writer for the Apache Arrow IPC file format (Feather v2), see https://arrow.apache.org/docs/format/Columnar.html
+/// Only uncompressed files are supported. Flatbuffer meta data is read and written without the flatbuffers library.
+class ArrowFile
+{
+public:
+	///Column data of an Arrow file converted to TSVview column types.
+	struct Column
+	{
+		QString name;
+		BaseColumn::Type type;
+		QVector<double> numbers; //NUMERIC
+		QVector<qint64> datetimes; //DATETIME
+		QVector<char> formats; //NUMERIC: decimals, DATETIME: formats
+		QVector<QString> strings; //STRING
+	};
+
+	///Returns if the file starts with the Arrow file magic bytes.
+	static bool isArrow(QString filename);
+
+	///Returns the column names from the schema of an Arrow IPC file (the column data is not read). Throws an exception if the file cannot be read.
+	static QStringList columnNames(QString filename);
+	///Reads an Arrow IPC file. The schema meta data entry 'TSVVIEW' is returned in @p metadata (empty if not present). Throws an exception if the file cannot be read.
+	static QList<Column> read(QString filename, QByteArray& metadata);
+	///Writes an Arrow IPC file: numeric columns as float64, string columns as utf8 (large_utf8 if needed) and date/time columns as timestamp[ms]. @p metadata is stored in the schema meta data entry 'TSVVIEW'.
+	static void write(QString filename, const QList<const BaseColumn*>& columns, const QByteArray& metadata);
+
+	///Number of rows per record batch when writing.
+	static const int BATCH_ROWS = 1 << 20;
+};
+
+#endif // ARROWFILE_H
@@ -53,10 +53,20 @@ bool BaseColumn::setHeader(const QString& header)
   return true;
 }
 
+void BaseColumn::appendUtf8(int start, int end, QByteArray& output, QVector<int>& ends) const
+{
+	for (int r=start; r<end; ++r)
+	{
+		output.append(string(r).toUtf8());
+		ends << output.size();
+	}
+}
+
 QString BaseColumn::typeToString(Type type)
 {
     if (type==BaseColumn::NUMERIC) return "numeric";
     else if (type==BaseColumn::STRING) return "string";
+    else if (type==BaseColumn::DATETIME) return "datetime";
     else THROW(ProgrammingException, "Unhandled column type "+QString::number(type));
 }
 
@@ -64,5 +74,11 @@ BaseColumn::Type BaseColumn::stringToType(QString str)
 {
     if (str=="numeric") return BaseColumn::NUMERIC;
     else if (str=="string") return BaseColumn::STRING;
+    else if (str=="datetime") return BaseColumn::DATETIME;
     else THROW(ProgrammingException, "Unhandled column name "+str);
 }
+
+void BaseColumn::sort(bool reverse)
+{
+	applyPermutation(sortOrder(reverse));
+}
@@ -5,6 +5,11 @@
 #include <QObject>
 #include <QString>
 #include <QBitArray>
+#include <QVector>
+#include <QByteArray>
+#include <vector>
+#include <algorithm>
+#include <type_traits>
 
 class BaseColumn
 		: public QObject
@@ -16,7 +21,8 @@ public:
 	enum Type
 		{
 		NUMERIC,
-		STRING
+		STRING,
+		DATETIME
 		};
 
 	BaseColumn(Type type);
@@ -42,25 +48,51 @@ public:
 	virtual QString string(int row) const = 0;
 	virtual void setString(int row, const QString& value) = 0;
 	virtual void appendString(const QString& value) = 0;
+	/// Appends the UTF-8 representation of the rows [start, end) to @p output (same as string(row), but without creating temporary strings). The end position of each value in @p output is appended to @p ends.
+	virtual void appendUtf8(int start, int end, QByteArray& output, QVector<int>& ends) const;
 
 	virtual void resize(int rows) = 0;
 	virtual void reserve(int rows) = 0;
-	virtual void sort(bool reverse=false) = 0;
+	///Sorts the values of this column only (stable).
+	void sort(bool reverse=false);
+	///Returns the stable sort order of the rows (argsort), i.e. the row indices in sorted order.
+	virtual QVector<int> sortOrder(bool reverse=false) const = 0;
+	///Reorders the rows according to @p order (e.g. from sortOrder): row i is set to the former row order[i]. @p order has to be a permutation of all rows.
+	virtual void applyPermutation(const QVector<int>& order) = 0;
+	///Keeps only the given rows: row i is set to the former row rows[i]. Rows may be repeated (e.g. for joins).
+	virtual void gather(const QVector<int>& rows) = 0;
     virtual qsizetype count() const = 0;
     virtual qsizetype capacity() const = 0;
 	virtual BaseColumn* clone() const = 0;
+	///Returns if the values are computed from other columns when needed (see VirtualColumn).
+	virtual bool isVirtual() const
+	{
+		return false;
+	}
+	///Returns a column that holds the values of this column. Virtual columns are evaluated completely (within a DataSet::EvaluationScope), other columns return themselves.
+	virtual const BaseColumn& evaluated() const
+	{
+		return *this;
+	}
 
 	const Filter& filter() const
 	{
 	  return filter_;
 	}
 	virtual void setFilter(Filter filter) = 0;
-	virtual void matchFilter(QBitArray& array) const = 0;
+	///Removes rows that do not match the filter from @p array. Only the rows [start, end) are checked.
+	virtual void matchFilter(QBitArray& array, int start, int end) const = 0;
+	void matchFilter(QBitArray& array) const
+	{
+		matchFilter(array, 0, count());
+	}
 
     static QString typeToString(Type t);
     static Type stringToType(QString str);
 signals:
 	void dataChanged();
+	///Emitted when values of the rows [start, end) changed, but the number of rows did not.
+	void rowsChanged(int start, int end);
 	void filterChanged();
 	void headerChanged();
 
@@ -68,6 +100,124 @@ protected:
 	QString header_;
 	Type type_;
 	Filter filter_;
+
+	///Reorders @p values according to @p order (row i is set to the former row order[i]).
+	///Plain values are gathered into a temporary buffer and copied back (the buffer is freed afterwards, i.e. no memory is kept after sorting). Other values are moved along the cycles of the permutation, which needs no buffer.
+	template<typename T>
+	static void permute(QVector<T>& values, const QVector<int>& order)
+	{
+		const int count = values.count();
+		Q_ASSERT(order.count()==count);
+
+		if constexpr (std::is_trivially_copyable<T>::value)
+		{
+			std::vector<T> buffer(count);
+			const T* v = values.constData();
+			const int* o = order.constData();
+			for (int i=0; i<count; ++i)
+			{
+				buffer[i] = v[o[i]];
+			}
+			std::copy(buffer.cbegin(), buffer.cend(), values.begin());
+		}
+		else
+		{
+			std::vector<bool> done(count, false);
+			T* v = values.data();
+			for (int start=0; start<count; ++start)
+			{
+				if (done[start]) continue;
+
+				T first = std::move(v[start]);
+				int i = start;
+				while (true)
+				{
+					done[i] = true;
+					int next = order[i];
+					if (next==start)
+					{
+						v[i] = std::move(first);
+						break;
+					}
+					v[i] = std::move(v[next]);
+					i = next;
+				}
+			}
+		}
+	}
+
+	///Keeps only the given rows of @p values (row i is set to the former row rows[i]). If the rows are strictly increasing (e.g. filtered rows), values are moved to the front in place, which needs no buffer. Otherwise they are copied, since repeated rows must not be moved from.
+	template<typename T>
+	static void gatherValues(QVector<T>& values, const QVector<int>& rows)
+	{
+		bool in_place = rows.count()<=values.count();
+		for (int i=1; i<rows.count() && in_place; ++i)
+		{
+			if (rows[i]<=rows[i-1]) in_place = false;
+		}
+
+		if (in_place)
+		{
+			T* v = values.data();
+			for (int i=0; i<rows.count(); ++i)
+			{
+				Q_ASSERT(rows[i]<values.count());
+				if (rows[i]!=i) v[i] = std::move(v[rows[i]]);
+			}
+			values.resize(rows.count());
+			values.squeeze();
+		}
+		else
+		{
+			QVector<T> output(rows.count());
+			const T* v = values.constData();
+			T* o = output.data();
+			for (int i=0; i<rows.count(); ++i)
+			{
+				Q_ASSERT(rows[i]>=0 && rows[i]<values.count());
+				o[i] = v[rows[i]];
+			}
+			values = output;
+		}
+	}
+
+	///Applies a comparison to the values of the rows [start, end) and removes rows that do not match from @p array. If all rows are checked, the comparison is done on the plain value array and packed to bytes, which lets the compiler vectorize the loop.
+	template<typename T, typename Op>
+	static void matchValues(const QVector<T>& values, QBitArray& array, Op op, int start, int end)
+	{
+		const int count = values.count();
+		Q_ASSERT(array.count()==count);
+
+		//some rows only (e.g. after editing)
+		if (start!=0 || end!=count)
+		{
+			for (int r=start; r<end; ++r)
+			{
+				if (array.testBit(r) && !op(values[r])) array.clearBit(r);
+			}
+			return;
+		}
+
+		QByteArray bits((count+7)/8, 0);
+		uchar* b = reinterpret_cast<uchar*>(bits.data());
+		const T* v = values.constData();
+		int r = 0;
+		for (; r+8<=count; r+=8)
+		{
+			uchar byte = 0;
+			for (int i=0; i<8; ++i)
+			{
+				byte |= (uchar)(op(v[r+i]) ? 1 : 0) << i;
+			}
+			b[r/8] = byte;
+		}
+		for (; r<count; ++r)
+		{
+			if (op(v[r])) b[r/8] |= (uchar)(1 << (r%8));
+		}
+
+		array &= QBitArray::fromBits(bits.constData(), count);
+	}
 };
 
 #endif // BASECOLUMN_H
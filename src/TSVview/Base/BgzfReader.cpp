@@ -0,0 +1,149 @@
+#include "BgzfReader.h"
+#include "Exceptions.h"
+#include <zlib.h>
+#include <cstring>
+
+BgzfReader::BgzfReader(QString filename)
+	: filename_(filename)
+	, file_(filename)
+	, block_()
+	, block_address_(0)
+	, next_block_address_(0)
+	, block_offset_(0)
+{
+	if (!file_.open(QFile::ReadOnly))
+	{
+		THROW(FileAccessException, "Could not open file '" + filename + "' for reading.");
+	}
+}
+
+void BgzfReader::seek(quint64 virtual_offset)
+{
+	next_block_address_ = (qint64)(virtual_offset >> 16);
+	int offset = (int)(virtual_offset & 0xFFFF);
+
+	block_.clear();
+	block_offset_ = 0;
+	if (!readBlock())
+	{
+		if (offset==0) return;
+		THROW(FileParseException, "Invalid virtual offset " + QString::number(virtual_offset) + " in BGZF file '" + filename_ + "'!");
+	}
+	if (offset>block_.size()) THROW(FileParseException, "Invalid virtual offset " + QString::number(virtual_offset) + " in BGZF file '" + filename_ + "'!");
+
+	block_offset_ = offset;
+}
+
+bool BgzfReader::atEnd()
+{
+	//skip empty blocks (e.g. the EOF marker block)
+	while (block_offset_>=block_.size())
+	{
+		if (!readBlock()) return true;
+	}
+	return false;
+}
+
+QByteArray BgzfReader::readLine()
+{
+	QByteArray line;
+	while (!atEnd())
+	{
+		const char* data = block_.constData();
+		const char* start = data + block_offset_;
+		const int available = block_.size() - block_offset_;
+		const char* newline = (const char*)memchr(start, '\n', available);
+		if (newline!=nullptr)
+		{
+			line.append(start, (int)(newline-start));
+			block_offset_ = (int)(newline-data) + 1;
+			break;
+		}
+
+		line.append(start, available);
+		block_offset_ = block_.size();
+	}
+
+	if (line.endsWith('\r')) line.chop(1);
+
+	return line;
+}
+
+QByteArray BgzfReader::readAll()
+{
+	QByteArray output;
+	while (!atEnd())
+	{
+		output.append(block_.constData() + block_offset_, block_.size() - block_offset_);
+		block_offset_ = block_.size();
+	}
+	return output;
+}
+
+bool BgzfReader::isBgzf(QString filename)
+{
+	QFile file(filename);
+	if (!file.open(QFile::ReadOnly)) return false;
+
+	QByteArray header = file.read(16);
+	return header.size()==16 && (uchar)header[0]==31 && (uchar)header[1]==139 && (uchar)header[2]==8 && (header[3]&4) && header[12]=='B' && header[13]=='C';
+}
+
+bool BgzfReader::readBlock()
+{
+	//header: gzip header with 'BC' extra subfield containing the block size
+	if (!file_.seek(next_block_address_)) return false;
+	QByteArray header = file_.read(12);
+	if (header.isEmpty()) return false;
+	if (header.size()!=12 || (uchar)header[0]!=31 || (uchar)header[1]!=139 || (uchar)header[2]!=8 || !(header[3]&4))
+	{
+		THROW(FileParseException, "Invalid BGZF block header at offset " + QString::number(next_block_address_) + " in file '" + filename_ + "'. Was the file compressed with bgzip?");
+	}
+	const int xlen = (uchar)header[10] | ((uchar)header[11] << 8);
+	QByteArray extra = file_.read(xlen);
+	int block_size = -1;
+	for (int i=0; i+4<=extra.size(); )
+	{
+		const int slen = (uchar)extra[i+2] | ((uchar)extra[i+3] << 8);
+		if (extra[i]=='B' && extra[i+1]=='C' && slen==2 && i+6<=extra.size())
+		{
+			block_size = ((uchar)extra[i+4] | ((uchar)extra[i+5] << 8)) + 1;
+			break;
+		}
+		i += 4 + slen;
+	}
+	if (block_size==-1) THROW(FileParseException, "BGZF block without block size at offset " + QString::number(next_block_address_) + " in file '" + filename_ + "'!");
+
+	//compressed data and footer (CRC32, uncompressed size)
+	QByteArray data = file_.read(block_size - 12 - xlen);
+	if (data.size()!=block_size - 12 - xlen || data.size()<8) THROW(FileParseException, "Truncated BGZF block at offset " + QString::number(next_block_address_) + " in file '" + filename_ + "'!");
+	const uchar* footer = (const uchar*)data.constData() + data.size() - 8;
+	const quint32 crc = footer[0] | (footer[1] << 8) | (footer[2] << 16) | ((quint32)footer[3] << 24);
+	const int size = footer[4] | (footer[5] << 8) | (footer[6] << 16) | (footer[7] << 24);
+	if (size<0 || size>65536) THROW(FileParseException, "Invalid BGZF block size at offset " + QString::number(next_block_address_) + " in file '" + filename_ + "'!");
+
+	//decompress (raw deflate)
+	block_.resize(size);
+	if (size>0)
+	{
+		z_stream stream;
+		memset(&stream, 0, sizeof(stream));
+		stream.next_in = (Bytef*)data.constData();
+		stream.avail_in = data.size() - 8;
+		stream.next_out = (Bytef*)block_.data();
+		stream.avail_out = size;
+		int result = inflateInit2(&stream, -15);
+		if (result==Z_OK) result = inflate(&stream, Z_FINISH);
+		inflateEnd(&stream);
+		if (result!=Z_STREAM_END || (int)stream.total_out!=size || crc32(crc32(0L, Z_NULL, 0), (const Bytef*)block_.constData(), size)!=crc)
+		{
+			THROW(FileParseException, "Corrupt BGZF block at offset " + QString::number(next_block_address_) + " in file '" + filename_ + "'!");
+		}
+	}
+
+	block_address_ = next_block_address_;
+	next_block_address_ += block_size;
+	block_offset_ = 0;
+
+	return true;
+}
@@ -0,0 +1,45 @@
+#ifndef BGZFREADER_H
+#define BGZFREADER_H
+
+#include <QFile>
+#include <QByteArray>
+
+/// Reader for BGZF files (blocked gzip format used by bgzip/tabix) with random access via virtual file offsets.
+/// A virtual offset consists of the file offset of a compressed block (upper 48 bits) and the offset in the uncompressed block (lower 16 bits).
+class BgzfReader
+{
+public:
+	///Opens the file. Throws an exception if it cannot be opened.
+	BgzfReader(QString filename);
+
+	///Moves to the given virtual offset. Throws an exception if the offset is invalid.
+	void seek(quint64 virtual_offset);
+	///Returns the virtual offset of the current position.
+	quint64 tell() const
+	{
+		if (block_offset_>=block_.size()) return (quint64)next_block_address_ << 16;
+		return ((quint64)block_address_ << 16) | (quint64)block_offset_;
+	}
+	///Returns if the end of the file is reached.
+	bool atEnd();
+	///Reads the next line (without newline characters).
+	QByteArray readLine();
+	///Reads the (uncompressed) data from the current position to the end of the file.
+	QByteArray readAll();
+
+	///Returns if the file starts with a BGZF block header.
+	static bool isBgzf(QString filename);
+
+protected:
+	QString filename_;
+	QFile file_;
+	QByteArray block_;
+	qint64 block_address_;
+	qint64 next_block_address_;
+	int block_offset_;
+
+	//reads and decompresses the block at 'next_block_address_'. Returns false at the end of the file.
+	bool readBlock();
+};
+
+#endif // BGZFREADER_H
@@ -0,0 +1,119 @@
+#include "BgzfWriter.h"
+#include "Exceptions.h"
+#include <QThread>
+#include <QtConcurrent>
+#include <zlib.h>
+#include <cstring>
+#include <algorithm>
+
+namespace
+{
+	//appends a little-endian integer
+	void appendLE(QByteArray& output, quint32 value, int bytes)
+	{
+		for (int i=0; i<bytes; ++i)
+		{
+			output.append((char)((value >> (8*i)) & 0xFF));
+		}
+	}
+}
+
+BgzfWriter::BgzfWriter(QString filename, int level)
+	: filename_(filename)
+	, file_(filename)
+	, level_(std::max(-1, std::min(9, level)))
+	, buffer_()
+	, buffer_blocks_(4 * std::max(1, QThread::idealThreadCount()))
+{
+	if (!file_.open(QFile::WriteOnly))
+	{
+		THROW(FileAccessException, "Could not open file '" + filename + "' for writing.");
+	}
+}
+
+void BgzfWriter::write(const QByteArray& data)
+{
+	buffer_.append(data);
+	if (buffer_.size()>=buffer_blocks_ * BLOCK_SIZE) flush(false);
+}
+
+void BgzfWriter::close()
+{
+	flush(true);
+
+	//EOF marker (empty block)
+	QByteArray eof = compressBlock(nullptr, 0, level_);
+	if (file_.write(eof)!=eof.size()) THROW(FileAccessException, "Could not write to file '" + filename_ + "'.");
+
+	if (!file_.commit()) THROW(FileAccessException, "Could not write to file '" + filename_ + "': " + file_.errorString());
+}
+
+void BgzfWriter::flush(bool all)
+{
+	QList<QPair<int, int>> blocks;
+	int pos = 0;
+	while (buffer_.size()-pos>=BLOCK_SIZE || (all && pos<buffer_.size()))
+	{
+		int size = std::min(BLOCK_SIZE, (int)buffer_.size()-pos);
+		blocks << qMakePair(pos, size);
+		pos += size;
+	}
+	if (blocks.isEmpty()) return;
+
+	const char* data = buffer_.constData();
+	const int level = level_;
+	QList<QByteArray> compressed = QtConcurrent::blockingMapped<QList<QByteArray>>(blocks, [data, level](const QPair<int, int>& block)
+	{
+		return compressBlock(data + block.first, block.second, level);
+	});
+	foreach(const QByteArray& block, compressed)
+	{
+		if (file_.write(block)!=block.size()) THROW(FileAccessException, "Could not write to file '" + filename_ + "'.");
+	}
+
+	buffer_.remove(0, pos);
+}
+
+QByteArray BgzfWriter::compressBlock(const char* data, int size, int level)
+{
+	Q_ASSERT(size>=0 && size<=BLOCK_SIZE);
+
+	//raw deflate - falls back to stored blocks if the data is incompressible and does not fit into 64KB
+	const int max_deflated = 65536 - 18 - 8;
+	QByteArray deflated(compressBound(size) + 16, 0);
+	z_stream stream;
+	for (int attempt_level : {level, 0})
+	{
+		memset(&stream, 0, sizeof(stream));
+		int result = deflateInit2(&stream, attempt_level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY);
+		if (result!=Z_OK) THROW(ProgrammingException, "Could not initialize zlib compression with level " + QString::number(attempt_level) + "!");
+		stream.next_in = (Bytef*)data;
+		stream.avail_in = size;
+		stream.next_out = (Bytef*)deflated.data();
+		stream.avail_out = deflated.size();
+		result = deflate(&stream, Z_FINISH);
+		deflateEnd(&stream);
+		if (result!=Z_STREAM_END) THROW(ProgrammingException, "zlib compression of BGZF block failed!");
+		if ((int)stream.total_out<=max_deflated) break;
+	}
+	const int deflated_size = (int)stream.total_out;
+
+	//gzip header with 'BC' extra subfield containing the total block size minus 1
+	QByteArray output;
+	output.reserve(18 + deflated_size + 8);
+	output.append("\x1f\x8b\x08\x04", 4); //magic, deflate, FEXTRA
+	appendLE(output, 0, 4); //modification time
+	output.append('\0'); //extra flags
+	output.append('\xff'); //OS unknown
+	appendLE(output, 6, 2); //XLEN
+	output.append("BC", 2);
+	appendLE(output, 2, 2);
+	appendLE(output, 18 + deflated_size + 8 - 1, 2);
+
+	//compressed data and footer (CRC32, uncompressed size)
+	output.append(deflated.constData(), deflated_size);
+	appendLE(output, crc32(crc32(0L, Z_NULL, 0), (const Bytef*)data, size), 4);
+	appendLE(output, size, 4);
+
+	return output;
+}
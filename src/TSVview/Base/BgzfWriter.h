@@ -0,0 +1,46 @@
+#ifndef BGZFWRITER_H
+#define BGZFWRITER_H
+
+#include <QSaveFile>
+#include <QByteArray>
+#include <QList>
+
+/// Writer for BGZF files (blocked gzip format used by bgzip/tabix).
+/// The data is split into independent gzip blocks, which are compressed in parallel and written in order.
+/// The output can be read by gzip/zcat and can be indexed with tabix.
+/// Data is written to a temporary file, which replaces the target file when close() is called.
+class BgzfWriter
+{
+public:
+	///Maximum uncompressed size of a block (same as bgzip, guarantees that compressed blocks do not exceed 64KB).
+	static const int BLOCK_SIZE = 0xff00;
+
+	///Opens the file. @p level is the zlib compression level (0-9, -1 for the default). Throws an exception if the file cannot be opened.
+	BgzfWriter(QString filename, int level = -1);
+
+	///Appends data. Data is compressed and written when enough blocks for all threads are buffered.
+	void write(const QByteArray& data);
+	///Compresses and writes remaining data and the EOF marker block, then replaces the target file. If close() is not called, the target file is not changed.
+	void close();
+
+	///Compresses one block of at most BLOCK_SIZE bytes (gzip member with 'BC' extra subfield).
+	static QByteArray compressBlock(const char* data, int size, int level);
+
+protected:
+	QString filename_;
+	QSaveFile file_;
+	int level_;
+	QByteArray buffer_;
+	int buffer_blocks_;
+
+	//compresses buffered data in parallel and writes it. If @p all is false, only complete blocks are written.
+	void flush(bool all);
+
+private:
+	//not implemented
+	BgzfWriter(const BgzfWriter& rhs);
+	//not implemented
+	BgzfWriter& operator=(const BgzfWriter& rhs);
+};
+
+#endif // BGZFWRITER_H
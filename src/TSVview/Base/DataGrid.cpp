@@ -1,6 +1,5 @@
 #include <QMenu>
 #include <QInputDialog>
-#include <QJSEngine>
 #include <QMessageBox>
 #include <QApplication>
 #include <QClipboard>
@@ -13,6 +12,7 @@
 #include <algorithm>
 #include <math.h>
 #include <QTemporaryFile>
+#include <QFileDialog>
 #include "GrepDialog.h"
 #include "DataGrid.h"
 #include "CustomExceptions.h"
@@ -21,6 +21,9 @@
 #include "FilterDialog.h"
 #include "ReplacementDialog.h"
 #include "MergeDialog.h"
+#include "SortDialog.h"
+#include "Expression.h"
+#include "VirtualColumn.h"
 #include "GUIHelper.h"
 #include "AddColumnDialog.h"
 #include "TextItemEditDialog.h"
@@ -30,6 +33,7 @@ DataGrid::DataGrid(QWidget* parent)
 	: QTableWidget(parent)
 	, data_(0)
 	, preview_(0)
+	, view_rows_()
 {
 	setContextMenuPolicy(Qt::CustomContextMenu);
 	setSelectionBehavior(QAbstractItemView::SelectItems);
@@ -138,27 +142,22 @@ void DataGrid::setData(DataSet& dataset, int preview)
 
 	connect(data_, SIGNAL(headersChanged()), this, SLOT(renderHeaders()));
 	connect(data_, SIGNAL(columnChanged(int, bool)), this, SLOT(columnChanged(int, bool)));
+	connect(data_, SIGNAL(rowsChanged(int, int, int)), this, SLOT(rowsChanged(int, int, int)));
 	connect(data_, SIGNAL(dataChanged()), this, SLOT(render()));
 
 	render();
 }
 
-void DataGrid::renderColumn_(int column, QBitArray rows_to_render)
+void DataGrid::renderColumn_(int column)
 {
 	const BaseColumn& col = data_->column(column);
-	Q_ASSERT(rows_to_render.count()==col.count());
 
-	int r_filtered = 0;
-	for (int r=0; r<data_->rowCount(); ++r)
+	const int rows = std::min(rowCount(), (int)view_rows_.count());
+	for (int r=0; r<rows; ++r)
 	{
-		if (rows_to_render[r])
-		{
-			QTableWidgetItem* item = new QTableWidgetItem(col.string(r));
-			item->setFlags(Qt::ItemIsSelectable | Qt::ItemIsEnabled);
-			setItem(r_filtered, column, item);
-
-			++r_filtered;
-		}
+		QTableWidgetItem* item = new QTableWidgetItem(col.string(view_rows_[r]));
+		item->setFlags(Qt::ItemIsSelectable | Qt::ItemIsEnabled);
+		setItem(r, column, item);
 	}
 }
 
@@ -178,6 +177,7 @@ void DataGrid::render()
     setRowCount(0);
 
 	//abort if dataset is not set
+	view_rows_.clear();
 	if (data_==0)
 	{
 		clear();
@@ -193,6 +193,15 @@ void DataGrid::render()
 	QBitArray rows_to_render = data_->getRowFilter();
 	int rows = rows_to_render.count(true);
 
+	//mapping of grid rows to dataset rows (in display order)
+	const QVector<int>& order = data_->rowOrder();
+	view_rows_.reserve(rows);
+	for (int i=0; i<rows_to_render.count(); ++i)
+	{
+		int r = order.isEmpty() ? i : order[i];
+		if (rows_to_render[r]) view_rows_ << r;
+	}
+
 	//set table to new dimensions
 	if (preview_>0)
 	{
@@ -206,7 +215,7 @@ void DataGrid::render()
 	renderHeaders();
 	for (int c=0; c<cols; ++c)
 	{
-		renderColumn_(c, rows_to_render);
+		renderColumn_(c);
 	}
 
     //restore column width
@@ -249,9 +258,11 @@ QMenu* DataGrid::createStandardContextMenu()
 		QList<int> selected = selectedColumns();
 		int selected_count = selected.size();
 		int text_count = 0;
+		int numeric_count = 0;
 		for (int i=0; i<selected.size(); ++i)
 		{
 			text_count += (data_->column(selected[i]).type()==BaseColumn::STRING);
+			numeric_count += (data_->column(selected[i]).type()==BaseColumn::NUMERIC);
 		}
 
 		action = menu->addAction(QIcon(":/Icons/Paste.png"), "Paste column(s)", this, SLOT(pasteColumn_()));
@@ -267,11 +278,14 @@ QMenu* DataGrid::createStandardContextMenu()
 		action->setEnabled(selected_count==1);
 		action = edit_menu->addAction(QIcon(":/Icons/Merge.png"), "Merge", this, SLOT(mergeColumns_()));
 		action->setEnabled(selected_count>1);
+		action = edit_menu->addAction("Materialize virtual column", this, SLOT(materializeColumn_()));
+		action->setEnabled(selected_count==1 && data_->column(selected[0]).isVirtual());
         action = edit_menu->addAction("Set decimals", this, SLOT(setDecimals_()));
-        action->setEnabled(selected_count>0 && text_count==0);
+        action->setEnabled(selected_count>0 && numeric_count==selected_count);
 		action = edit_menu->addAction("Remove duplicates", this, SLOT(removeDuplicates_()));
+		action->setEnabled(selected_count>0);
 		action = edit_menu->addAction("Keep duplicates", this, SLOT(keepDuplicates_()));
-		action->setEnabled(selected_count==1);
+		action->setEnabled(selected_count>0);
 
 		QMenu* convert_menu = menu->addMenu("Convert to numeric column");
 		convert_menu->setEnabled(selected_count==1 && text_count==1);
@@ -280,15 +294,40 @@ QMenu* DataGrid::createStandardContextMenu()
 		action = convert_menu->addAction("By dictionary", this, SLOT(convertNumericDict_()));
 
 		QMenu* sort_menu = menu->addMenu(QIcon(":/Icons/Sort.png"), "Sort");
-		sort_menu->setEnabled(selected_count==1);
+		sort_menu->setEnabled(selected_count>0);
 		action = sort_menu->addAction("All columns (asc)", this, SLOT(sortByColumn_()));
+		action->setEnabled(selected_count==1);
 		action = sort_menu->addAction("All columns (desc)", this, SLOT(sortByColumnReverse_()));
+		action->setEnabled(selected_count==1);
+		action = sort_menu->addAction("All columns by multiple keys...", this, SLOT(sortByColumns_()));
 		sort_menu->addSeparator();
 		action = sort_menu->addAction("Single column (asc)", this, SLOT(sortColumn_()));
+		action->setEnabled(selected_count==1);
 		action = sort_menu->addAction("Single column (desc)", this, SLOT(sortColumnReverse_()));
+		action->setEnabled(selected_count==1);
+		sort_menu->addSeparator();
+		QMenu* mode_menu = sort_menu->addMenu("String order");
+		const bool mode_enabled = selected_count==1 && text_count==1 && !data_->column(selected[0]).isVirtual();
+		mode_menu->setEnabled(mode_enabled);
+		QStringList mode_names = QStringList() << "Binary (UTF-16)" << "Natural (e.g. chr2 before chr10)" << "Locale";
+		int current_mode = mode_enabled ? data_->stringColumn(selected[0]).sortMode() : -1;
+		for (int mode=StringColumn::BINARY; mode<=StringColumn::LOCALE; ++mode)
+		{
+			action = mode_menu->addAction(mode_names[mode], this, SLOT(setSortMode_()));
+			action->setCheckable(true);
+			action->setChecked(mode==current_mode);
+			action->setData(mode);
+		}
+		sort_menu->addSeparator();
+		action = sort_menu->addAction("Restore original order", this, SLOT(restoreRowOrder_()));
+		action->setEnabled(!data_->rowOrder().isEmpty());
+		action = sort_menu->addAction("Apply order to data", this, SLOT(applyRowOrder_()));
+		action->setEnabled(!data_->rowOrder().isEmpty());
 
 		action = menu->addAction(QIcon(":/Icons/Filter.png"), "Filter", this, SLOT(editFilter_()));
 		action->setEnabled(selected_count==1);
+		action = menu->addAction(QIcon(":/Icons/Filter.png"), "Filter by overlap with BED file (chr, start, end)", this, SLOT(filterRegions_()));
+		action->setEnabled(selected_count==3);
 	}
 
 	return menu;
@@ -347,7 +386,8 @@ void DataGrid::convertNumericNan_()
 {
 	//convert
 	int col_index = selectedColumns().at(0);
-    const QVector<QString>& data = data_->stringColumn(col_index).values();
+	DataSet::EvaluationScope scope(*data_);
+	const QVector<QString>& data = static_cast<const DataSet*>(data_)->stringColumn(col_index).values();
 	QVector<double> new_data;
     new_data.reserve(data.count());
     QVector<char> new_decimals;
@@ -380,7 +420,8 @@ void DataGrid::convertNumericSingle_()
 
 	//convert
 	int col_index = selectedColumns().at(0);
-	QVector<QString> data = data_->stringColumn(col_index).values();
+	DataSet::EvaluationScope scope(*data_);
+	const QVector<QString>& data = static_cast<const DataSet*>(data_)->stringColumn(col_index).values();
 	QVector<double> new_data;
     new_data.reserve(data.count());
     QVector<char> new_decimals;
@@ -406,7 +447,8 @@ void DataGrid::convertNumericDict_()
 	//create list of not-convertable values
 	int max_count = 20;
 	QSet<QString> not_convertable;
-	QVector<QString> data = data_->stringColumn(col_index).values();
+	DataSet::EvaluationScope scope(*data_);
+	const QVector<QString>& data = static_cast<const DataSet*>(data_)->stringColumn(col_index).values();
 	for (int i=0; i<data.count(); ++i)
 	{
         if (!Helper::isNumeric(data[i]))
@@ -463,6 +505,40 @@ void DataGrid::sortByColumn_(bool reverse)
 	data_->sortByColumn(column, reverse);
 }
 
+void DataGrid::sortByColumns_()
+{
+	SortDialog dialog(data_->headers(), selectedColumns(), this);
+	if (!dialog.exec()) return;
+
+	data_->sortByColumns(dialog.columns(), dialog.reverse());
+}
+
+void DataGrid::setSortMode_()
+{
+	QAction* action = qobject_cast<QAction*>(sender());
+	int column = selectedColumns()[0];
+	data_->stringColumn(column).setSortMode((StringColumn::SortMode)action->data().toInt());
+}
+
+void DataGrid::materializeColumn_()
+{
+	QApplication::setOverrideCursor(Qt::BusyCursor);
+	data_->materializeColumn(selectedColumns()[0]);
+	QApplication::restoreOverrideCursor();
+}
+
+void DataGrid::restoreRowOrder_()
+{
+	data_->restoreRowOrder();
+}
+
+void DataGrid::applyRowOrder_()
+{
+	QApplication::setOverrideCursor(Qt::BusyCursor);
+	data_->applyRowOrder();
+	QApplication::restoreOverrideCursor();
+}
+
 void DataGrid::sortColumnReverse_()
 {
 	sortColumn_(true);
@@ -492,74 +568,33 @@ void DataGrid::addColumn_()
 		return;
 	}
 
-	//formula
+	//formula: parsed once and evaluated column-wise (virtual columns are evaluated when their values are needed)
 	try
 	{
-		//make space around brackets
-		QString formula = dlg.value();
-		formula.replace("[", " [");
-		formula.replace("]", "] ");
-
-		//check the columns used in the formula
-		QStringList parts = formula.split(QRegularExpression("\\s+"));
-		QMap<int, QString> cols;
-		for(int i=0; i<parts.size(); ++i)
+		QApplication::setOverrideCursor(Qt::BusyCursor);
+		if (dlg.isVirtual())
 		{
-			QString part = parts[i];
-			if (part.startsWith("[") && part.endsWith("]"))
-			{
-				bool ok = true;
-				int index = part.mid(1, part.size()-2).toInt(&ok);
-
-				if (!ok)
-				{
-					THROW(Exception,"Cannot convert '" + part + "' to a column index.");
-				}
-				else if (index<0 || index>=data_->columnCount())
-				{
-					THROW(Exception,"Column index '" + part + "' is out of bounds.");
-				}
-				else if (data_->column(index).type()==BaseColumn::STRING)
-				{
-					THROW(Exception,"Column '" + part + "' is a string column.");
-				}
-				else if (!cols.contains(index))
-				{
-					cols[index] = part;
-				}
-			}
+			data_->addVirtualColumn(dlg.name(), dlg.value(), dlg.decimals(), dlg.insertBefore());
 		}
-
-		//caluculate new values
-		int rows_count = data_->rowCount();
-		QVector<double> new_values;
-		new_values.reserve(rows_count);
-		QJSEngine engine;
-		for (int row=0; row<rows_count; ++row)
+		else
 		{
-			QString row_formula = formula;
-
-			QMapIterator<int, QString> i(cols);
-			while (i.hasNext())
+			Expression expression(dlg.value(), *data_);
+			if (expression.isString())
 			{
-				i.next();
-				row_formula.replace(i.value(), QString::number(data_->numericColumn(i.key()).value(row), 'f', 10));
+				data_->addColumn(dlg.name(), expression.evaluateStrings(*data_), dlg.insertBefore());
 			}
-
-			QJSValue value = engine.evaluate(row_formula);
-			if (value.isError())
+			else
 			{
-				THROW(Exception,"The formula '" + row_formula + "' could not be evaluated.");
+				QVector<double> new_values = expression.evaluate(*data_);
+				data_->addColumn(dlg.name(), new_values, QVector<char>(new_values.count(), dlg.decimals()), dlg.insertBefore());
 			}
-
-            new_values << value.toNumber();
 		}
-
-        data_->addColumn(dlg.name(), new_values, QVector<char>(rows_count, dlg.decimals()), dlg.insertBefore());
+		QApplication::restoreOverrideCursor();
 	}
 	catch (Exception& e)
 	{
-        QMessageBox::warning(this, "Error while adding numeric column", e.message());
+		QApplication::restoreOverrideCursor();
+		QMessageBox::warning(this, "Error while adding column", e.message());
 	}
 }
 
@@ -692,8 +727,9 @@ void DataGrid::pasteColumn_(int index)
 		return;
 	}
 
-	//insert columns
-    data_->blockSignals(true);
+	//insert columns (re-rendered once when done). The clipboard rows are in display order.
+    DataSet::UpdateGuard update(*data_);
+    data_->applyRowOrder();
 	for (int i=0; i<data_tmp.columnCount(); ++i)
 	{
 		BaseColumn& col = data_tmp.column(i);
@@ -701,15 +737,15 @@ void DataGrid::pasteColumn_(int index)
 		{
             data_->addColumn(data_tmp.column(i).header(), data_tmp.numericColumn(i).values(), data_tmp.numericColumn(i).decimals(), index);
 		}
+		else if (col.type()==BaseColumn::DATETIME)
+		{
+			data_->addColumn(data_tmp.column(i).header(), data_tmp.dateTimeColumn(i).values(), data_tmp.dateTimeColumn(i).formats(), index);
+		}
 		else
 		{
             data_->addColumn(data_tmp.column(i).header(), data_tmp.stringColumn(i).values(), index);
 		}
 	}
-    data_->blockSignals(false);
-
-    //re-render
-    render();
 }
 
 void DataGrid::pasteDataset_()
@@ -725,11 +761,9 @@ void DataGrid::pasteDataset_()
     TextImportPreview preview(tmp_filename, "[clipboard]", false, this);
     if(!preview.exec()) return;
 
-	data_->blockSignals(true);
+	DataSet::UpdateGuard update(*data_);
     data_->import(tmp_filename, "[clipboard]", preview.parameters());
-    data_->blockSignals(false);
     data_->setModified(true, true);
-	render();
 }
 
 void DataGrid::keyPressEvent(QKeyEvent* event)
@@ -773,6 +807,7 @@ void DataGrid::keyPressEvent(QKeyEvent* event)
 					{
                         int col = selected_items[0]->column();
                         int row = correctRowIfFiltered(selected_items[0]->row());
+						if (data_->column(col).isVirtual()) data_->materializeColumn(col);
 						data_->column(col).setString(row, text);
 					}
 					catch (Exception& e)
@@ -800,6 +835,7 @@ void DataGrid::keyPressEvent(QKeyEvent* event)
 		{
 			int col = selectedItems()[0]->column();
 			int row = correctRowIfFiltered(selectedItems()[0]->row());
+			if (data_->column(col).isVirtual()) data_->materializeColumn(col);
 			data_->column(col).setString(row, "");
 
 			handled = true;
@@ -823,6 +859,10 @@ void DataGrid::renderHeaders()
 			font.setItalic(true);
 			item->setFont(font);
 		}
+		if (data_->column(c).isVirtual())
+		{
+			item->setToolTip("virtual column: " + static_cast<const VirtualColumn&>(data_->column(c)).formula());
+		}
 		setHorizontalHeaderItem(c, item);
 		item->setTextAlignment(Qt::AlignLeft);
 	}
@@ -833,65 +873,61 @@ void DataGrid::editFilter_()
 	editFilter(selectedColumns()[0]);
 }
 
-void DataGrid::removeFilter_()
-{
-	removeFilter(selectedColumns()[0]);
-}
-
-void DataGrid::removeDuplicates_()
+void DataGrid::filterRegions_()
 {
-    if (selectedColumns().count()==0) return;
-
-	int col = selectedColumns()[0];
+	QList<int> cols = selectedColumns();
+	if (cols.count()!=3) return;
 
-	//count values
-    QHash<QString, int> value_to_first_row;
-	for (int r=0; r<data_->rowCount(); ++r)
+	//check columns
+	if (data_->column(cols[1]).type()!=BaseColumn::NUMERIC || data_->column(cols[2]).type()!=BaseColumn::NUMERIC)
 	{
-		QString value = data_->column(col).string(r);
-        if (!value_to_first_row.contains(value))
-        {
-            value_to_first_row[value] = r;
-        }
+		QMessageBox::warning(this, "Region filter", "The second and third selected column (start, end) have to be numeric!");
+		return;
 	}
-
-	//remove duplicates
-	QSet<int> rows_to_keep;
-    for (auto it=value_to_first_row.begin(); it!=value_to_first_row.end(); ++it)
+	if (data_->column(cols[1]).header().isEmpty() || data_->column(cols[2]).header().isEmpty())
 	{
-        rows_to_keep << it.value();
+		QMessageBox::warning(this, "Region filter", "The start and end column need a header!");
+		return;
 	}
 
-	//reduce to rows without duplicates
-	data_->reduceToRows(rows_to_keep);
+	//select BED file
+	QString filename = QFileDialog::getOpenFileName(this, "Select BED file", Settings::path("path_open", true), "BED files (*.bed *.bed.gz);;All files (*.*)");
+	if (filename.isEmpty()) return;
+
+	//set filter on chromosome column
+	Filter filter;
+	filter.setType(Filter::REGION_OVERLAPS);
+	filter.setValue(Filter::regionValue(data_->column(cols[1]).header(), data_->column(cols[2]).header(), filename));
+	data_->column(cols[0]).setFilter(filter);
+
+	render();
 }
 
-void DataGrid::keepDuplicates_()
+void DataGrid::removeFilter_()
 {
-    if (selectedColumns().count()==0) return;
+	removeFilter(selectedColumns()[0]);
+}
 
-	int col = selectedColumns().at(0);
+void DataGrid::removeDuplicates_()
+{
+	QList<int> cols = selectedColumns();
+	if (cols.isEmpty()) return;
 
-	//count values
-	QHash<QString, QSet<int>> value_to_rows;
-	for (int r=0; r<data_->rowCount(); ++r)
-	{
-		QString value = data_->column(col).string(r);
-		value_to_rows[value].insert(r);
-	}
+	//keep the first row of each distinct value combination
+	QApplication::setOverrideCursor(Qt::BusyCursor);
+	data_->reduceToRows(data_->uniqueRows(cols));
+	QApplication::restoreOverrideCursor();
+}
 
-	//determine duplicates
-	QSet<int> rows_to_keep;
-	for (auto it=value_to_rows.begin(); it!=value_to_rows.end(); ++it)
-	{
-		if (it.value().count()>1)
-		{
-			rows_to_keep.unite(it.value());
-		}
-	}
+void DataGrid::keepDuplicates_()
+{
+	QList<int> cols = selectedColumns();
+	if (cols.isEmpty()) return;
 
-	//reduce to rows with duplicates
-	data_->reduceToRows(rows_to_keep);
+	//keep all rows with a value combination that occurs more than once
+	QApplication::setOverrideCursor(Qt::BusyCursor);
+	data_->reduceToRows(data_->duplicateRows(cols));
+	QApplication::restoreOverrideCursor();
 }
 
 void DataGrid::grepLines()
@@ -921,13 +957,7 @@ void DataGrid::grepLines()
 	if (operation!="contains") matches = ~matches;
 
 	//apply
-	QSet<int> rows_to_keep;
-	for (int r=0; r<matches.count(); ++r)
-	{
-        if (matches[r]) rows_to_keep << r;
-	}
-
-    data_->reduceToRows(rows_to_keep);
+	data_->reduceToRows(matches);
 }
 
 void DataGrid::editFilter(int column)
@@ -939,6 +969,40 @@ void DataGrid::editFilter(int column)
 	}
 }
 
+void DataGrid::filterValue(int column, QString value)
+{
+	Filter filter;
+	BaseColumn::Type type = data_->column(column).type();
+	if (type==BaseColumn::NUMERIC)
+	{
+		if (!std::isfinite(NumericColumn::toDouble(value, true).first))
+		{
+			QMessageBox::warning(this, "Filter value", "Cannot filter for the non-finite value '" + value + "'!");
+			return;
+		}
+		filter.setType(Filter::FLOAT_EXACT);
+		filter.setValue(value);
+	}
+	else if (type==BaseColumn::DATETIME)
+	{
+		if (value.isEmpty())
+		{
+			QMessageBox::warning(this, "Filter value", "Cannot filter for missing date/time values!");
+			return;
+		}
+		filter.setType(Filter::DATETIME_BETWEEN);
+		filter.setValue(value + "/" + value);
+	}
+	else
+	{
+		filter.setType(Filter::STRING_EXACT);
+		filter.setValue(value);
+	}
+	data_->column(column).setFilter(filter);
+
+	render();
+}
+
 void DataGrid::removeFilter(int column)
 {
 	data_->column(column).setFilter(Filter());
@@ -958,65 +1022,46 @@ void DataGrid::removeAllFilters()
 
 void DataGrid::reduceToFiltered()
 {
+	//paged mode: apply filters to all rows of the file
+	if (data_->isPaged())
+	{
+		if (QMessageBox::question(this, "Reduce to filtered", "Filters are applied to all " + QString::number(data_->fileRowCount()) + " rows of the file.\nAll matching rows are loaded into memory.\nDo you want to continue?")!=QMessageBox::Yes) return;
+
+		QApplication::setOverrideCursor(Qt::BusyCursor);
+		int skipped = 0;
+		try
+		{
+			//the grid, filter widget and title are updated once when done
+			DataSet::UpdateGuard update(*data_);
+			data_->loadFilteredRows(skipped);
+			data_->setModified(true, true);
+		}
+		catch (Exception& e)
+		{
+			QApplication::restoreOverrideCursor();
+			QMessageBox::warning(this, "Reduce to filtered", e.message());
+			return;
+		}
+		QApplication::restoreOverrideCursor();
+		if (skipped>0) QMessageBox::warning(this, "Reduce to filtered", QString::number(skipped) + " rows were skipped because the filters are not applicable to them (different column type).");
+		return;
+	}
+
 	QBitArray filtered_rows = data_->getRowFilter(false);
 	if (filtered_rows.count(true)==data_->rowCount())
 	{
 		return;
 	}
 
-	data_->blockSignals(true);
+	//the grid and filter widget are updated once when done
+	DataSet::UpdateGuard update(*data_);
+	data_->reduceToRows(filtered_rows);
 
+	//remove filters
 	for (int c=0; c<data_->columnCount(); ++c)
 	{
-		//numeric column
-		if (data_->column(c).type()==BaseColumn::NUMERIC)
-		{
-			NumericColumn& column = data_->numericColumn(c);
-
-			QVector<double> values;
-            values.reserve(filtered_rows.count());
-            QVector<char> decimals;
-            decimals.reserve(filtered_rows.count());
-			for (int r=0; r<filtered_rows.count(); ++r)
-			{
-				if (filtered_rows[r])
-				{
-					values.append(column.value(r));
-                    decimals.append(column.decimals(r));
-				}
-			}
-
-            column.setValues(values, decimals);
-		}
-		//string column
-		else
-		{
-			StringColumn& column = data_->stringColumn(c);
-
-			QVector<QString> values;
-			values.reserve(filtered_rows.count());
-			for (int r=0; r<filtered_rows.count(); ++r)
-			{
-				if (filtered_rows[r])
-				{
-					values.append(column.value(r));
-				}
-			}
-
-			column.setValues(values);
-		}
-
-		//remove filter
 		data_->column(c).setFilter(Filter());
 	}
-
-	data_->blockSignals(false);
-
-	// trigger filter widget update by setting the same value for "filters enabled"
-	data_->setFiltersEnabled(data_->filtersEnabled());
-
-	// trigger rendering (signal have been blocked)
-	render();
 }
 
 QVector< QPair<int, int> > DataGrid::findItems(QString text, Qt::CaseSensitivity case_sensitive, DataGrid::FindType type) const
@@ -1129,11 +1174,88 @@ void DataGrid::columnChanged(int column, bool until_end)
 
 		for (int c=column; c<end; ++c)
 		{
-			renderColumn_(c, data_->getRowFilter(false));
+			renderColumn_(c);
 		}
 	}
 }
 
+void DataGrid::rowsChanged(int column, int start, int end)
+{
+	//preview: only the first rows are shown
+	if (preview_>0)
+	{
+		render();
+		return;
+	}
+
+	//re-evaluate the filters of the changed rows only
+	QBitArray filter = data_->updateRowFilter(start, end);
+
+	//grid row of each dataset row (needed only if the rows are not displayed in the original order)
+	const bool ordered = !data_->rowOrder().isEmpty();
+	QVector<int> view_index;
+	if (ordered)
+	{
+		view_index.fill(-1, data_->rowCount());
+		for (int i=0; i<view_rows_.count(); ++i)
+		{
+			view_index[view_rows_[i]] = i;
+		}
+	}
+
+	//many rows are shown/hidden now (or any row when sorted): re-render everything
+	int toggled = 0;
+	for (int r=start; r<end; ++r)
+	{
+		bool shown = ordered ? view_index[r]!=-1 : std::binary_search(view_rows_.cbegin(), view_rows_.cend(), r);
+		if (filter.testBit(r)!=shown) ++toggled;
+	}
+	if (toggled>1000 || (ordered && toggled>0))
+	{
+		render();
+		return;
+	}
+
+	//update changed cells, insert/remove rows that are shown/hidden now
+	auto createItem = [](QString text)
+	{
+		QTableWidgetItem* item = new QTableWidgetItem(text);
+		item->setFlags(Qt::ItemIsSelectable | Qt::ItemIsEnabled);
+		return item;
+	};
+	for (int r=start; r<end; ++r)
+	{
+		if (ordered)
+		{
+			if (view_index[r]!=-1) setItem(view_index[r], column, createItem(data_->column(column).string(r)));
+			continue;
+		}
+
+		int view_row = std::lower_bound(view_rows_.cbegin(), view_rows_.cend(), r) - view_rows_.cbegin();
+		bool shown = view_row<view_rows_.count() && view_rows_[view_row]==r;
+		if (filter.testBit(r) && shown)
+		{
+			setItem(view_row, column, createItem(data_->column(column).string(r)));
+		}
+		else if (filter.testBit(r))
+		{
+			view_rows_.insert(view_row, r);
+			insertRow(view_row);
+			for (int c=0; c<data_->columnCount(); ++c)
+			{
+				setItem(view_row, c, createItem(data_->column(c).string(r)));
+			}
+		}
+		else if (shown)
+		{
+			view_rows_.remove(view_row);
+			removeRow(view_row);
+		}
+	}
+
+	if (toggled>0) emit rendered();
+}
+
 void DataGrid::editCurrentItem(QTableWidgetItem* item)
 {
 	if (preview_>0 || item==0)
@@ -1147,21 +1269,41 @@ void DataGrid::editCurrentItem(QTableWidgetItem* item)
 	//edit numeric columns
 	if (data_->column(col).type() == BaseColumn::NUMERIC)
 	{
-        NumericColumn& column = data_->numericColumn(col);
-        double value = column.value(row);
+        double value = data_->column(col).isVirtual() ? NumericColumn::toDouble(data_->column(col).string(row), true).first : data_->numericColumn(col).value(row);
 		double new_value = QInputDialog::getDouble(this, "Edit numeric item", "Value", value, -std::numeric_limits<double>::max(), std::numeric_limits<double>::max(), 5);
 		if (new_value != value)
 		{
-            column.setValue(row, new_value);
+			if (data_->column(col).isVirtual()) data_->materializeColumn(col);
+            data_->numericColumn(col).setValue(row, new_value);
+		}
+	}
+	//edit date/time column
+	else if (data_->column(col).type() == BaseColumn::DATETIME)
+	{
+		QString value = data_->column(col).string(row);
+		bool ok = true;
+		QString new_value = QInputDialog::getText(this, "Edit date/time item", "Value (ISO format)", QLineEdit::Normal, value, &ok);
+		if (ok && new_value != value)
+		{
+			try
+			{
+				if (data_->column(col).isVirtual()) data_->materializeColumn(col);
+				data_->dateTimeColumn(col).setString(row, new_value);
+			}
+			catch (Exception& e)
+			{
+				QMessageBox::warning(this, "Error editing date/time item", e.message());
+			}
 		}
 	}
 	//edit string column
 	else
 	{
 		TextItemEditDialog dlg(this);
-		dlg.setText(data_->stringColumn(col).value(row));
+		dlg.setText(data_->column(col).string(row));
 		if (dlg.exec()==QDialog::Accepted)
 		{
+			if (data_->column(col).isVirtual()) data_->materializeColumn(col);
 			data_->stringColumn(col).setValue(row, dlg.text());
 		}
 	}
@@ -1175,6 +1317,7 @@ void DataGrid::setDecimals_()
 
     foreach (int c, selectedColumns())
     {
+        if (data_->column(c).isVirtual()) data_->materializeColumn(c);
         NumericColumn& col = data_->numericColumn(c);
         col.setDecimals(QVector<char>(col.count(), decimals));
     }
@@ -1192,27 +1335,16 @@ QString DataGrid::itemText(int row, int col, bool is_numeric, QChar decimal_poin
 	return text;
 }
 
+int DataGrid::gridRow(int row) const
+{
+	return view_rows_.indexOf(row);
+}
+
 int DataGrid::correctRowIfFiltered(int row) const
 {
-	if (data_->filtersEnabled())
+	if (row>=0 && row<view_rows_.count())
 	{
-		QBitArray filter = data_->getRowFilter();
-
-		int r_filtered = -1;
-		for (int i=0; i<data_->rowCount(); ++i)
-		{
-			if (filter[i])
-			{
-				++r_filtered;
-			}
-
-			if (r_filtered==row)
-			{
-				row = i;
-
-				break;
-			}
-		}
+		return view_rows_[row];
 	}
 
 	return row;
@@ -1323,8 +1455,8 @@ void DataGrid::filtersFromString(QString filter_string)
 		}
 	}
 
-	//clear current filters
-	data_->blockSignals(true);
+	//clear current filters (the filter widget is updated once when done)
+	data_->beginUpdate();
 	for (int i=0; i<filters.count(); ++i)
 	{
 		data_->column(i).setFilter(Filter());
@@ -1337,7 +1469,7 @@ void DataGrid::filtersFromString(QString filter_string)
 
 		Filter filter;
 		filter.setType(Filter::stringToType(parts[1], false));
-		filter.setValue(parts[2]);
+		filter.setValue(parts.mid(2).join(":"));
 
 		int index = data_->indexOf(parts[0]);
 		try
@@ -1346,7 +1478,7 @@ void DataGrid::filtersFromString(QString filter_string)
 		}
 		catch(FilterTypeException& e)
 		{
-			QMessageBox::warning(this, "Load filter set", "Incompatible filter '" + parts[1] + ":" + parts[2] +"' for column '" + data_->column(index).headerOrIndex(index) + "'.\nError message: " + e.message());
+			QMessageBox::warning(this, "Load filter set", "Incompatible filter '" + parts[1] + ":" + filter.value() +"' for column '" + data_->column(index).headerOrIndex(index) + "'.\nError message: " + e.message());
 
 			//clear filter loaded so far
 			for (int i=0; i<filters.count(); ++i)
@@ -1358,10 +1490,10 @@ void DataGrid::filtersFromString(QString filter_string)
 			break;
 		}
 	}
-	data_->blockSignals(false);
-
-	// trigger rendering (signal have been blocked)
 	data_->setFiltersEnabled(true);
+	data_->endUpdate();
+
+	// trigger rendering (filter changes are not rendered automatically)
 	render();
 }
 
@@ -35,6 +35,8 @@ public:
 	SelectionInfo selectionInfo() const;
 	QList<int> selectedColumns() const;
 	QList<int> selectedRows() const;
+	///Returns the grid row of a dataset row (filters and display order applied) or -1 if the row is hidden by filters.
+	int gridRow(int row) const;
 
 	void setData(DataSet& dataset, int preview = 0);
 
@@ -62,6 +64,8 @@ signals:
 public slots:
 	void removeSelectedColumns();
 	void editFilter(int column);
+	///Sets an exact match filter for a value (in string representation) on a column.
+	void filterValue(int column, QString value);
 	void removeFilter(int column);
 	void removeAllFilters();
 	void reduceToFiltered();
@@ -88,13 +92,21 @@ protected slots:
 	void convertNumericDict_();
 	void sortColumn_(bool reverse = false);
 	void sortByColumn_(bool reverse = false);
+	void sortByColumns_();
+	void setSortMode_();
+	void materializeColumn_();
+	void restoreRowOrder_();
+	void applyRowOrder_();
 	void sortColumnReverse_();
 	void sortByColumnReverse_();
 	void editFilter_();
+	void filterRegions_();
 	void removeFilter_();
 	void removeDuplicates_();
 	void keepDuplicates_();
 	void columnChanged(int column, bool until_end);
+	///Updates the cells of the rows [start, end) of a column. Filters are re-evaluated for these rows only, and rows are inserted/removed if they are shown/hidden now.
+	void rowsChanged(int column, int start, int end);
 	void horizontalHeaderContextMenu(const QPoint&);
 	void verticalHeaderContextMenu(const QPoint&);
 	void editCurrentItem(QTableWidgetItem* item);
@@ -103,9 +115,11 @@ protected slots:
 protected:
 	DataSet* data_;
 	int preview_;
+	//dataset row of each grid row (rows can be hidden by filters or sorted, see DataSet::rowOrder)
+	QVector<int> view_rows_;
 
     void keyPressEvent(QKeyEvent* event);
-    void renderColumn_(int column, QBitArray rows_to_render = QBitArray());
+    void renderColumn_(int column);
 	QString itemText(int row, int col, bool is_numeric, QChar decimal_point);
 	int correctRowIfFiltered(int row) const;
 };
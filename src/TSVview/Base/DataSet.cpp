@@ -6,15 +6,47 @@
 #include <QMessageBox>
 #include "CustomExceptions.h"
 #include "VersatileTextStream.h"
+#include "TabixIndex.h"
+#include "BgzfReader.h"
+#include "BgzfWriter.h"
+#include "ArrowFile.h"
+#include "RadixSort.h"
+#include "RowKeys.h"
+#include "VirtualColumn.h"
 #include "Helper.h"
 #include <QApplication>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QDateTime>
+#include <random>
+#include <QThread>
+#include <QtConcurrent>
+#include <zlib.h>
+#include <cstring>
+#include <limits>
+#include <numeric>
 
 DataSet::DataSet()
 	: QObject(0)
 	, columns_()
+	, comments_()
+	, subset_()
+	, paged_file_()
+	, page_(0)
+	, sample_(false)
     , modified_(false)
+	, version_(0)
 	, filters_enabled_(true)
 	, filtered_rows_()
+	, update_depth_(0)
+	, update_rows_(0)
+	, update_columns_(0)
+	, changes_()
+	, evaluation_mutex_()
+	, evaluation_depth_(0)
+	, evaluated_columns_()
+	, row_order_()
+	, sort_orders_()
 {
 	columns_.reserve(100);
 }
@@ -33,16 +65,24 @@ void DataSet::clear(bool emit_signals)
 		delete(columns_[i]);
 	}
 	columns_.clear();
+	interval_index_.clear();
+	subset_.clear();
+	paged_file_.clear();
+	page_ = 0;
+	sample_ = false;
     modified_ = false;
     filters_enabled_ = true;
     filtered_rows_.clear();
+	row_order_.clear();
+	sort_orders_.clear();
 
 	if (emit_signals)
 	{
-        emit modificationStatusChanged(false);
-		emit filtersChanged();
-		emit headersChanged();
-		emit dataChanged();
+		if (updating()) changes_.modification = true;
+		else emit modificationStatusChanged(false);
+		emitFiltersChanged();
+		emitHeadersChanged();
+		emitDataChanged();
 	}
 }
 
@@ -56,7 +96,7 @@ QStringList DataSet::headers()
 	return output;
 }
 
-int DataSet::indexOf(const QString& name)
+int DataSet::indexOf(const QString& name) const
 {
 	for (int i=0; i<columns_.count(); ++i)
 	{
@@ -78,6 +118,10 @@ void DataSet::removeColumns(QSet<int> columns)
 		return;
 	}
 
+	//virtual columns keep their values if their source columns are removed
+	UpdateGuard update(*this);
+	materializeDependents(columns);
+
 	//sort coumns in reverse order
 	QList<int> column_list = Helper::setToList(columns, true, true);
 
@@ -90,9 +134,11 @@ void DataSet::removeColumns(QSet<int> columns)
         delete(columns_[col]);
         columns_.remove(col);
     }
+	interval_index_.clear();
+	sort_orders_.clear();
 
-	emit dataChanged();
-	emit filtersChanged();
+	emitDataChanged();
+	emitFiltersChanged();
     setModified(true);
 }
 
@@ -106,6 +152,7 @@ void DataSet::addColumn(QString header, const QVector<double>& data, const QVect
 	new_col->setHeader(header);
 
 	connect(new_col, SIGNAL(dataChanged()), this, SLOT(columnDataChanged()));
+	connect(new_col, SIGNAL(rowsChanged(int, int)), this, SLOT(columnRowsChanged(int, int)));
 	connect(new_col, SIGNAL(filterChanged()), this, SLOT(filterDataChanged()));
 	connect(new_col, SIGNAL(headerChanged()), this, SLOT(headerDataChanged()));
 
@@ -118,7 +165,7 @@ void DataSet::addColumn(QString header, const QVector<double>& data, const QVect
 		columns_.insert(index, new_col);
 	}
 
-    emit dataChanged();
+    emitDataChanged();
     setModified(true);
 }
 
@@ -131,6 +178,7 @@ void DataSet::addColumn(QString header, const QVector<QString>& data, int index)
 	new_col->setHeader(header);
 
 	connect(new_col, SIGNAL(dataChanged()), this, SLOT(columnDataChanged()));
+	connect(new_col, SIGNAL(rowsChanged(int, int)), this, SLOT(columnRowsChanged(int, int)));
 	connect(new_col, SIGNAL(filterChanged()), this, SLOT(filterDataChanged()));
 	connect(new_col, SIGNAL(headerChanged()), this, SLOT(headerDataChanged()));
 
@@ -143,10 +191,37 @@ void DataSet::addColumn(QString header, const QVector<QString>& data, int index)
 		columns_.insert(index, new_col);
 	}
 
-    emit dataChanged();
+    emitDataChanged();
     setModified(true);
 }
 
+void DataSet::addColumn(QString header, const QVector<qint64>& data, const QVector<char>& formats, int index)
+{
+	Q_ASSERT(data.size()==formats.size());
+	Q_ASSERT(rowCount()==0 || data.size()==rowCount());
+
+	DateTimeColumn* new_col = new DateTimeColumn();
+	new_col->setValues(data, formats);
+	new_col->setHeader(header);
+
+	connect(new_col, SIGNAL(dataChanged()), this, SLOT(columnDataChanged()));
+	connect(new_col, SIGNAL(rowsChanged(int, int)), this, SLOT(columnRowsChanged(int, int)));
+	connect(new_col, SIGNAL(filterChanged()), this, SLOT(filterDataChanged()));
+	connect(new_col, SIGNAL(headerChanged()), this, SLOT(headerDataChanged()));
+
+	if (index<0 || index>=data.size())
+	{
+		columns_.append(new_col);
+	}
+	else
+	{
+		columns_.insert(index, new_col);
+	}
+
+	emitDataChanged();
+	setModified(true);
+}
+
 void DataSet::replaceColumn(int index, QString header, const QVector<double>& data, const QVector<char>& decimals)
 {
     Q_ASSERT(data.size()==decimals.size());
@@ -158,122 +233,515 @@ void DataSet::replaceColumn(int index, QString header, const QVector<double>& da
 	new_col->setHeader(header);
 
 	connect(new_col, SIGNAL(dataChanged()), this, SLOT(columnDataChanged()));
+	connect(new_col, SIGNAL(rowsChanged(int, int)), this, SLOT(columnRowsChanged(int, int)));
+	connect(new_col, SIGNAL(filterChanged()), this, SLOT(filterDataChanged()));
+	connect(new_col, SIGNAL(headerChanged()), this, SLOT(headerDataChanged()));
+
+	//replace old column (virtual columns using it keep their values)
+	UpdateGuard update(*this);
+	materializeDependents(QSet<int>() << index);
+	BaseColumn* old_col = columns_[index];
+	columns_.replace(index, new_col);
+	delete old_col;
+	interval_index_.clear();
+	sort_orders_.clear();
+
+	emitDataChanged();
+	setModified(true);
+}
+
+void DataSet::replaceColumn(int index, QString header, const QVector<qint64>& data, const QVector<char>& formats)
+{
+	Q_ASSERT(data.size()==formats.size());
+	Q_ASSERT(rowCount()==0 || data.size()==rowCount());
+
+	DateTimeColumn* new_col = new DateTimeColumn();
+	new_col->setValues(data, formats);
+	new_col->setHeader(header);
+
+	connect(new_col, SIGNAL(dataChanged()), this, SLOT(columnDataChanged()));
+	connect(new_col, SIGNAL(rowsChanged(int, int)), this, SLOT(columnRowsChanged(int, int)));
 	connect(new_col, SIGNAL(filterChanged()), this, SLOT(filterDataChanged()));
 	connect(new_col, SIGNAL(headerChanged()), this, SLOT(headerDataChanged()));
 
-	//replace old column
+	//replace old column (virtual columns using it keep their values)
+	UpdateGuard update(*this);
+	materializeDependents(QSet<int>() << index);
 	BaseColumn* old_col = columns_[index];
 	columns_.replace(index, new_col);
 	delete old_col;
+	interval_index_.clear();
+	sort_orders_.clear();
+
+	emitDataChanged();
+	setModified(true);
+}
+
+void DataSet::addVirtualColumn(QString header, QString formula, char decimals, int index)
+{
+	VirtualColumn* new_col = new VirtualColumn(*this, formula, decimals);
+	new_col->setHeader(header);
+
+	connect(new_col, SIGNAL(dataChanged()), this, SLOT(columnDataChanged()));
+	connect(new_col, SIGNAL(rowsChanged(int, int)), this, SLOT(columnRowsChanged(int, int)));
+	connect(new_col, SIGNAL(filterChanged()), this, SLOT(filterDataChanged()));
+	connect(new_col, SIGNAL(headerChanged()), this, SLOT(headerDataChanged()));
+
+	if (index<0 || index>=columnCount())
+	{
+		columns_.append(new_col);
+	}
+	else
+	{
+		columns_.insert(index, new_col);
+	}
+
+	emitDataChanged();
+	setModified(true);
+}
+
+void DataSet::materializeColumn(int column)
+{
+	Q_ASSERT(column<columns_.size());
+	Q_ASSERT(columns_[column]->isVirtual());
+
+	BaseColumn* new_col = columns_[column]->clone();
+
+	connect(new_col, SIGNAL(dataChanged()), this, SLOT(columnDataChanged()));
+	connect(new_col, SIGNAL(rowsChanged(int, int)), this, SLOT(columnRowsChanged(int, int)));
+	connect(new_col, SIGNAL(filterChanged()), this, SLOT(filterDataChanged()));
+	connect(new_col, SIGNAL(headerChanged()), this, SLOT(headerDataChanged()));
+
+	//replace virtual column
+	BaseColumn* old_col = columns_[column];
+	columns_.replace(column, new_col);
+	delete old_col;
+	interval_index_.clear();
+	sort_orders_.clear();
 
-	emit dataChanged();
+	emitDataChanged();
 	setModified(true);
 }
 
+void DataSet::materializeDependents(const QSet<int>& columns)
+{
+	for (int c=0; c<columns_.count(); ++c)
+	{
+		if (!columns_[c]->isVirtual() || columns.contains(c)) continue;
+
+		foreach(int source, columns)
+		{
+			if (static_cast<const VirtualColumn*>(columns_[c])->sources().contains(columns_[source]))
+			{
+				materializeColumn(c);
+				break;
+			}
+		}
+	}
+}
+
 void DataSet::setModified(bool modified, bool force_emit)
 {
     bool changed = modified_!=modified;
 
     modified_ = modified;
+    if (modified) ++version_;
 
     if (changed || force_emit)
     {
-		emit modificationStatusChanged(modified_);
+		if (updating()) changes_.modification = true;
+		else emit modificationStatusChanged(modified_);
 	}
 }
 
-void DataSet::sortByColumn(int column, bool reverse)
+void DataSet::beginUpdate()
 {
-	Q_ASSERT(column<columns_.size());
+	if (update_depth_==0)
+	{
+		update_rows_ = rowCount();
+		update_columns_ = columnCount();
+	}
+	++update_depth_;
+}
+
+void DataSet::endUpdate()
+{
+	Q_ASSERT(update_depth_>0);
+	if (--update_depth_>0) return;
 
-	int size = rowCount();
-	QVector<int> indices(size);
+	//reset before emitting (slots may start a new transaction)
+	ChangeSet changes = changes_;
+	changes_ = ChangeSet();
+	if (rowCount()!=update_rows_ || columnCount()!=update_columns_) changes.structure = true;
 
-    //create temporary vector with column data and index //TODO move to column: QList<int> getSortedOrder() const
-	if (columns_[column]->type()==BaseColumn::NUMERIC)
+	if (changes.modification) emit modificationStatusChanged(modified_);
+	if (changes.headers) emit headersChanged();
+	if (changes.structure)
+	{
+		checkRowOrder();
+		emit dataChanged();
+	}
+	else
 	{
-		std::vector<std::pair<double, int> > tmp;
-		tmp.reserve(size);
-		QVector<double> col = dynamic_cast<NumericColumn*>(columns_[column])->values();
-		for (int i=0; i<size; ++i)
+		for (auto it=changes.rows.cbegin(); it!=changes.rows.cend(); ++it)
 		{
-			double value = col[i];
-			if (!BasicStatistics::isValidFloat(value)) value = std::numeric_limits<double>::max();
-			tmp.push_back(std::make_pair(value, i));
+			const QPair<int, int>& range = it.value();
+			if (range.first==0 && range.second==rowCount())
+			{
+				emit columnChanged(it.key(), false);
+			}
+			else
+			{
+				emit rowsChanged(it.key(), range.first, range.second);
+			}
 		}
+	}
+	if (changes.filters) emit filtersChanged();
+}
 
-		//sort the vector according to the value
-		if (!reverse)
-		{
-			std::sort(tmp.begin(), tmp.end());
-		}
-		else
-		{
-			std::sort(tmp.begin(), tmp.end(), std::greater<std::pair<double, int> >());
-		}
+void DataSet::beginEvaluation() const
+{
+	QMutexLocker locker(&evaluation_mutex_);
+	++evaluation_depth_;
+}
 
-		for (int i=0; i<size; ++i)
-		{
-			indices[i] = tmp[i].second;
-		}
+void DataSet::endEvaluation() const
+{
+	QList<QSharedPointer<const BaseColumn>> released;
+	{
+		QMutexLocker locker(&evaluation_mutex_);
+		Q_ASSERT(evaluation_depth_>0);
+		if (--evaluation_depth_>0) return;
+		released.swap(evaluated_columns_);
+	}
+
+	//release the values in the columns as well (not while the scope mutex is locked, because columns lock their cache while evaluating)
+	if (released.isEmpty()) return;
+	foreach(const BaseColumn* column, columns_)
+	{
+		if (column->isVirtual()) static_cast<const VirtualColumn*>(column)->releaseEvaluated();
+	}
+}
+
+bool DataSet::evaluating() const
+{
+	QMutexLocker locker(&evaluation_mutex_);
+	return evaluation_depth_>0;
+}
+
+void DataSet::keepEvaluated(QSharedPointer<const BaseColumn> column) const
+{
+	QMutexLocker locker(&evaluation_mutex_);
+	if (evaluation_depth_==0) THROW(ProgrammingException, "Virtual column '" + column->header() + "' evaluated outside of an evaluation scope!");
+	if (!evaluated_columns_.contains(column)) evaluated_columns_ << column;
+}
+
+void DataSet::ChangeSet::addRows(int column, int start, int end)
+{
+	if (rows.contains(column))
+	{
+		QPair<int, int>& range = rows[column];
+		range.first = std::min(range.first, start);
+		range.second = std::max(range.second, end);
 	}
 	else
 	{
-		std::vector<std::pair<QString, int> > tmp;
-		tmp.reserve(size);
-		QVector<QString> col = dynamic_cast<StringColumn*>(columns_[column])->values();
-		for (int i=0; i<size; ++i)
-		{
-			tmp.push_back(std::make_pair(col[i], i));
-		}
+		rows[column] = qMakePair(start, end);
+	}
+}
 
-		//sort the vector according to the value
-		if (!reverse)
-		{
-			std::sort(tmp.begin(), tmp.end());
-		}
-		else
-		{
-			std::sort(tmp.begin(), tmp.end(), std::greater<std::pair<QString, int> >());
-		}
+void DataSet::emitDataChanged()
+{
+	sort_orders_.clear();
+
+	if (updating()) changes_.structure = true;
+	else
+	{
+		checkRowOrder();
+		emit dataChanged();
+	}
+}
+
+void DataSet::checkRowOrder()
+{
+	if (!row_order_.isEmpty() && row_order_.count()!=rowCount())
+	{
+		row_order_.clear();
+	}
+}
+
+void DataSet::emitHeadersChanged()
+{
+	if (updating()) changes_.headers = true;
+	else emit headersChanged();
+}
+
+void DataSet::emitFiltersChanged()
+{
+	if (updating()) changes_.filters = true;
+	else emit filtersChanged();
+}
+
+void DataSet::emitColumnChanged(int column)
+{
+	if (updating()) changes_.addRows(column, 0, rowCount());
+	else emit columnChanged(column, false);
+}
+
+void DataSet::emitRowsChanged(int column, int start, int end)
+{
+	if (updating()) changes_.addRows(column, start, end);
+	else emit rowsChanged(column, start, end);
+}
+
+namespace
+{
+    //Converts a sort order to dense ranks: rank of each row in the sort order, equal values have the same rank.
+    template<typename T, typename Equal>
+    QVector<int> ranksFromOrder(const QVector<T>& values, const QVector<int>& order, Equal equal)
+    {
+        QVector<int> ranks(values.count());
+        int rank = -1;
+        for (int i=0; i<order.count(); ++i)
+        {
+            if (i==0 || !equal(values[order[i]], values[order[i-1]])) ++rank;
+            ranks[order[i]] = rank;
+        }
+        return ranks;
+    }
+
+    //Returns the dense ranks of the rows of a column for the given sort direction.
+    QVector<int> sortRanks(const BaseColumn& column, bool reverse)
+    {
+        if (column.type()==BaseColumn::NUMERIC)
+        {
+            return ranksFromOrder(static_cast<const NumericColumn&>(column.evaluated()).values(), column.sortOrder(reverse), [](double a, double b) { return a==b || (std::isnan(a) && std::isnan(b)); });
+        }
+        else if (column.type()==BaseColumn::DATETIME)
+        {
+            return ranksFromOrder(static_cast<const DateTimeColumn&>(column.evaluated()).values(), column.sortOrder(reverse), [](qint64 a, qint64 b) { return a==b; });
+        }
+
+        //strings: cached ranks of the column sort mode
+        QVector<int> ranks = static_cast<const StringColumn&>(column.evaluated()).sortRanks();
+        if (reverse)
+        {
+            for (int& rank : ranks) rank = -rank;
+        }
+        return ranks;
+    }
+
+    //Stable sort of an index array: chunks are sorted in parallel and then merged pairwise (also in parallel).
+    template<typename Compare>
+    void parallelStableSort(QVector<int>& indices, Compare comp)
+    {
+        const int n = indices.count();
+        const int chunks = n<RadixSort::PARALLEL_MIN ? 1 : std::max(1, QThread::idealThreadCount());
+        QVector<int> bounds;
+        QList<int> chunk_indices;
+        for (int c=0; c<=chunks; ++c)
+        {
+            bounds << (int)((qint64)n * c / chunks);
+            if (c<chunks) chunk_indices << c;
+        }
+
+        int* data = indices.data();
+        QtConcurrent::blockingMap(chunk_indices, [&](int c)
+        {
+            std::stable_sort(data + bounds[c], data + bounds[c+1], comp);
+        });
+        if (chunks==1) return;
+
+        //merge sorted chunks (std::merge takes equal elements from the first range first, which keeps the sort stable)
+        QVector<int> buffer(n);
+        int* src = data;
+        int* dst = buffer.data();
+        for (int width=1; width<chunks; width*=2)
+        {
+            QList<int> merges;
+            for (int c=0; c<chunks; c+=2*width)
+            {
+                merges << c;
+            }
+            QtConcurrent::blockingMap(merges, [&](int c)
+            {
+                int start = bounds[c];
+                int mid = bounds[std::min(c+width, chunks)];
+                int end = bounds[std::min(c+2*width, chunks)];
+                std::merge(src + start, src + mid, src + mid, src + end, dst + start, comp);
+            });
+            std::swap(src, dst);
+        }
+        if (src!=data) std::copy(src, src + n, data);
+    }
+}
+
+void DataSet::sortByColumn(int column, bool reverse)
+{
+	Q_ASSERT(column<columns_.size());
+
+	sortByColumns(QList<int>() << column, QList<bool>() << reverse);
+}
+
+void DataSet::sortByColumns(const QList<int>& columns, const QList<bool>& reverse)
+{
+	QElapsedTimer timer;
+	timer.start();
+
+	//sort key (includes the sort mode of string columns, virtual columns are always sorted binary)
+	QString key;
+	for (int k=0; k<columns.count(); ++k)
+	{
+		const BaseColumn& col = *columns_[columns[k]];
+		key += QString::number(columns[k]) + (reverse.value(k) ? "d" : "a");
+		if (col.type()==BaseColumn::STRING) key += QString::number(col.isVirtual() ? StringColumn::BINARY : static_cast<const StringColumn&>(col).sortMode());
+		key += ",";
+	}
+
+	//determine order (or re-use cached order)
+	if (!sort_orders_.contains(key))
+	{
+		if (sort_orders_.count()>=8) sort_orders_.clear();
+		sort_orders_[key] = sortOrder(columns, reverse);
+	}
+	qDebug() << "sorting by" << columns.count() << "columns: determining order ms=" << timer.elapsed();
+
+	setRowOrder(sort_orders_[key]);
+}
+
+QVector<int> DataSet::sortOrder(const QList<int>& columns, const QList<bool>& reverse) const
+{
+	if (columns.isEmpty() || columns.count()!=reverse.count()) THROW(ProgrammingException, "Invalid sort keys in sortOrder(...)!");
+	EvaluationScope scope(*this);
+
+	//repeated columns do not change the order
+	QList<int> key_columns;
+	QList<bool> key_reverse;
+	for (int k=0; k<columns.count(); ++k)
+	{
+		if (key_columns.contains(columns[k])) continue;
+		key_columns << columns[k];
+		key_reverse << reverse[k];
+	}
+
+	//single key: sort order of the column
+	if (key_columns.count()==1) return column(key_columns[0]).sortOrder(key_reverse[0]);
+
+	//convert keys to dense ranks (in parallel). The merge sort then compares plain integers, independent of the column types. Virtual columns are evaluated before.
+	QVector<QVector<int>> ranks(key_columns.count());
+	QList<int> keys;
+	for (int k=0; k<key_columns.count(); ++k)
+	{
+		keys << k;
+		column(key_columns[k]).evaluated();
+	}
+	QtConcurrent::blockingMap(keys, [&](int k)
+	{
+		ranks[k] = sortRanks(column(key_columns[k]), key_reverse[k]);
+	});
 
-		for (int i=0; i<size; ++i)
+	//stable sort of the row indices by the ranks of all keys
+	QVector<const int*> key_ranks;
+	foreach(const QVector<int>& key, ranks)
+	{
+		key_ranks << key.constData();
+	}
+	const int key_count = key_ranks.count();
+	const int* const* r = key_ranks.constData();
+	QVector<int> order(rowCount());
+	std::iota(order.begin(), order.end(), 0);
+	parallelStableSort(order, [r, key_count](int a, int b)
+	{
+		for (int k=0; k<key_count; ++k)
 		{
-			indices[i] = tmp[i].second;
+			if (r[k][a]!=r[k][b]) return r[k][a] < r[k][b];
 		}
+		return false;
+	});
+
+	return order;
+}
+
+void DataSet::setRowOrder(const QVector<int>& order)
+{
+	Q_ASSERT(order.isEmpty() || order.count()==rowCount());
+
+	row_order_ = order;
+
+	//the data itself is unchanged, so the cached sort orders are still valid
+	if (updating()) changes_.structure = true;
+	else emit dataChanged();
+	setModified(true);
+}
+
+void DataSet::applyRowOrder()
+{
+	if (row_order_.isEmpty()) return;
+
+	QVector<int> order = row_order_;
+	row_order_.clear();
+	applyPermutation(order);
+}
+
+void DataSet::reduceRowOrder(const QBitArray& rows)
+{
+	if (row_order_.isEmpty()) return;
+	Q_ASSERT(rows.count()==rowCount());
+
+	//new index of kept rows
+	QVector<int> new_index(rows.count(), -1);
+	int next = 0;
+	for (int r=0; r<rows.count(); ++r)
+	{
+		if (rows.testBit(r)) new_index[r] = next++;
+	}
+
+	QVector<int> order;
+	order.reserve(next);
+	foreach(int r, row_order_)
+	{
+		if (new_index[r]!=-1) order << new_index[r];
 	}
+	row_order_ = order;
+}
+
+void DataSet::applyPermutation(const QVector<int>& order)
+{
+	Q_ASSERT(order.count()==rowCount());
 
-    //use the indices to change the order of all columns //TODO move to column: void reorder(QList<int> order)
-	for (int c=0; c<columns_.size(); ++c)
+	//keep the display order: the data row r is now at position inverse[r]
+	if (!row_order_.isEmpty())
 	{
-		if (columns_[c]->type()==BaseColumn::NUMERIC)
+		QVector<int> inverse(order.count());
+		for (int i=0; i<order.count(); ++i)
 		{
-            NumericColumn* column = dynamic_cast<NumericColumn*>(columns_[c]);
-            const QVector<double>& col_values = column->values();
-            const QVector<char>& col_decimals = column->decimals();
-			QVector<double> new_col(size);
-            QVector<char> new_col_dec(size);
-			for (int i=0; i<size; ++i)
-			{
-                new_col[i] = col_values[indices[i]];
-                new_col_dec[i] = col_decimals[indices[i]];
-			}
-            column->setValues(new_col, new_col_dec);
+			inverse[order[i]] = i;
 		}
-		else
+		for (int& r : row_order_)
 		{
-			QVector<QString> col = dynamic_cast<StringColumn*>(columns_[c])->values();
-			QVector<QString> new_col(size);
-			for (int i=0; i<size; ++i)
-			{
-				new_col[i] = col[indices[i]];
-			}
-			dynamic_cast<StringColumn*>(columns_[c])->setValues(new_col);
+			r = inverse[r];
 		}
 	}
 
-    emit dataChanged();
-    setModified(true);
+	//reorder columns in parallel (column signals are blocked because columns belong to the GUI thread)
+	QVector<BaseColumn*> columns = columns_;
+	foreach(BaseColumn* column, columns)
+	{
+		column->blockSignals(true);
+	}
+	QtConcurrent::blockingMap(columns, [&order](BaseColumn* column)
+	{
+		column->applyPermutation(order);
+	});
+	foreach(BaseColumn* column, columns)
+	{
+		column->blockSignals(false);
+	}
+	interval_index_.clear();
+	sort_orders_.clear();
+
+	emitDataChanged();
+	setModified(true);
 }
 
 void DataSet::mergeColumns(QList<int> cols, QString header, QString sep)
@@ -295,56 +763,163 @@ void DataSet::mergeColumns(QList<int> cols, QString header, QString sep)
 	}
 
 	//remove old columns and add new one
+	UpdateGuard update(*this);
 	removeColumns(Helper::listToSet(cols));
     addColumn(header, new_col, first_col);
 }
 
-void DataSet::reduceToRows(QSet<int> rows)
+void DataSet::reduceToRows(const QBitArray& rows)
 {
-	//convert rows set to ordered list
-	QList<int> keep_rows = Helper::setToList(rows, true);
+	Q_ASSERT(rows.count()==rowCount());
 
-	//update all columns
-	blockSignals(true);
-	for (int c=0; c<columnCount(); ++c)
-	{
-		//numeric column
-		if (column(c).type()==BaseColumn::NUMERIC)
-		{
-			NumericColumn& column = numericColumn(c);
-            const QList<double>& old_values = column.values();
-            const QList<char>& old_decimals = column.decimals();
-
-            QVector<double> values;
-			values.reserve(keep_rows.count());
-            QVector<char> decimals;
-            decimals.reserve(keep_rows.count());
-			for (int r=0; r<keep_rows.count(); ++r)
-			{
-                values << old_values[keep_rows[r]];
-                decimals << old_decimals[keep_rows[r]];
-            }
-            column.setValues(values, decimals);
-		}
-		//string column
-		else
-		{
-			StringColumn& column = stringColumn(c);
-            const QList<QString>& old_values = column.values();
+	QElapsedTimer timer;
+	timer.start();
 
-			QVector<QString> values;
-			values.reserve(keep_rows.count());
-			for (int r=0; r<keep_rows.count(); ++r)
-			{
-                values << old_values[keep_rows[r]];
-			}
-			column.setValues(values);
-		}
-	}
-	blockSignals(false);
+	reduceRowOrder(rows);
 
-    emit dataChanged();
-    setModified(true, true);
+	QVector<int> keep_rows;
+	keep_rows.reserve(rows.count(true));
+	for (int r=0; r<rows.count(); ++r)
+	{
+		if (rows.testBit(r)) keep_rows << r;
+	}
+	gatherRows(keep_rows);
+
+	qDebug() << "reducing rows: r=" << keep_rows.count() << "ms=" << timer.elapsed();
+}
+
+void DataSet::gatherRows(const QVector<int>& rows)
+{
+	//gather rows of all columns in parallel (column signals are blocked because columns belong to the GUI thread)
+	QVector<BaseColumn*> columns = columns_;
+	foreach(BaseColumn* column, columns)
+	{
+		column->blockSignals(true);
+	}
+	QtConcurrent::blockingMap(columns, [&rows](BaseColumn* column)
+	{
+		column->gather(rows);
+	});
+	foreach(BaseColumn* column, columns)
+	{
+		column->blockSignals(false);
+	}
+	interval_index_.clear();
+
+	emitDataChanged();
+	setModified(true, true);
+}
+
+QVector<int> DataSet::firstRowsOfKeys(const QList<int>& columns, QVector<int>& counts, const QBitArray& rows) const
+{
+	QElapsedTimer timer;
+	timer.start();
+
+	const int n = rowCount();
+	Q_ASSERT(rows.isEmpty() || rows.count()==n);
+	EvaluationScope scope(*this);
+	RowKeys keys(*this, columns);
+
+	//hash keys of all rows (in parallel blocks)
+	QVector<quint64> hashes = keys.hashes();
+	const quint64* h = hashes.constData();
+	qDebug() << "finding duplicates: hashing ms=" << timer.restart();
+
+	//partition rows by the highest hash bits (rows stay in ascending order within a partition)
+	int bits = 0;
+	if (n>=RadixSort::PARALLEL_MIN)
+	{
+		while ((1<<bits)<QThread::idealThreadCount() && bits<6) ++bits;
+	}
+	const int partitions = 1 << bits;
+	auto partition = [bits](quint64 hash) { return bits==0 ? 0 : (int)(hash >> (64-bits)); };
+	QVector<int> offsets(partitions+1, 0);
+	for (int r=0; r<n; ++r)
+	{
+		if (rows.isEmpty() || rows.testBit(r)) ++offsets[partition(h[r])+1];
+	}
+	for (int p=0; p<partitions; ++p)
+	{
+		offsets[p+1] += offsets[p];
+	}
+	QVector<int> partition_rows(offsets[partitions]);
+	QVector<int> next = offsets;
+	for (int r=0; r<n; ++r)
+	{
+		if (rows.isEmpty() || rows.testBit(r)) partition_rows[next[partition(h[r])]++] = r;
+	}
+
+	//find the first row of each key with a hash table per partition (in parallel). Hash collisions are resolved by comparing the key values.
+	QVector<int> first(n, -1);
+	counts.fill(0, n);
+	int* f = first.data();
+	int* c = counts.data();
+	QList<int> partition_indices;
+	for (int p=0; p<partitions; ++p)
+	{
+		partition_indices << p;
+	}
+	QtConcurrent::blockingMap(partition_indices, [&](int p)
+	{
+		const int size = offsets[p+1] - offsets[p];
+		int capacity = 16;
+		while (capacity<2*size) capacity *= 2;
+		const quint64 mask = capacity - 1;
+		std::vector<int> table(capacity, -1);
+
+		for (int i=offsets[p]; i<offsets[p+1]; ++i)
+		{
+			const int r = partition_rows[i];
+			quint64 slot = h[r] & mask;
+			while (true)
+			{
+				const int rep = table[slot];
+				if (rep==-1)
+				{
+					table[slot] = r;
+					f[r] = r;
+					c[r] = 1;
+					break;
+				}
+				if (h[rep]==h[r] && keys.equal(rep, r))
+				{
+					f[r] = rep;
+					++c[rep];
+					break;
+				}
+				slot = (slot + 1) & mask;
+			}
+		}
+	});
+	qDebug() << "finding duplicates: grouping r=" << n << "partitions=" << partitions << "ms=" << timer.elapsed();
+
+	return first;
+}
+
+QBitArray DataSet::uniqueRows(const QList<int>& columns) const
+{
+	QVector<int> counts;
+	QVector<int> first = firstRowsOfKeys(columns, counts);
+
+	QBitArray output(rowCount(), false);
+	for (int r=0; r<first.count(); ++r)
+	{
+		if (first[r]==r) output.setBit(r);
+	}
+	return output;
+}
+
+QBitArray DataSet::duplicateRows(const QList<int>& columns) const
+{
+	QVector<int> counts;
+	QVector<int> first = firstRowsOfKeys(columns, counts);
+
+	QBitArray output(rowCount(), false);
+	for (int r=0; r<first.count(); ++r)
+	{
+		if (counts[first[r]]>1) output.setBit(r);
+	}
+	return output;
 }
 
 void DataSet::convertStringToNumeric(int c)
@@ -353,7 +928,8 @@ void DataSet::convertStringToNumeric(int c)
 	Q_ASSERT(c<columns_.size());
 
 	//create numeric data
-    const QVector<QString>& values = stringColumn(c).values();
+	EvaluationScope scope(*this);
+	const QVector<QString>& values = static_cast<const DataSet&>(*this).stringColumn(c).values();
 	QVector<double> numbers;
     numbers.reserve(values.count());
     QVector<char> decimals;
@@ -369,80 +945,1073 @@ void DataSet::convertStringToNumeric(int c)
     replaceColumn(c, column(c).header(), numbers, decimals);
 }
 
+void DataSet::convertStringToDateTime(int c)
+{
+	Q_ASSERT(c>=0);
+	Q_ASSERT(c<columns_.size());
+
+	//create date/time data
+	EvaluationScope scope(*this);
+	const QVector<QString>& values = static_cast<const DataSet&>(*this).stringColumn(c).values();
+	QVector<qint64> times;
+	times.reserve(values.count());
+	QVector<char> formats;
+	formats.reserve(values.count());
+	foreach(const QString& value, values)
+	{
+		qint64 ms;
+		char format;
+		if (!DateTimeColumn::parse(value, ms, format)) THROW(Exception, "Cannot convert '" + value + "' to a date/time!");
+		times << ms;
+		formats << format;
+	}
+
+	//replace string by date/time column
+	replaceColumn(c, column(c).header(), times, formats);
+}
+
+bool DataSet::hasValues(int c) const
+{
+	const QVector<QString>& values = stringColumn(c).values();
+	return std::any_of(values.cbegin(), values.cend(), [](const QString& value) { return !value.isEmpty(); });
+}
+
+QSharedPointer<DataSet> DataSet::snapshot() const
+{
+	QSharedPointer<DataSet> output(new DataSet());
+	foreach(const BaseColumn* column, columns_)
+	{
+		output->columns_.append(column->clone());
+	}
+	output->comments_ = comments_;
+	output->filters_enabled_ = filters_enabled_;
+	output->row_order_ = row_order_;
+
+	return output;
+}
+
 void DataSet::setFiltersEnabled(bool enabled)
 {
 	filters_enabled_ = enabled;
 
-	emit filtersChanged();
+	emitFiltersChanged();
+}
+
+bool DataSet::filtersPresent() const
+{
+	for (int i=0; i<columnCount(); ++i)
+	{
+		if (column(i).filter().type() != Filter::NONE)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void DataSet::columnDataChanged()
+{
+	setModified(true);
+	interval_index_.clear();
+	sort_orders_.clear();
+
+	//the whole dataset is re-rendered anyway (e.g. during loading)
+	if (updating() && changes_.structure) return;
+
+	BaseColumn* column = qobject_cast<BaseColumn*>(sender());
+	emitColumnChanged(columns_.indexOf(column));
+}
+
+void DataSet::columnRowsChanged(int start, int end)
+{
+	setModified(true);
+	interval_index_.clear();
+	sort_orders_.clear();
+
+	//the whole dataset is re-rendered anyway
+	if (updating() && changes_.structure) return;
+
+	BaseColumn* column = qobject_cast<BaseColumn*>(sender());
+	emitRowsChanged(columns_.indexOf(column), start, end);
+}
+
+void DataSet::headerDataChanged()
+{
+	setModified(true);
+
+	emitHeadersChanged();
+}
+
+void DataSet::filterDataChanged()
+{
+	setModified(true);
+
+	emitFiltersChanged();
+}
+
+QBitArray DataSet::getRowFilter(bool update) const
+{
+	if (!filters_enabled_)
+	{
+		filtered_rows_.fill(true, rowCount());
+	}
+
+	if (filters_enabled_ && update)
+	{
+		filtered_rows_.fill(true, rowCount());
+
+		//determine rows to render
+		for (int c=0; c<columnCount(); ++c)
+		{
+			column(c).matchFilter(filtered_rows_);
+		}
+
+		//region filters (depend on several columns)
+		for (int c=0; c<columnCount(); ++c)
+		{
+			if (column(c).filter().type()==Filter::REGION_OVERLAPS)
+			{
+				matchRegionFilter(c, filtered_rows_);
+			}
+		}
+	}
+
+	return filtered_rows_;
+}
+
+QBitArray DataSet::updateRowFilter(int start, int end) const
+{
+	Q_ASSERT(start>=0 && start<=end && end<=rowCount());
+
+	//complete update if the cached filter is outdated or region filters are present (they depend on several columns)
+	bool complete = filtered_rows_.count()!=rowCount();
+	for (int c=0; c<columnCount(); ++c)
+	{
+		if (column(c).filter().type()==Filter::REGION_OVERLAPS) complete = true;
+	}
+	if (complete || !filters_enabled_) return getRowFilter();
+
+	//re-evaluate the filters of the given rows only
+	filtered_rows_.fill(true, start, end);
+	for (int c=0; c<columnCount(); ++c)
+	{
+		column(c).matchFilter(filtered_rows_, start, end);
+	}
+
+	return filtered_rows_;
+}
+
+const IntervalIndex& DataSet::intervalIndex(int chr_col, int start_col, int end_col) const
+{
+	QVector<const BaseColumn*> key;
+	key << columns_[chr_col] << columns_[start_col] << columns_[end_col];
+	if (interval_index_.isNull() || interval_index_columns_!=key)
+	{
+		QElapsedTimer timer;
+		timer.start();
+
+		EvaluationScope scope(*this);
+		interval_index_.reset(new IntervalIndex(*this, chr_col, start_col, end_col));
+		interval_index_columns_ = key;
+
+		qDebug() << "creating interval index: ms=" << timer.elapsed();
+	}
+
+	return *interval_index_;
+}
+
+void DataSet::matchRegionFilter(int chr_col, QBitArray& array) const
+{
+	//determine start/end column
+	QString start_name;
+	QString end_name;
+	QString bed_file;
+	int start_col = -1;
+	int end_col = -1;
+	if (Filter::parseRegionValue(column(chr_col).filter().value(), start_name, end_name, bed_file))
+	{
+		start_col = indexOf(start_name);
+		end_col = indexOf(end_name);
+	}
+	if (start_col==-1 || end_col==-1 || column(start_col).type()!=BaseColumn::NUMERIC || column(end_col).type()!=BaseColumn::NUMERIC)
+	{
+		qWarning() << "Invalid region filter (start/end column not found or not numeric):" << column(chr_col).filter().value();
+		array.fill(false);
+		return;
+	}
+
+	//load BED file (cached until the file changes)
+	QString cache_key = bed_file + "|" + QFileInfo(bed_file).lastModified().toString(Qt::ISODateWithMs);
+	if (!bed_cache_.contains(cache_key))
+	{
+		try
+		{
+			bed_cache_[cache_key] = IntervalIndex::loadBed(bed_file);
+		}
+		catch (Exception& e)
+		{
+			qWarning() << "Could not load BED file of region filter:" << e.message();
+			array.fill(false);
+			return;
+		}
+	}
+	const QVector<GenomicRegion>& regions = bed_cache_[cache_key];
+
+	//determine overlapping rows
+	QElapsedTimer timer;
+	timer.start();
+	const IntervalIndex& index = intervalIndex(chr_col, start_col, end_col);
+	QBitArray overlapping(rowCount(), false);
+	foreach(const GenomicRegion& region, regions)
+	{
+		index.overlapping(region, overlapping);
+	}
+	array &= overlapping;
+	qDebug() << "applying region filter: regions=" << regions.count() << "ms=" << timer.elapsed();
+}
+
+namespace
+{
+    //Line-wise reading of a region of a bgzipped, tabix-indexed file: header lines from the file start, followed by the lines overlapping the region.
+    class TabixRegionStream
+    {
+    public:
+        TabixRegionStream(QString filename, const GenomicRegion& region)
+            : index_(filename)
+            , reader_(filename)
+            , region_(region)
+            , chunks_(index_.chunks(region))
+            , chunk_(-1)
+            , skip_(index_.skipLines())
+            , next_()
+            , has_next_(false)
+        {
+            fetch();
+        }
+
+        bool atEnd() const
+        {
+            return !has_next_;
+        }
+
+        QString readLine(bool /*trim*/)
+        {
+            QString line = next_;
+            fetch();
+            return line;
+        }
+
+    protected:
+        TabixIndex index_;
+        BgzfReader reader_;
+        GenomicRegion region_;
+        QVector<TabixIndex::Chunk> chunks_;
+        int chunk_; //-1 while reading the header
+        int skip_;
+        QString next_;
+        bool has_next_;
+
+        void fetch()
+        {
+            has_next_ = false;
+
+            //header lines at the file start
+            while (chunk_==-1 && !reader_.atEnd())
+            {
+                QByteArray line = reader_.readLine();
+                if (line.isEmpty()) continue;
+
+                //lines skipped by tabix are header lines, even without meta character
+                if (skip_>0)
+                {
+                    --skip_;
+                    if (line[0]!=index_.metaChar()) line.prepend(skip_>0 ? "##" : "#");
+                }
+                else if (line[0]!=index_.metaChar())
+                {
+                    break;
+                }
+
+                //row count refers to the whole file
+                if (line.startsWith("##TSVVIEW-ROWS##")) continue;
+
+                next_ = QString::fromUtf8(line);
+                has_next_ = true;
+                return;
+            }
+
+            //first content line reached: continue with the chunks
+            if (chunk_==-1)
+            {
+                chunk_ = 0;
+                if (!chunks_.isEmpty()) reader_.seek(chunks_[0].first);
+            }
+
+            //content lines overlapping the region
+            while (chunk_<chunks_.count())
+            {
+                if (reader_.tell()>=chunks_[chunk_].second || reader_.atEnd())
+                {
+                    ++chunk_;
+                    if (chunk_<chunks_.count()) reader_.seek(chunks_[chunk_].first);
+                    continue;
+                }
+
+                QByteArray line = reader_.readLine();
+                if (line.isEmpty() || line[0]==index_.metaChar()) continue;
+
+                QList<QByteArray> parts = line.split('\t');
+                if (index_.overlaps(parts, region_))
+                {
+                    next_ = QString::fromUtf8(line);
+                    has_next_ = true;
+                    return;
+                }
+
+                //file is sorted by position: no further overlapping lines
+                if (index_.after(parts, region_)) break;
+            }
+            chunk_ = chunks_.count();
+        }
+    };
+
+    //Line-wise reading of lines held in memory: header lines followed by content lines.
+    class LineListStream
+    {
+    public:
+        LineListStream(const QStringList& header_lines, const QVector<QByteArray>& lines)
+            : header_lines_(header_lines)
+            , lines_(lines)
+            , index_(0)
+        {
+        }
+
+        bool atEnd() const
+        {
+            return index_ >= header_lines_.count() + lines_.count();
+        }
+
+        QString readLine(bool /*trim*/)
+        {
+            int index = index_++;
+            if (index<header_lines_.count()) return header_lines_[index];
+            return QString::fromUtf8(lines_[index - header_lines_.count()]);
+        }
+
+    protected:
+        QStringList header_lines_;
+        QVector<QByteArray> lines_;
+        int index_;
+    };
+
+    //Returns the header lines of a paged file used for loading a part of the file. The row count line is always removed, because it refers to the whole file.
+    QStringList pagedHeaderLines(const QStringList& lines, bool keep_comments, bool keep_filters)
+    {
+        QStringList output;
+        foreach(const QString& line, lines)
+        {
+            if (line.startsWith("##TSVVIEW-ROWS##")) continue;
+            if (line.startsWith("##TSVVIEW-FILTER##") && !keep_filters) continue;
+            if (line.startsWith("##") && !line.startsWith("##TSVVIEW-") && !keep_comments) continue;
+            output << line;
+        }
+        return output;
+    }
+}
+
+QHash<int, ColumnInfo> DataSet::load(QString filename, QString display_name, const QStringList& columns)
+{
+    if (display_name.isEmpty()) display_name = filename;
+
+    //binary formats: columns are loaded from memory-mapped/contiguous blocks, so unused columns are removed afterwards
+    if (isBinary(filename) || ArrowFile::isArrow(filename))
+    {
+        QHash<int, ColumnInfo> col_infos = isBinary(filename) ? loadBinary(filename, display_name) : loadArrow(filename, display_name);
+        if (columns.isEmpty()) return col_infos;
+
+        foreach(const QString& name, columns)
+        {
+            if (indexOf(name)==-1) THROW(ArgumentException, "Column '" + name + "' not found in " + display_name + "!");
+        }
+        QSet<int> remove;
+        QHash<int, ColumnInfo> output;
+        for (int c=0; c<columnCount(); ++c)
+        {
+            if (!columns.contains(column(c).header())) remove << c;
+            else if (col_infos.contains(c)) output[c - remove.count()] = col_infos[c];
+        }
+        UpdateGuard update(*this);
+        removeColumns(remove);
+        setModified(false);
+        return output;
+    }
+
+    VersatileTextStream file(filename);
+    return loadLines(file, display_name, columns);
+}
+
+QHash<int, ColumnInfo> DataSet::loadRegion(QString filename, QString region, QString display_name)
+{
+    if (display_name.isEmpty()) display_name = filename;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    TabixRegionStream file(filename, IntervalIndex::parseRegion(region));
+    QHash<int, ColumnInfo> col_infos = loadLines(file, display_name + " (region " + region + ")");
+    subset_ = "region " + region + " of " + display_name;
+
+    qDebug() << "loading region of indexed file: r=" << rowCount() << "ms=" << timer.elapsed();
+
+    return col_infos;
+}
+
+QHash<int, ColumnInfo> DataSet::loadPaged(QString filename, qint64 cache_size)
+{
+    clear(true);
+
+    paged_file_.reset(new PagedFile(filename, cache_size));
+
+    return loadPage(0);
+}
+
+QHash<int, ColumnInfo> DataSet::loadPage(int page)
+{
+    Q_ASSERT(isPaged());
+    Q_ASSERT(page>=0 && page<pageCount());
+
+    QElapsedTimer timer;
+    timer.start();
+
+    //keep filters of the current page
+    QVector<Filter> filters;
+    for (int c=0; c<columnCount(); ++c)
+    {
+        filters << column(c).filter();
+    }
+
+    //load page (clears the dataset)
+    QSharedPointer<PagedFile> file = paged_file_;
+    qint64 first_row = (qint64)page * PAGE_ROWS;
+    LineListStream stream(pagedHeaderLines(file->headerLines(), true, filters.isEmpty()), file->lines(first_row, PAGE_ROWS));
+    QHash<int, ColumnInfo> col_infos = loadLines(stream, file->filename());
+    paged_file_ = file;
+    page_ = page;
+    subset_ = "rows " + QString::number(first_row+1) + "-" + QString::number(first_row+rowCount()) + " of " + QString::number(file->rowCount()) + " in " + file->filename();
+
+    //restore filters
+    if (filters.count()==columnCount())
+    {
+        for (int c=0; c<columnCount(); ++c)
+        {
+            try
+            {
+                column(c).setFilter(filters[c]);
+            }
+            catch (FilterTypeException& e)
+            {
+                qWarning() << "Filter of column" << c << "not applicable to page" << page << ":" << e.message();
+            }
+        }
+        setModified(false);
+    }
+
+    qDebug() << "loading page" << page << ": r=" << rowCount() << "ms=" << timer.elapsed();
+
+    return col_infos;
+}
+
+int DataSet::pageCount() const
+{
+    if (!isPaged()) return 1;
+    return (int)std::max(1ll, (paged_file_->rowCount() + PAGE_ROWS - 1) / PAGE_ROWS);
+}
+
+qint64 DataSet::fileRowCount() const
+{
+    if (!isPaged()) return rowCount();
+    return paged_file_->rowCount();
+}
+
+int DataSet::streamFile(std::function<void(const DataSet&, const QBitArray&, const QVector<QByteArray>&)> func) const
+{
+    Q_ASSERT(isPaged());
+
+    int skipped = 0;
+    QStringList header_lines = pagedHeaderLines(paged_file_->headerLines(), false, false);
+    for (int i=0; i<paged_file_->chunkCount(); ++i)
+    {
+        QVector<QByteArray> lines = paged_file_->chunk(i);
+        DataSet chunk;
+        LineListStream stream(header_lines, lines);
+        chunk.loadLines(stream, paged_file_->filename());
+
+        //apply filters of the current page (column types can differ between chunks if not stored in the file)
+        bool type_mismatch = false;
+        for (int c=0; c<columnCount() && c<chunk.columnCount(); ++c)
+        {
+            try
+            {
+                chunk.column(c).setFilter(column(c).filter());
+            }
+            catch (FilterTypeException& /*e*/)
+            {
+                type_mismatch = true;
+            }
+        }
+        chunk.setFiltersEnabled(filters_enabled_);
+
+        QBitArray rows;
+        if (type_mismatch)
+        {
+            rows.fill(false, chunk.rowCount());
+            skipped += chunk.rowCount();
+        }
+        else
+        {
+            rows = chunk.getRowFilter();
+        }
+        func(chunk, rows, lines);
+    }
+
+    return skipped;
+}
+
+QVector<double> DataSet::fileColumnValues(int c, int& skipped) const
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    QVector<double> output;
+    skipped = streamFile([&output, c](const DataSet& chunk, const QBitArray& rows, const QVector<QByteArray>& /*lines*/)
+    {
+        if (chunk.column(c).type()==BaseColumn::NUMERIC)
+        {
+            output << chunk.numericColumn(c).values(rows);
+        }
+        else
+        {
+            for (int r=0; r<rows.count(); ++r)
+            {
+                if (rows.testBit(r)) output << NumericColumn::toDouble(chunk.column(c).string(r), true).first;
+            }
+        }
+    });
+
+    qDebug() << "streaming column values of paged file: r=" << output.count() << "ms=" << timer.elapsed();
+
+    return output;
+}
+
+QHash<int, ColumnInfo> DataSet::loadFilteredRows(int& skipped)
+{
+    Q_ASSERT(isPaged());
+
+    QElapsedTimer timer;
+    timer.start();
+
+    //collect lines passing the filters
+    QVector<QByteArray> matches;
+    skipped = streamFile([&matches](const DataSet& /*chunk*/, const QBitArray& rows, const QVector<QByteArray>& lines)
+    {
+        for (int r=0; r<rows.count(); ++r)
+        {
+            if (rows.testBit(r)) matches << lines[r];
+        }
+    });
+
+    //load them (leaves paged mode)
+    QSharedPointer<PagedFile> file = paged_file_;
+    LineListStream stream(pagedHeaderLines(file->headerLines(), true, false), matches);
+    QHash<int, ColumnInfo> col_infos = loadLines(stream, file->filename());
+    subset_ = "filtered rows of " + file->filename();
+    setModified(true, true);
+
+    qDebug() << "loading filtered rows of paged file: r=" << rowCount() << "ms=" << timer.elapsed();
+
+    return col_infos;
+}
+
+QHash<int, ColumnInfo> DataSet::loadSample(QString filename, int rows, QString display_name)
+{
+    if (display_name.isEmpty()) display_name = filename;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    //large uncompressed file: uniform random byte offsets
+    QStringList header_lines;
+    QVector<QByteArray> sample;
+    std::mt19937_64 rng(std::random_device{}());
+    QFile file(filename);
+    if (PagedFile::isSupported(filename) && !BgzfReader::isBgzf(filename) && QFileInfo(filename).size()>64*1024*1024 && file.open(QFile::ReadOnly))
+    {
+        //header lines
+        qint64 data_start = 0;
+        while (!file.atEnd())
+        {
+            data_start = file.pos();
+            QByteArray line = file.readLine();
+            while (line.endsWith('\n') || line.endsWith('\r')) line.chop(1);
+            if (line.isEmpty()) continue;
+            if (line[0]!='#')
+            {
+                break;
+            }
+            header_lines << QString::fromUtf8(line);
+            data_start = file.pos();
+        }
+
+        //random offsets select the line following them (resync at the next newline). Offsets within the same line select the same line,
+        //so offsets are drawn in rounds until there are enough distinct lines (or the rounds are exhausted, e.g. for files with few long lines).
+        QMap<qint64, QByteArray> lines; //by line start (keeps the file order)
+        if (data_start<file.size())
+        {
+            const int max_rounds = 10;
+            std::uniform_int_distribution<qint64> dist(data_start, file.size()-1);
+            for (int round=0; round<max_rounds && lines.count()<rows; ++round)
+            {
+                QVector<qint64> offsets;
+                offsets.reserve(rows - lines.count());
+                for (int i=lines.count(); i<rows; ++i)
+                {
+                    offsets << dist(rng);
+                }
+                std::sort(offsets.begin(), offsets.end());
+
+                foreach(qint64 offset, offsets)
+                {
+                    if (offset==data_start)
+                    {
+                        file.seek(offset);
+                    }
+                    else
+                    {
+                        file.seek(offset-1);
+                        file.readLine();
+                    }
+                    qint64 line_start = file.pos();
+                    if (file.atEnd() || lines.contains(line_start)) continue;
+
+                    QByteArray line = file.readLine();
+                    while (line.endsWith('\n') || line.endsWith('\r')) line.chop(1);
+                    if (!line.isEmpty()) lines.insert(line_start, line);
+                }
+            }
+        }
+        sample.reserve(lines.count());
+        foreach(const QByteArray& line, lines)
+        {
+            sample << line;
+        }
+    }
+    //other files: reservoir sampling in a single pass
+    else
+    {
+        QVector<QPair<qint64, QString>> reservoir;
+        reservoir.reserve(rows);
+        qint64 line_nr = 0;
+        VersatileTextStream stream(filename);
+        while (!stream.atEnd())
+        {
+            QString line = stream.readLine(true);
+            if (line.isEmpty()) continue;
+            if (line_nr==0 && line[0]=='#')
+            {
+                header_lines << line;
+                continue;
+            }
+
+            if (reservoir.count()<rows)
+            {
+                reservoir << qMakePair(line_nr, line);
+            }
+            else
+            {
+                qint64 index = std::uniform_int_distribution<qint64>(0, line_nr)(rng);
+                if (index<rows) reservoir[(int)index] = qMakePair(line_nr, line);
+            }
+            ++line_nr;
+        }
+
+        //keep the file order
+        std::sort(reservoir.begin(), reservoir.end(), [](const QPair<qint64, QString>& a, const QPair<qint64, QString>& b) { return a.first<b.first; });
+        sample.reserve(reservoir.count());
+        foreach(const auto& entry, reservoir)
+        {
+            sample << entry.second.toUtf8();
+        }
+    }
+
+    //load sample
+    LineListStream stream(pagedHeaderLines(header_lines, true, true), sample);
+    QHash<int, ColumnInfo> col_infos = loadLines(stream, display_name);
+    subset_ = "sample of " + QString::number(rowCount()) + " rows of " + display_name;
+    sample_ = true;
+
+    qDebug() << "loading sample: r=" << rowCount() << "ms=" << timer.elapsed();
+
+    return col_infos;
+}
+
+namespace
+{
+    //TSVB format: magic, version, row count, column count, header size
+    const char TSVB_MAGIC[4] = {'T', 'S', 'V', 'B'};
+    const quint32 TSVB_VERSION = 1;
+    const int TSVB_HEADER_SIZE = 24;
+
+    //block of the TSVB format (each column consists of two blocks)
+    struct BinaryBlock
+    {
+        quint64 offset;
+        quint64 size; //stored size
+        quint64 raw_size; //uncompressed size (equals 'size' if the block is not compressed)
+    };
+
+    quint64 alignTo8(quint64 value)
+    {
+        return (value + 7) & ~7ull;
+    }
+
+    //compresses a block with zlib (streaming, because blocks can be larger than 4GB)
+    QByteArray deflateBlock(const char* data, qint64 size, int level)
+    {
+        z_stream stream;
+        memset(&stream, 0, sizeof(stream));
+        if (deflateInit(&stream, level)!=Z_OK) THROW(ProgrammingException, "Could not initialize zlib compression with level " + QString::number(level) + "!");
+
+        QByteArray output;
+        output.resize(std::max((qint64)64, size / 4));
+        qint64 done_in = 0;
+        qint64 done_out = 0;
+        int result = Z_OK;
+        while (result!=Z_STREAM_END)
+        {
+            if (done_out==output.size()) output.resize(output.size() * 2);
+            const uInt chunk_in = (uInt)std::min(size - done_in, (qint64)(1<<30));
+            const uInt chunk_out = (uInt)std::min(output.size() - done_out, (qint64)(1<<30));
+            stream.next_in = (Bytef*)data + done_in;
+            stream.avail_in = chunk_in;
+            stream.next_out = (Bytef*)output.data() + done_out;
+            stream.avail_out = chunk_out;
+            result = deflate(&stream, done_in + chunk_in==size ? Z_FINISH : Z_NO_FLUSH);
+            if (result!=Z_OK && result!=Z_STREAM_END && result!=Z_BUF_ERROR)
+            {
+                deflateEnd(&stream);
+                THROW(ProgrammingException, "zlib compression of TSVB block failed!");
+            }
+            done_in += chunk_in - stream.avail_in;
+            done_out += chunk_out - stream.avail_out;
+        }
+        deflateEnd(&stream);
+
+        output.resize(done_out);
+        return output;
+    }
+
+    //decompresses a block with zlib. Returns false if the data is corrupt.
+    bool inflateBlock(const uchar* data, qint64 size, char* output, qint64 output_size)
+    {
+        z_stream stream;
+        memset(&stream, 0, sizeof(stream));
+        if (inflateInit(&stream)!=Z_OK) return false;
+
+        qint64 done_in = 0;
+        qint64 done_out = 0;
+        int result = Z_OK;
+        while (result==Z_OK)
+        {
+            const uInt chunk_in = (uInt)std::min(size - done_in, (qint64)(1<<30));
+            const uInt chunk_out = (uInt)std::min(output_size - done_out, (qint64)(1<<30));
+            stream.next_in = (Bytef*)data + done_in;
+            stream.avail_in = chunk_in;
+            stream.next_out = (Bytef*)output + done_out;
+            stream.avail_out = chunk_out;
+            result = inflate(&stream, Z_NO_FLUSH);
+            done_in += chunk_in - stream.avail_in;
+            done_out += chunk_out - stream.avail_out;
+            if (result==Z_OK && chunk_in==0 && chunk_out==0) break;
+        }
+        inflateEnd(&stream);
+
+        return result==Z_STREAM_END && done_out==output_size;
+    }
+}
+
+QStringList DataSet::fileHeaders(QString filename)
+{
+    //Arrow files: the headers are part of the schema
+    if (ArrowFile::isArrow(filename)) return ArrowFile::columnNames(filename);
+
+    //TSVB files: the header line is part of the header block, i.e. the column data is not read
+    if (isBinary(filename))
+    {
+        QFile file(filename);
+        if (!file.open(QFile::ReadOnly)) THROW(FileAccessException, "Could not open file '" + filename + "' for reading.");
+        QByteArray header = file.read(TSVB_HEADER_SIZE);
+        if (header.size()!=TSVB_HEADER_SIZE) THROW(FileParseException, "Truncated TSVB file '" + filename + "'!");
+        quint32 header_size;
+        memcpy(&header_size, header.constData()+20, 4);
+        QByteArray header_lines = file.read(header_size);
+        if (header_lines.size()!=(qint64)header_size) THROW(FileParseException, "Truncated TSVB file '" + filename + "'!");
+
+        foreach(const QString& line, QString::fromUtf8(header_lines).split('\n', Qt::SkipEmptyParts))
+        {
+            if (line.startsWith('#') && !line.startsWith("##")) return line.mid(1).split('\t');
+        }
+        THROW(FileParseException, "Invalid TSVB file: no header line found in '" + filename + "'!");
+    }
+
+    VersatileTextStream file(filename);
+    while (!file.atEnd())
+    {
+        QString line = file.readLine(true);
+        if (line.isEmpty() || line.startsWith("##")) continue;
+        if (line[0]=='#') return line.mid(1).split('\t');
+        break;
+    }
+    THROW(FileParseException, "Invalid TSV file: no header line found in '" + filename + "'!");
 }
 
-bool DataSet::filtersPresent() const
-{
-	for (int i=0; i<columnCount(); ++i)
-	{
-		if (column(i).filter().type() != Filter::NONE)
-		{
-			return true;
-		}
-	}
+bool DataSet::isBinary(QString filename)
+{
+    QFile file(filename);
+    if (!file.open(QFile::ReadOnly)) return false;
+
+    return file.read(4)==QByteArray(TSVB_MAGIC, 4);
+}
+
+QHash<int, ColumnInfo> DataSet::loadBinary(QString filename, QString display_name)
+{
+    //signals are emitted when loading is finished
+    UpdateGuard update(*this);
+
+    if (display_name.isEmpty()) display_name = filename;
+    if (Q_BYTE_ORDER!=Q_LITTLE_ENDIAN) THROW(NotImplementedException, "TSVB files are only supported on little-endian systems!");
+
+    QElapsedTimer timer;
+    timer.start();
+
+    //map file
+    QFile file(filename);
+    if (!file.open(QFile::ReadOnly)) THROW(FileAccessException, "Could not open file '" + filename + "' for reading.");
+    const qint64 file_size = file.size();
+    const uchar* data = file_size>=TSVB_HEADER_SIZE ? file.map(0, file_size) : nullptr;
+    if (data==nullptr) THROW(FileParseException, "File '" + display_name + "' is not a TSVB file!");
+
+    //header
+    if (memcmp(data, TSVB_MAGIC, 4)!=0) THROW(FileParseException, "File '" + display_name + "' is not a TSVB file!");
+    quint32 version, cols, header_size;
+    quint64 rows;
+    memcpy(&version, data+4, 4);
+    memcpy(&rows, data+8, 8);
+    memcpy(&cols, data+16, 4);
+    memcpy(&header_size, data+20, 4);
+    if (version!=TSVB_VERSION) THROW(FileParseException, "Unsupported TSVB format version " + QString::number(version) + " in file '" + display_name + "'!");
+    const quint64 directory_start = alignTo8(TSVB_HEADER_SIZE + (quint64)header_size);
+    if (rows>(quint64)std::numeric_limits<int>::max() || directory_start + 2ull * cols * sizeof(BinaryBlock)>(quint64)file_size) THROW(FileParseException, "Truncated TSVB file '" + display_name + "'!");
+
+    //comments, TSVview-specific headers, filters and header line (same as in TSV files): creates the columns with the stored types, but without data
+    QStringList header_lines = QString::fromUtf8((const char*)data + TSVB_HEADER_SIZE, header_size).split('\n', Qt::SkipEmptyParts);
+    LineListStream stream(pagedHeaderLines(header_lines, true, true), QVector<QByteArray>());
+    QHash<int, ColumnInfo> col_infos = loadLines(stream, display_name);
+    if (columnCount()!=(int)cols || col_infos.count()!=(int)cols) THROW(FileParseException, "Invalid column information in TSVB file '" + display_name + "'!");
+
+    //blocks (two per column)
+    QVector<BinaryBlock> blocks(2 * cols);
+    memcpy(blocks.data(), data + directory_start, blocks.count() * sizeof(BinaryBlock));
+    foreach(const BinaryBlock& block, blocks)
+    {
+        if (block.offset + block.size>(quint64)file_size) THROW(FileParseException, "Truncated TSVB file '" + display_name + "'!");
+    }
+
+    //returns the raw data of a block: pointer into the mapped file, or decompressed data in @p buffer
+    auto blockData = [&](int index, QByteArray& buffer) -> const char*
+    {
+        const BinaryBlock& block = blocks[index];
+        if (block.size==block.raw_size) return (const char*)data + block.offset;
+
+        buffer.resize(block.raw_size);
+        if (!inflateBlock(data + block.offset, block.size, buffer.data(), block.raw_size)) THROW(FileParseException, "Corrupt block in TSVB file '" + display_name + "'!");
+        return buffer.constData();
+    };
+
+    //copy column data (in parallel)
+    struct ColumnData
+    {
+        QVector<double> numbers;
+        QVector<qint64> datetimes;
+        QVector<char> formats; //decimals or date/time formats
+        QVector<QString> strings;
+        QString error;
+    };
+    QList<int> indices;
+    for (int c=0; c<(int)cols; ++c)
+    {
+        indices << c;
+    }
+    QList<ColumnData> column_data = QtConcurrent::blockingMapped<QList<ColumnData>>(indices, [&](int c)
+    {
+        ColumnData output;
+        try
+        {
+            BaseColumn::Type type = column(c).type();
+            QByteArray buffer1, buffer2;
+            const char* data1 = blockData(2*c, buffer1);
+            const char* data2 = blockData(2*c+1, buffer2);
+            if (type==BaseColumn::NUMERIC || type==BaseColumn::DATETIME)
+            {
+                if (blocks[2*c].raw_size!=rows*8 || blocks[2*c+1].raw_size!=rows) THROW(FileParseException, "Invalid block size in TSVB file '" + display_name + "'!");
+
+                if (type==BaseColumn::NUMERIC)
+                {
+                    output.numbers.resize(rows);
+                    memcpy(output.numbers.data(), data1, rows*8);
+                }
+                else
+                {
+                    output.datetimes.resize(rows);
+                    memcpy(output.datetimes.data(), data1, rows*8);
+                }
+                output.formats.resize(rows);
+                memcpy(output.formats.data(), data2, rows);
+            }
+            else
+            {
+                //offsets of the values in the UTF-8 data (each value is decoded to a QString)
+                if (blocks[2*c].raw_size!=(rows+1)*8) THROW(FileParseException, "Invalid block size in TSVB file '" + display_name + "'!");
+                const quint64* offsets = (const quint64*)data1;
+                const quint64 size = blocks[2*c+1].raw_size;
+                output.strings.resize(rows);
+                for (quint64 r=0; r<rows; ++r)
+                {
+                    if (offsets[r]>offsets[r+1] || offsets[r+1]>size) THROW(FileParseException, "Invalid string offsets in TSVB file '" + display_name + "'!");
+                    output.strings[r] = QString::fromUtf8(data2 + offsets[r], offsets[r+1] - offsets[r]);
+                }
+            }
+        }
+        catch (Exception& e)
+        {
+            output.error = e.message();
+        }
+        return output;
+    });
+
+    //set column data (not in parallel because columns emit signals)
+    for (int c=0; c<(int)cols; ++c)
+    {
+        ColumnData& col_data = column_data[c];
+        if (!col_data.error.isEmpty())
+        {
+            clear(true);
+            THROW(FileParseException, col_data.error);
+        }
+
+        BaseColumn::Type type = column(c).type();
+        if (type==BaseColumn::NUMERIC)
+        {
+            numericColumn(c).setValues(col_data.numbers, col_data.formats);
+        }
+        else if (type==BaseColumn::DATETIME)
+        {
+            dateTimeColumn(c).setValues(col_data.datetimes, col_data.formats);
+        }
+        else
+        {
+            stringColumn(c).setValues(col_data.strings);
+        }
+        col_data = ColumnData();
+    }
 
-	return false;
-}
+    setModified(false);
 
-void DataSet::columnDataChanged()
-{
-	setModified(true);
+    qDebug() << "loading TSVB file: c=" << columnCount() << "r=" << rowCount() << "ms=" << timer.elapsed();
 
-	BaseColumn* column = qobject_cast<BaseColumn*>(sender());
-	emit columnChanged(columns_.indexOf(column), false);
+    return col_infos;
 }
 
-void DataSet::headerDataChanged()
+QHash<int, ColumnInfo> DataSet::loadArrow(QString filename, QString display_name)
 {
-	setModified(true);
+    //signals are emitted when loading is finished
+    UpdateGuard update(*this);
 
-	emit headersChanged();
-}
+    QElapsedTimer timer;
+    timer.start();
 
-void DataSet::filterDataChanged()
-{
-	setModified(true);
+    QByteArray metadata;
+    QList<ArrowFile::Column> columns = ArrowFile::read(filename, metadata);
 
-	emit filtersChanged();
-}
+    //comments, filters and column widths of files written by TSVview
+    QStringList header_lines;
+    QHash<int, int> widths;
+    foreach(const QString& line, QString::fromUtf8(metadata).split('\n', Qt::SkipEmptyParts))
+    {
+        if (line.startsWith("##TSVVIEW-COLINFO##"))
+        {
+            QStringList parts = line.split("##");
+            if (parts.count()<4) continue;
+            foreach(const QString& key_value, parts[3].split(';'))
+            {
+                if (key_value.startsWith("width=")) widths[parts[2].toInt()] = key_value.mid(6).toInt();
+            }
+        }
+        else if (line.startsWith("##TSVVIEW-FILTER##") || (line.startsWith("##") && !line.startsWith("##TSVVIEW-")))
+        {
+            header_lines << line;
+        }
+    }
 
-QBitArray DataSet::getRowFilter(bool update) const
-{
-	if (!filters_enabled_)
-	{
-		filtered_rows_.fill(true, rowCount());
-	}
+    //column types from the Arrow schema: creates the columns without data
+    QStringList headers;
+    for (int c=0; c<columns.count(); ++c)
+    {
+        header_lines << "##TSVVIEW-COLINFO##" + QString::number(c) + "##type=" + BaseColumn::typeToString(columns[c].type) + ";width=" + QString::number(widths.value(c, -1));
+        headers << columns[c].name;
+    }
+    header_lines << "#" + headers.join('\t');
+    LineListStream stream(header_lines, QVector<QByteArray>());
+    QHash<int, ColumnInfo> col_infos = loadLines(stream, display_name);
+    if (columnCount()!=columns.count()) THROW(FileParseException, "Invalid column names in Arrow file '" + display_name + "'!");
 
-	if (filters_enabled_ && update)
-	{
-		filtered_rows_.fill(true, rowCount());
+    //set column data
+    for (int c=0; c<columns.count(); ++c)
+    {
+        ArrowFile::Column& col = columns[c];
+        if (col.type==BaseColumn::NUMERIC)
+        {
+            numericColumn(c).setValues(col.numbers, col.formats);
+        }
+        else if (col.type==BaseColumn::DATETIME)
+        {
+            dateTimeColumn(c).setValues(col.datetimes, col.formats);
+        }
+        else
+        {
+            stringColumn(c).setValues(col.strings);
+        }
+        col = ArrowFile::Column();
+    }
+    setModified(false);
 
-		//determine rows to render
-		for (int c=0; c<columnCount(); ++c)
-		{
-			column(c).matchFilter(filtered_rows_);
-		}
-	}
+    qDebug() << "loading Arrow file: c=" << columnCount() << "r=" << rowCount() << "ms=" << timer.elapsed();
 
-	return filtered_rows_;
+    return col_infos;
 }
 
-QHash<int, ColumnInfo> DataSet::load(QString filename, QString display_name)
+template<typename Stream>
+QHash<int, ColumnInfo> DataSet::loadLines(Stream& file, QString display_name, const QStringList& columns)
 {
-    if (display_name.isEmpty()) display_name = filename;
-
-    //clear
+    //clear (signals are emitted when loading is finished)
+    UpdateGuard update(*this);
     clear(true);
 
     QElapsedTimer timer;
     timer.start();
 
     QSet<int> numeric_columns;
+    QSet<int> datetime_columns;
     QStringList comments;
     QStringList filters;
     QHash<int, ColumnInfo> col_infos;
@@ -450,7 +2019,7 @@ QHash<int, ColumnInfo> DataSet::load(QString filename, QString display_name)
     int line_nr = -1;
     int cols = -1;
     int rows = -1;
-    VersatileTextStream file(filename);
+    QVector<int> file_cols;
     while (!file.atEnd())
     {
         QString line = file.readLine(true);
@@ -503,9 +2072,20 @@ QHash<int, ColumnInfo> DataSet::load(QString filename, QString display_name)
                 QStringList parts = line.mid(1).split('\t');
                 cols = parts.size();
 
-                if (col_infos.count()==cols) col_infos_complete = true;
+                //column projection: file column of each loaded column
+                foreach(const QString& name, columns)
+                {
+                    if (!parts.contains(name)) THROW(ArgumentException, "Column '" + name + "' not found in " + display_name + "!");
+                }
                 for (int c=0; c<cols; ++c)
                 {
+                    if (columns.isEmpty() || columns.contains(parts[c])) file_cols << c;
+                }
+
+                if (col_infos.count()==cols) col_infos_complete = true;
+                for (int i=0; i<file_cols.count(); ++i)
+                {
+                    const int c = file_cols[i];
                     if (col_infos_complete && col_infos[c].type==BaseColumn::NUMERIC)
                     {
                         QVector<double> values;
@@ -517,13 +2097,25 @@ QHash<int, ColumnInfo> DataSet::load(QString filename, QString display_name)
                         }
                         addColumn(parts[c], values, decimals, false);
                     }
+                    else if (col_infos_complete && col_infos[c].type==BaseColumn::DATETIME)
+                    {
+                        QVector<qint64> values;
+                        QVector<char> formats;
+                        if (rows!=-1)
+                        {
+                            values.reserve(rows);
+                            formats.reserve(rows);
+                        }
+                        addColumn(parts[c], values, formats);
+                    }
                     else
                     {
                         QVector<QString> values;
                         if (rows!=-1) values.reserve(rows);
                         addColumn(parts[c], values);
 
-                        numeric_columns << c;
+                        numeric_columns << i;
+                        datetime_columns << i;
                     }
                 }
             }
@@ -538,9 +2130,9 @@ QHash<int, ColumnInfo> DataSet::load(QString filename, QString display_name)
         if (parts.count()!=cols) THROW(FileParseException, "Mixed number of columns in " + display_name + "!\nExpected " + QString::number(cols) + " based on header line, but found " + QString::number(parts.count()) + " in line " + QString::number(line_nr) + ":\n" + line);
 
         //add data to columns
-        for (int c=0; c<cols; ++c)
+        for (int c=0; c<file_cols.count(); ++c)
         {
-            column(c).appendString(parts[c]);
+            column(c).appendString(parts[file_cols[c]]);
         }
 
         //try to convert numbers
@@ -548,7 +2140,13 @@ QHash<int, ColumnInfo> DataSet::load(QString filename, QString display_name)
         {
             foreach(int c, numeric_columns)
             {
-                if (!isNumeric(parts[c])) numeric_columns.remove(c);
+                if (!isNumeric(parts[file_cols[c]])) numeric_columns.remove(c);
+            }
+            foreach(int c, datetime_columns)
+            {
+                const QString& part = parts[file_cols[c]];
+                if (part.isEmpty()) continue; //missing value
+                if (!DateTimeColumn::isDateTime(part)) datetime_columns.remove(c);
             }
         }
     }
@@ -565,7 +2163,11 @@ QHash<int, ColumnInfo> DataSet::load(QString filename, QString display_name)
         {
             convertStringToNumeric(c);
         }
-        qDebug() << "converting numeric columns: ms=" << timer.restart();
+        foreach(int c, datetime_columns)
+        {
+            if (!numeric_columns.contains(c) && hasValues(c)) convertStringToDateTime(c);
+        }
+        qDebug() << "converting numeric/date columns: ms=" << timer.restart();
     }
 
     //apply filters
@@ -580,7 +2182,11 @@ QHash<int, ColumnInfo> DataSet::load(QString filename, QString display_name)
         {
             filter_errors << "Unparsable filter line: " + line;
         }
-        else if (col<0 || col>=columnCount())
+        else if (!columns.isEmpty() && !file_cols.contains(col)) //filter of a column that was not loaded
+        {
+            continue;
+        }
+        else if (col<0 || col>=cols)
         {
             filter_errors << "Filter line with invalid column index: " + line;
         }
@@ -588,7 +2194,7 @@ QHash<int, ColumnInfo> DataSet::load(QString filename, QString display_name)
         {
             try
             {
-                column(col).setFilter(filter);
+                column(file_cols.indexOf(col)).setFilter(filter);
             }
             catch (FilterTypeException& e)
             {
@@ -604,12 +2210,24 @@ QHash<int, ColumnInfo> DataSet::load(QString filename, QString display_name)
 
     setModified(false);
 
+    //column infos of the loaded columns
+    if (!columns.isEmpty())
+    {
+        QHash<int, ColumnInfo> output;
+        for (int i=0; i<file_cols.count(); ++i)
+        {
+            if (col_infos.contains(file_cols[i])) output[i] = col_infos[file_cols[i]];
+        }
+        return output;
+    }
+
     return col_infos;
 }
 
 void DataSet::import(QString filename, QString display_name, Parameters params, int preview_lines)
 {
-    //clear
+    //clear (signals are emitted when loading is finished)
+    UpdateGuard update(*this);
     clear(true);
 
     QElapsedTimer timer;
@@ -625,6 +2243,7 @@ void DataSet::import(QString filename, QString display_name, Parameters params,
     }
     bool first_line_is_comment = params.getBool("first_line_is_comment");
     QSet<int> numeric_columns;
+    QSet<int> datetime_columns;
 
     QStringList comments;
     bool is_first_content_line = true;
@@ -663,6 +2282,7 @@ void DataSet::import(QString filename, QString display_name, Parameters params,
             for (int i=0; i<cols; ++i)
             {
                 numeric_columns << i;
+                datetime_columns << i;
                 addColumn("", QVector<QString>(), false);
             }
         }
@@ -693,6 +2313,11 @@ void DataSet::import(QString filename, QString display_name, Parameters params,
         {
             if (!isNumeric(parts[c])) numeric_columns.remove(c);
         }
+        foreach(int c, datetime_columns)
+        {
+            if (parts[c].isEmpty()) continue; //missing value
+            if (!DateTimeColumn::isDateTime(parts[c])) datetime_columns.remove(c);
+        }
 
         ++row;
     }
@@ -740,268 +2365,540 @@ void DataSet::import(QString filename, QString display_name, Parameters params,
     {
         convertStringToNumeric(c);
     }
+    foreach(int c, datetime_columns)
+    {
+        if (!numeric_columns.contains(c) && hasValues(c)) convertStringToDateTime(c);
+    }
 
 	setModified(first_line_is_comment, true);
 
     qDebug() << "import data: c=" << columnCount() << "r=" << rowCount() << "ms=" << timer.restart();
 }
 
-void DataSet::store(QString filename, const QList<int>& widths)
+void DataSet::store(QString filename, const QList<int>& widths, int compression_level)
 {
     QElapsedTimer timer;
     timer.start();
 
-    bool is_gz = filename.endsWith(".gz", Qt::CaseInsensitive);
-    if (is_gz)
+    //rows are stored in display order
+    applyRowOrder();
+
+    //virtual columns are stored with their evaluated values (snapshots contain them already)
+    for (int c=0; c<columnCount(); ++c)
+    {
+        if (columns_[c]->isVirtual()) materializeColumn(c);
+    }
+
+    bool is_gz = filename.endsWith(".gz", Qt::CaseInsensitive) || filename.endsWith(".bgz", Qt::CaseInsensitive);
+    if (filename.endsWith(".tsvb", Qt::CaseInsensitive))
+    {
+        storeBinary(filename, widths, compression_level);
+    }
+    else if (is_gz)
     {
-        storeGzipped(filename, widths);
+        storeGzipped(filename, widths, compression_level);
     }
     else
     {
         storePlain(filename, widths);
     }
 
-    qDebug() << QString("storing")+(is_gz ? " (GZ)" : "")+" ms=" << timer.elapsed();
+    qDebug() << QString("storing")+(is_gz ? " (GZ, level " + QString::number(compression_level) + ")" : "")+" threads=" << QThread::idealThreadCount() << "ms=" << timer.elapsed();
 }
 
 void DataSet::storePlain(QString filename, const QList<int>& widths)
 {
     if (widths.count()!=columnCount()) THROW(ProgrammingException, "Widths count and column count not matching in storePlain(...)!'");
 
-    // open file
-    QFile file(filename);
-    if (!file.open(QFile::WriteOnly | QFile::Truncate))
+    // open file (data is written to a temporary file, which replaces the file on commit)
+    QSaveFile file(filename);
+    if (!file.open(QFile::WriteOnly))
     {
         THROW(FileAccessException, "Could not open file '" + filename + "' for writing.");
     }
 
-    //write comments
-    QTextStream stream(&file);
-    foreach(const QString& comment, comments())
+    //write comments, TSVview headers and header
+    QByteArray header = headerLines(widths);
+    if (file.write(header)!=header.size()) THROW(FileAccessException, "Could not write to file '" + filename + "'.");
+
+    //write data
+    formatBlocks([this](int start, int end)
     {
-        if (comment.startsWith("##TSVVIEW-")) continue;
-        stream << comment << '\n';
-    }
-    stream << "##TSVVIEW-ROWS##" << rowCount() << '\n';
-    for (int c=0; c<columnCount(); ++c)
+        return formatRows(start, end);
+    },
+    [&](const QByteArray& buffer)
     {
-        stream << "##TSVVIEW-COLINFO##" << QString::number(c) << "##type=" << BaseColumn::typeToString(column(c).type()) << ";width=" << QString::number(widths[c]) << "\n";
-    }
+        if (file.write(buffer)!=buffer.size()) THROW(FileAccessException, "Could not write to file '" + filename + "'.");
+    });
 
-    //write filters
-    for (int c=0; c<columnCount(); ++c)
+    if (!file.commit()) THROW(FileAccessException, "Could not write to file '" + filename + "': " + file.errorString());
+}
+
+void DataSet::formatBlocks(std::function<QByteArray(int, int)> format, std::function<void(const QByteArray&)> write)
+{
+    //blocks of rows are formatted in parallel and passed on in order
+    const int rows = rowCount();
+    const int blocks = (rows + STORE_BLOCK_ROWS - 1) / STORE_BLOCK_ROWS;
+    const int batch = 4 * std::max(1, QThread::idealThreadCount());
+    for (int b=0; b<blocks; b+=batch)
     {
-        if (column(c).filter().type()!=Filter::NONE)
+        QList<int> indices;
+        for (int i=b; i<std::min(blocks, b+batch); ++i)
         {
-            stream << column(c).filter().toString(c) << '\n';
+            indices << i;
         }
-    }
-
-    // write header
-    stream << '#' << headers().join('\t') << '\n';
 
-    // write data
-    for (int r=0; r<rowCount(); ++r)
-    {
-        if (r!=0)
+        QList<QByteArray> buffers = QtConcurrent::blockingMapped<QList<QByteArray>>(indices, [&format, rows](int i)
         {
-            stream << '\n';
-        }
-        for (int c=0; c<columnCount(); ++c)
+            return format(i * STORE_BLOCK_ROWS, std::min(rows, (i+1) * STORE_BLOCK_ROWS));
+        });
+
+        foreach(const QByteArray& buffer, buffers)
         {
-            if (c!=0)
-            {
-                stream << '\t';
-            }
-            stream << column(c).string(r);
+            write(buffer);
         }
+
+        emit storeProgress(100 * std::min(blocks, b+batch) / blocks);
     }
 }
 
-void DataSet::storeGzipped(QString filename, const QList<int>& widths)
+QByteArray DataSet::headerLines(const QList<int>& widths) const
 {
-    if (widths.count()!=columnCount()) THROW(ProgrammingException, "Widths count and column count not matching in storeGzipped(...)!'");
+    QByteArray output;
 
-    // open file
-    gzFile file = gzopen(filename.toUtf8().constData(), "wb");
-    if (!file) THROW(FileAccessException, "Could not open file '" + filename + "' for writing.");
-
-    //write comments
+    //comments
     foreach(const QString& comment, comments())
     {
         if (comment.startsWith("##TSVVIEW-")) continue;
-        QByteArray tmp = (comment +'\n').toUtf8();
-        gzwrite(file, tmp.constData(), tmp.size());
+        output.append(comment.toUtf8());
+        output.append('\n');
     }
-    QByteArray tmp = ("##TSVVIEW-ROWS##" + QByteArray::number(rowCount()) + '\n');
-    gzwrite(file, tmp.constData(), tmp.size());
+
+    //TSVview headers
+    output.append("##TSVVIEW-ROWS##" + QByteArray::number(rowCount()) + '\n');
     for (int c=0; c<columnCount(); ++c)
     {
-        QByteArray tmp = ("##TSVVIEW-COLINFO##" + QByteArray::number(c) + "##type=" + BaseColumn::typeToString(column(c).type()).toUtf8() + ";width="+QByteArray::number(widths[c]) +"\n");
-        gzwrite(file, tmp.constData(), tmp.size());
+        output.append("##TSVVIEW-COLINFO##" + QByteArray::number(c) + "##type=" + BaseColumn::typeToString(column(c).type()).toUtf8() + ";width=" + QByteArray::number(widths[c]) + '\n');
     }
 
-    //write filters
+    //filters
     for (int c=0; c<columnCount(); ++c)
     {
         if (column(c).filter().type()!=Filter::NONE)
         {
-            QByteArray tmp = (column(c).filter().toString(c) + '\n').toUtf8();
-            gzwrite(file, tmp.constData(), tmp.size());
+            output.append(column(c).filter().toString(c).toUtf8());
+            output.append('\n');
         }
     }
 
-    // write header
-    tmp = ('#' + headers().join('\t') +'\n').toUtf8();
-    gzwrite(file, tmp.constData(), tmp.size());
+    //header
+    output.append('#');
+    for (int c=0; c<columnCount(); ++c)
+    {
+        if (c!=0) output.append('\t');
+        output.append(column(c).header().toUtf8());
+    }
+    output.append('\n');
+
+    return output;
+}
+
+QByteArray DataSet::formatRows(int start, int end) const
+{
+    //format each column separately (one virtual call per column)
+    const int cols = columnCount();
+    QVector<QByteArray> values(cols);
+    QVector<QVector<int>> ends(cols);
+    qsizetype size = (qsizetype)(end - start) * cols;
+    for (int c=0; c<cols; ++c)
+    {
+        ends[c].reserve(end - start);
+        columns_[c]->appendUtf8(start, end, values[c], ends[c]);
+        size += values[c].size();
+    }
 
-    // write data
-    for (int r=0; r<rowCount(); ++r)
+    //interleave columns to rows (rows are separated by newlines, no newline after the last row)
+    QByteArray output;
+    output.reserve(size);
+    QVector<int> pos(cols, 0);
+    for (int r=0; r<end-start; ++r)
     {
-        QByteArray tmp;
-        if (r!=0)
+        if (start+r!=0) output.append('\n');
+        for (int c=0; c<cols; ++c)
         {
-            tmp.append('\n');
+            if (c!=0) output.append('\t');
+            const int value_end = ends[c][r];
+            output.append(values[c].constData() + pos[c], value_end - pos[c]);
+            pos[c] = value_end;
         }
-        for (int c=0; c<columnCount(); ++c)
+    }
+
+    return output;
+}
+
+void DataSet::storeGzipped(QString filename, const QList<int>& widths, int compression_level)
+{
+    if (widths.count()!=columnCount()) THROW(ProgrammingException, "Widths count and column count not matching in storeGzipped(...)!'");
+
+    //open file (BGZF: independent gzip blocks that are compressed in parallel)
+    BgzfWriter writer(filename, compression_level);
+
+    //write comments, TSVview headers and header
+    writer.write(headerLines(widths));
+
+    //write data
+    formatBlocks([this](int start, int end)
+    {
+        return formatRows(start, end);
+    },
+    [&writer](const QByteArray& buffer)
+    {
+        writer.write(buffer);
+    });
+
+    writer.close();
+}
+
+void DataSet::storeBinary(QString filename, const QList<int>& widths, int compression_level)
+{
+    if (widths.count()!=columnCount()) THROW(ProgrammingException, "Widths count and column count not matching in storeBinary(...)!'");
+    if (Q_BYTE_ORDER!=Q_LITTLE_ENDIAN) THROW(NotImplementedException, "TSVB files are only supported on little-endian systems!");
+
+    //comments, TSVview-specific headers, filters and header line (same as in TSV files)
+    const QByteArray header = headerLines(widths);
+    const quint64 rows = rowCount();
+    const quint32 cols = columnCount();
+
+    //create column blocks (in parallel). Raw blocks of numeric columns refer to the column data without copying.
+    QList<int> indices;
+    for (int c=0; c<(int)cols; ++c)
+    {
+        indices << c;
+    }
+    QList<QPair<QByteArray, QByteArray>> column_blocks = QtConcurrent::blockingMapped<QList<QPair<QByteArray, QByteArray>>>(indices, [this, rows](int c)
+    {
+        const BaseColumn& col = column(c);
+        if (col.type()==BaseColumn::NUMERIC)
+        {
+            const NumericColumn& numeric = numericColumn(c);
+            return qMakePair(QByteArray::fromRawData((const char*)numeric.values().constData(), rows*8), QByteArray::fromRawData(numeric.decimals().constData(), rows));
+        }
+        if (col.type()==BaseColumn::DATETIME)
+        {
+            const DateTimeColumn& datetime = dateTimeColumn(c);
+            return qMakePair(QByteArray::fromRawData((const char*)datetime.values().constData(), rows*8), QByteArray::fromRawData(datetime.formats().constData(), rows));
+        }
+
+        //strings: offsets into UTF-8 data
+        QVector<quint64> offsets;
+        offsets.reserve(rows+1);
+        offsets << 0;
+        QByteArray utf8;
+        for (int start=0; start<(int)rows; start+=STORE_BLOCK_ROWS)
         {
-            if (c!=0)
+            QByteArray chunk;
+            QVector<int> ends;
+            col.appendUtf8(start, std::min((int)rows, start+STORE_BLOCK_ROWS), chunk, ends);
+            foreach(int end, ends)
             {
-                tmp.append('\t');
+                offsets << (quint64)utf8.size() + end;
             }
-            tmp.append(column(c).string(r).toUtf8());
+            utf8.append(chunk);
+        }
+        return qMakePair(QByteArray((const char*)offsets.constData(), offsets.count()*8), utf8);
+    });
+
+    //compress blocks (in parallel)
+    QList<QByteArray> raw;
+    foreach(const auto& blocks, column_blocks)
+    {
+        raw << blocks.first << blocks.second;
+    }
+    QList<QByteArray> stored = raw;
+    if (compression_level>0)
+    {
+        stored = QtConcurrent::blockingMapped<QList<QByteArray>>(raw, [compression_level](const QByteArray& block)
+        {
+            return deflateBlock(block.constData(), block.size(), compression_level);
+        });
+
+        //incompressible blocks are stored uncompressed (stored size equals raw size)
+        for (int i=0; i<raw.count(); ++i)
+        {
+            if (stored[i].size()>=raw[i].size()) stored[i] = raw[i];
         }
-        gzwrite(file, tmp.constData(), tmp.size());
     }
 
-    gzclose(file);
+    //directory
+    const quint64 directory_start = alignTo8(TSVB_HEADER_SIZE + header.size());
+    QVector<BinaryBlock> directory;
+    quint64 offset = directory_start + 2ull * cols * sizeof(BinaryBlock);
+    for (int i=0; i<raw.count(); ++i)
+    {
+        directory << BinaryBlock{offset, (quint64)stored[i].size(), (quint64)raw[i].size()};
+        offset = alignTo8(offset + stored[i].size());
+    }
+
+    //write file (data is written to a temporary file, which replaces the file on commit)
+    QSaveFile file(filename);
+    if (!file.open(QFile::WriteOnly)) THROW(FileAccessException, "Could not open file '" + filename + "' for writing.");
+    auto write = [&](const char* data, qint64 size)
+    {
+        if (file.write(data, size)!=size) THROW(FileAccessException, "Could not write to file '" + filename + "'.");
+    };
+    auto pad = [&]()
+    {
+        static const char zeros[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+        write(zeros, alignTo8(file.pos()) - file.pos());
+    };
+    const quint32 header_size = header.size();
+    write(TSVB_MAGIC, 4);
+    write((const char*)&TSVB_VERSION, 4);
+    write((const char*)&rows, 8);
+    write((const char*)&cols, 4);
+    write((const char*)&header_size, 4);
+    write(header.constData(), header.size());
+    pad();
+    write((const char*)directory.constData(), directory.count() * sizeof(BinaryBlock));
+    for (int i=0; i<stored.count(); ++i)
+    {
+        write(stored[i].constData(), stored[i].size());
+        pad();
+
+        emit storeProgress(100 * (i+1) / stored.count());
+    }
+    if (!file.commit()) THROW(FileAccessException, "Could not write to file '" + filename + "': " + file.errorString());
 }
 
-void DataSet::storeAs(QString filename, ExportFormat format)
+void DataSet::storeAs(QString filename, ExportFormat format, const QBitArray& data_rows, const QBitArray& cols)
 {
-    if (format==ExportFormat::HTML)
+    if (!data_rows.isEmpty() && data_rows.count()!=rowCount()) THROW(ProgrammingException, "Row bitmap size and row count not matching in storeAs(...)!");
+    if (!cols.isEmpty() && cols.count()!=columnCount()) THROW(ProgrammingException, "Column bitmap size and column count not matching in storeAs(...)!");
+
+    //rows are exported in display order
+    QBitArray rows = data_rows;
+    if (!row_order_.isEmpty() && !data_rows.isEmpty())
+    {
+        for (int r=0; r<rows.count(); ++r)
+        {
+            rows.setBit(r, data_rows.testBit(row_order_[r]));
+        }
+    }
+    applyRowOrder();
+    for (int c=0; c<columnCount(); ++c)
+    {
+        if (columns_[c]->isVirtual()) materializeColumn(c);
+    }
+
+    //columns to export
+    QVector<int> col_indices;
+    for (int c=0; c<columnCount(); ++c)
+    {
+        if (cols.isEmpty() || cols.testBit(c)) col_indices << c;
+    }
+
+    if (format==ExportFormat::HTML || format==ExportFormat::CSV)
     {
-        storeAsHtml(filename);
+        storeAsText(filename, format, rows, col_indices);
     }
-    else if (format==ExportFormat::CSV)
+    else if (format==ExportFormat::ARROW)
     {
-        storeAsCsv(filename);
+        if (!rows.isEmpty() && rows.count(true)!=rowCount()) THROW(NotImplementedException, "Exporting a subset of rows is not supported for Arrow files!");
+        storeAsArrow(filename, col_indices);
     }
     else THROW(NotImplementedException, "Invalid format!");
 }
 
-void DataSet::storeAsHtml(QString filename)
+void DataSet::storeAsArrow(QString filename, const QVector<int>& cols)
 {
-    // open file
-    QFile file(filename);
-    if (!file.open(QFile::WriteOnly | QFile::Truncate))
+    QElapsedTimer timer;
+    timer.start();
+
+    //TSVview-specific meta data (comments, filters, ...) is stored in the schema meta data
+    QList<const BaseColumn*> columns;
+    foreach(int c, cols)
     {
-        THROW(FileAccessException, "Could not open file '" + filename + "' for writing.");
+        columns << columns_[c];
     }
+    QByteArray metadata = cols.count()==columnCount() ? headerLines(QList<int>(columnCount(), -1)) : QByteArray();
+    ArrowFile::write(filename, columns, metadata);
 
-    // write header
-    QTextStream stream(&file);
-    int indent = 0;
+    qDebug() << "storing Arrow file: ms=" << timer.elapsed();
+}
 
-    //before table
-    writeHtml(stream, indent, "<html>", true);
-    indent += 2;
-    writeHtml(stream, indent, "<head>", true);
-    indent += 2;
-    writeHtml(stream, indent, "<style>", true);
-    indent += 2;
-    writeHtml(stream, indent, "table { border-collapse: collapse; width: auto; border: 1px solid #444; }", true);
-    writeHtml(stream, indent, "table td { border: 1px solid #444; padding: 2px; }", true);
-    writeHtml(stream, indent, "table th { border: 1px solid #444; text-align: left; padding: 2px; background: #ccc; font-weight: 600; }", true);
-    writeHtml(stream, indent, "table tr:nth-child(even) td { background: #f3f3f3; }", true);
-    writeHtml(stream, indent, "table tr:hover td { background: #d0d7df; }", true);
-    indent -= 2;
-    writeHtml(stream, indent, "</style>", true);
-    indent -= 2;
-    writeHtml(stream, indent, "</head>", true);
-    writeHtml(stream, indent, "<body>", true);
-    indent += 2;
-    writeHtml(stream, indent, "<table>", true);
-    indent += 2;
+void DataSet::storeAsText(QString filename, ExportFormat format, const QBitArray& rows, const QVector<int>& cols)
+{
+    QElapsedTimer timer;
+    timer.start();
 
-    //header line
-    QStringList header_names = headers();
-    writeHtml(stream, indent, "<tr>", true);
-    indent += 2;
-    for(int i=0; i<header_names.count(); ++i)
+    // open file (data is written to a temporary file, which replaces the file on commit)
+    QSaveFile file(filename);
+    if (!file.open(QFile::WriteOnly))
     {
-        writeHtml(stream, indent, "<th>"+header_names[i].toUtf8()+"</th>", true);
+        THROW(FileAccessException, "Could not open file '" + filename + "' for writing.");
     }
-    indent -= 2;
-    writeHtml(stream, indent, "</tr>", true);
 
-    //content lines
-    for (int row=0; row<rowCount(); ++row)
+    //output is collected in blocks to avoid many small writes
+    QByteArray buffer;
+    buffer.reserve(STORE_BUFFER_SIZE + STORE_BUFFER_SIZE/4);
+    auto write = [&](const QByteArray& data, bool flush)
+    {
+        buffer.append(data);
+        if (buffer.size()>=STORE_BUFFER_SIZE || flush)
+        {
+            if (file.write(buffer)!=buffer.size()) THROW(FileAccessException, "Could not write to file '" + filename + "'.");
+            buffer.resize(0);
+        }
+    };
+
+    //header
+    QByteArray header;
+    if (format==ExportFormat::HTML)
+    {
+        header.append("<html>\n"
+                      "  <head>\n"
+                      "    <style>\n"
+                      "      table { border-collapse: collapse; width: auto; border: 1px solid #444; }\n"
+                      "      table td { border: 1px solid #444; padding: 2px; }\n"
+                      "      table th { border: 1px solid #444; text-align: left; padding: 2px; background: #ccc; font-weight: 600; }\n"
+                      "      table tr:nth-child(even) td { background: #f3f3f3; }\n"
+                      "      table tr:hover td { background: #d0d7df; }\n"
+                      "    </style>\n"
+                      "  </head>\n"
+                      "  <body>\n"
+                      "    <table>\n"
+                      "      <tr>\n");
+        foreach(int c, cols)
+        {
+            QByteArray name = column(c).header().toUtf8();
+            header.append("        <th>");
+            appendEscaped(header, name.constData(), name.size(), format);
+            header.append("</th>\n");
+        }
+        header.append("      </tr>\n");
+    }
+    else
     {
-        writeHtml(stream, indent, "<tr>", true);
-        indent += 2;
-        for(int col=0; col<columnCount(); ++col)
+        for (int i=0; i<cols.count(); ++i)
         {
-            writeHtml(stream, indent, "<td>"+column(col).string(row).toUtf8()+"</td>", true);
+            if (i!=0) header.append(',');
+            QByteArray name = column(cols[i]).header().toUtf8();
+            appendEscaped(header, name.constData(), name.size(), format);
         }
-        indent -= 2;
-        writeHtml(stream, indent, "</tr>", true);
     }
+    write(header, false);
+
+    //content
+    formatBlocks([&](int start, int end)
+    {
+        return formatExportRows(start, end, format, rows, cols);
+    },
+    [&](const QByteArray& block)
+    {
+        write(block, false);
+    });
+
+    //footer
+    QByteArray footer;
+    if (format==ExportFormat::HTML)
+    {
+        footer.append("    </table>\n"
+                      "  </body>\n"
+                      "</html>\n");
+    }
+    write(footer, true);
+
+    if (!file.commit()) THROW(FileAccessException, "Could not write to file '" + filename + "': " + file.errorString());
 
-    //after
-    indent -= 2;
-    writeHtml(stream, indent, "</table>", true);
-    indent -= 2;
-    writeHtml(stream, indent, "</body>", true);
-    indent -= 2;
-    writeHtml(stream, indent, "</html>", true);
+    qDebug() << "exporting text file: c=" << cols.count() << "ms=" << timer.elapsed();
 }
 
-void DataSet::writeHtml(QTextStream& stream, int indent, QByteArray text, bool newline)
+QByteArray DataSet::formatExportRows(int start, int end, ExportFormat format, const QBitArray& rows, const QVector<int>& cols) const
 {
-    if (indent>0) stream << QByteArray().fill(' ', indent);
-    stream << text;
-    if (newline) stream << "\n";
+    //format each column separately (one virtual call per column)
+    QVector<QByteArray> values(cols.count());
+    QVector<QVector<int>> ends(cols.count());
+    qsizetype size = 0;
+    for (int i=0; i<cols.count(); ++i)
+    {
+        ends[i].reserve(end - start);
+        columns_[cols[i]]->appendUtf8(start, end, values[i], ends[i]);
+        size += values[i].size();
+    }
+
+    //interleave columns to rows. Each row starts with a newline (CSV) or is enclosed in a tr-element (HTML).
+    QByteArray output;
+    output.reserve(size + size/8 + (qsizetype)(end - start) * cols.count() * (format==ExportFormat::HTML ? 18 : 1) + 32);
+    QVector<int> pos(cols.count(), 0);
+    for (int r=0; r<end-start; ++r)
+    {
+        const bool selected = rows.isEmpty() || rows.testBit(start + r);
+        if (selected && format==ExportFormat::HTML) output.append("      <tr>\n");
+        if (selected && format==ExportFormat::CSV) output.append('\n');
+        for (int i=0; i<cols.count(); ++i)
+        {
+            const int value_end = ends[i][r];
+            if (selected)
+            {
+                if (format==ExportFormat::HTML) output.append("        <td>");
+                else if (i!=0) output.append(',');
+                appendEscaped(output, values[i].constData() + pos[i], value_end - pos[i], format);
+                if (format==ExportFormat::HTML) output.append("</td>\n");
+            }
+            pos[i] = value_end;
+        }
+        if (selected && format==ExportFormat::HTML) output.append("      </tr>\n");
+    }
+
+    return output;
 }
 
-void DataSet::storeAsCsv(QString filename)
+void DataSet::appendEscaped(QByteArray& output, const char* data, int size, ExportFormat format)
 {
-    // open file
-    QFile file(filename);
-    if (!file.open(QFile::WriteOnly | QFile::Truncate))
+    //single pass: find the first character that needs escaping (UTF-8 continuation bytes never match)
+    const char* end = data + size;
+    const char* special = data;
+    if (format==ExportFormat::HTML)
     {
-        THROW(FileAccessException, "Could not open file '" + filename + "' for writing.");
+        while (special<end && *special!='<' && *special!='>' && *special!='&' && *special!='"') ++special;
+    }
+    else
+    {
+        while (special<end && *special!=',' && *special!='"' && *special!='\n' && *special!='\r') ++special;
     }
 
-    // write header
-    QTextStream stream(&file);
-
-    QStringList header_names = headers();
-    for (int col=0; col<header_names.count(); ++col)
+    //nothing to escape
+    if (special==end)
     {
-        if (col!=0) stream << ',';
-        stream << escapeForCsv(header_names[col]);
+        output.append(data, size);
+        return;
     }
-    stream << '\n';
 
-    // write data
-    for (int row=0; row<rowCount(); ++row)
+    //escape the rest
+    if (format==ExportFormat::HTML)
     {
-        if (row!=0) stream << '\n';
-        for (int col=0; col<columnCount(); ++col)
+        output.append(data, special - data);
+        for (const char* p=special; p<end; ++p)
         {
-            if (col!=0) stream << ',';
-            stream << escapeForCsv(column(col).string(row));
+            switch(*p)
+            {
+                case '<': output.append("&lt;"); break;
+                case '>': output.append("&gt;"); break;
+                case '&': output.append("&amp;"); break;
+                case '"': output.append("&quot;"); break;
+                default: output.append(*p);
+            }
         }
     }
-}
-
-QString DataSet::escapeForCsv(QString s)
-{
-    s.replace("\"", "\"\"");
-    if (s.contains(',') || s.contains('"') || s.contains('\n'))
+    else
     {
-        s = "\"" + s + "\"";
+        output.append('"');
+        output.append(data, special - data);
+        for (const char* p=special; p<end; ++p)
+        {
+            if (*p=='"') output.append('"');
+            output.append(*p);
+        }
+        output.append('"');
     }
-    return s;
 }
@@ -3,13 +3,22 @@
 
 #include "StringColumn.h"
 #include "NumericColumn.h"
+#include "DateTimeColumn.h"
+#include "IntervalIndex.h"
+#include "PagedFile.h"
+#include "Exceptions.h"
 #include <Helper.h>
 #include <QSet>
+#include <QMap>
+#include <QSharedPointer>
+#include <QMutex>
+#include <functional>
 
 enum ExportFormat
 {
     HTML,
-    CSV
+    CSV,
+    ARROW
 };
 
 struct ColumnInfo
@@ -28,14 +37,30 @@ public:
 	DataSet();
 	~DataSet();
 
-    //load TSV or TSV.GZ file. If display name is not set, the filename is used.
-    QHash<int, ColumnInfo> load(QString filename, QString display_name="");
+    //load TSV, TSV.GZ, TSVB or Arrow IPC file. If display name is not set, the filename is used. If @p columns is not empty, only the columns with these names are loaded (in file order).
+    QHash<int, ColumnInfo> load(QString filename, QString display_name="", const QStringList& columns = QStringList());
+    //returns if the file is in the binary columnar TSVB format.
+    static bool isBinary(QString filename);
+    //returns the column headers of a TSV, TSV.GZ, TSVB or Arrow IPC file. Only the header lines of text files are read.
+    static QStringList fileHeaders(QString filename);
+    //load the rows of a bgzipped TSV file with tabix index (.tbi/.csi) that overlap the given region (chr:start-end). Header lines are loaded as well.
+    QHash<int, ColumnInfo> loadRegion(QString filename, QString region, QString display_name="");
+    //load a file that does not fit into memory in paged mode: only one page of rows is held in memory. @p cache_size is the maximum size of cached file chunks in bytes.
+    QHash<int, ColumnInfo> loadPaged(QString filename, qint64 cache_size);
+    //load a page of the paged file. Filters of the current page are kept.
+    QHash<int, ColumnInfo> loadPage(int page);
+    //load a random sample of rows of a TSV file (in file order). Large uncompressed files are sampled using random file offsets, other files by reservoir sampling.
+    //Fewer rows are loaded only if the file has fewer lines (or the offsets hit too few distinct lines), see subset().
+    QHash<int, ColumnInfo> loadSample(QString filename, int rows, QString display_name="");
     //import data from TXT file.
     void import(QString filename, QString display_name, Parameters params, int preview_lines = -1);
-    //store TSV of TSV.GZ file. Column widths have to be given, but can be -1 if unkonwn.
-    void store(QString filename, const QList<int>& widths);
-    //export
-    void storeAs(QString filename, ExportFormat format);
+    //store TSV of TSV.GZ file. Column widths have to be given, but can be -1 if unkonwn. GZ files are written in BGZF format with the given zlib compression level (-1 for the default).
+    //TSVB files are written in the binary columnar format. Column blocks are compressed with zlib if the compression level is greater than 0.
+    //The data is written to a temporary file, which atomically replaces the file when writing succeeded. Rows are written in display order (the row order is applied to the data first, so use it on a snapshot).
+    void store(QString filename, const QList<int>& widths, int compression_level = -1);
+    //export. Only rows and columns set in the bitmaps are exported (all if a bitmap is empty). Subsets of rows are not supported for Arrow files. Rows are exported in display order (like store).
+    //HTML and CSV are formatted in blocks (in parallel) and emit storeProgress.
+    void storeAs(QString filename, ExportFormat format, const QBitArray& rows = QBitArray(), const QBitArray& cols = QBitArray());
 
 	const BaseColumn& column(int column) const
 	{
@@ -47,17 +72,19 @@ public:
 		Q_ASSERT(column<columns_.size());
 		return *(columns_[column]);
 	}
+	///Typed column access. Const access to virtual columns returns their evaluated values and needs an EvaluationScope. Non-const access to virtual columns throws a ProgrammingException, i.e. they have to be materialized before they are modified (see materializeColumn).
 	const StringColumn& stringColumn(int column) const
 	{
 		Q_ASSERT(column<columns_.size());
 		Q_ASSERT(columns_[column]->type()==BaseColumn::STRING);
-		return *dynamic_cast<const StringColumn*>(columns_[column]);
+		return *dynamic_cast<const StringColumn*>(&columns_[column]->evaluated());
 	}
 
 	StringColumn& stringColumn(int column)
 	{
 		Q_ASSERT(column<columns_.size());
 		Q_ASSERT(columns_[column]->type()==BaseColumn::STRING);
+		if (columns_[column]->isVirtual()) THROW(ProgrammingException, "Non-const access to virtual column " + QString::number(column) + "!");
 
 		return *dynamic_cast<StringColumn*>(columns_[column]);
 	}
@@ -66,21 +93,37 @@ public:
 		Q_ASSERT(column<columns_.size());
 		Q_ASSERT(columns_[column]->type()==BaseColumn::NUMERIC);
 
-		return *dynamic_cast<const NumericColumn*>(columns_[column]);
+		return *dynamic_cast<const NumericColumn*>(&columns_[column]->evaluated());
 	}
 	NumericColumn& numericColumn(int column)
 	{
 		Q_ASSERT(column<columns_.size());
 		Q_ASSERT(columns_[column]->type()==BaseColumn::NUMERIC);
+		if (columns_[column]->isVirtual()) THROW(ProgrammingException, "Non-const access to virtual column " + QString::number(column) + "!");
 
 		return *dynamic_cast<NumericColumn*>(columns_[column]);
 	}
+	const DateTimeColumn& dateTimeColumn(int column) const
+	{
+		Q_ASSERT(column<columns_.size());
+		Q_ASSERT(columns_[column]->type()==BaseColumn::DATETIME);
+
+		return *dynamic_cast<const DateTimeColumn*>(&columns_[column]->evaluated());
+	}
+	DateTimeColumn& dateTimeColumn(int column)
+	{
+		Q_ASSERT(column<columns_.size());
+		Q_ASSERT(columns_[column]->type()==BaseColumn::DATETIME);
+		if (columns_[column]->isVirtual()) THROW(ProgrammingException, "Non-const access to virtual column " + QString::number(column) + "!");
+
+		return *dynamic_cast<DateTimeColumn*>(columns_[column]);
+	}
 
 	/// Retruns the column header list.
 	QStringList headers();
 
 	/// Returns the index of the column with the given name, or -1 if no such column exists.
-	int indexOf(const QString& name);
+	int indexOf(const QString& name) const;
 
 	int columnCount() const
 	{
@@ -102,17 +145,173 @@ public:
 	void removeColumns(QSet<int> columns);
     void addColumn(QString header, const QVector<double>& data, const QVector<char>& decimals, int index = -1);
     void addColumn(QString header, const QVector<QString>& data, int index = -1);
+    void addColumn(QString header, const QVector<qint64>& data, const QVector<char>& formats, int index = -1);
     void replaceColumn(int index, QString header, const QVector<double>& data, const QVector<char>& decimals);
+    void replaceColumn(int index, QString header, const QVector<qint64>& data, const QVector<char>& formats);
+	///Adds a virtual column, whose values are computed from other columns using a formula when they are needed (see VirtualColumn). Throws an ArgumentException if the formula is invalid.
+	void addVirtualColumn(QString header, QString formula, char decimals, int index = -1);
+	///Replaces a virtual column by a column with its evaluated values.
+	void materializeColumn(int column);
+	///Sorts all rows by the given column (stable). Only the display order is changed, see rowOrder().
 	void sortByColumn(int column, bool reverse);
+	///Sorts all rows by several columns (stable). The first column is the primary key, the second column the secondary key, etc. @p reverse contains the sort direction of each column.
+	///Only the display order is changed, see rowOrder(). Sort orders are cached until the data changes.
+	void sortByColumns(const QList<int>& columns, const QList<bool>& reverse);
+	///Returns the stable sort order of the rows by several columns (see sortByColumns).
+	QVector<int> sortOrder(const QList<int>& columns, const QList<bool>& reverse) const;
+	///Reorders all rows according to @p order: row i is set to the former row order[i]. Columns are reordered in parallel.
+	void applyPermutation(const QVector<int>& order);
+	///Returns the display order of the rows, i.e. the data row of each displayed row. Empty if the rows are displayed in the original order.
+	const QVector<int>& rowOrder() const
+	{
+		return row_order_;
+	}
+	///Sets the display order of the rows (empty for the original order). The column data is not changed. Storing and exporting use the display order.
+	void setRowOrder(const QVector<int>& order);
+	///Restores the original row order.
+	void restoreRowOrder()
+	{
+		setRowOrder(QVector<int>());
+	}
+	///Reorders the column data according to the display order, which thus becomes the original order.
+	void applyRowOrder();
+	///Adapts the display order to the reduction of the data to the given rows. Has to be called before the rows are removed.
+	void reduceRowOrder(const QBitArray& rows);
 	void mergeColumns(QList<int> cols, QString header, QString sep);
-	void reduceToRows(QSet<int> rows);
+	///Keeps only the rows set in @p rows. Columns are reduced in parallel.
+	void reduceToRows(const QBitArray& rows);
+	///Sets row i of all columns to the former row rows[i]. Rows may be omitted or repeated. Columns are gathered in parallel. The display order is not adapted, i.e. it has to be applied or adapted before.
+	void gatherRows(const QVector<int>& rows);
+	///Returns the first row of each distinct key formed by the given columns, i.e. the rows to keep when removing duplicates.
+	QBitArray uniqueRows(const QList<int>& columns) const;
+	///Returns all rows whose key formed by the given columns occurs more than once.
+	QBitArray duplicateRows(const QList<int>& columns) const;
+	///Returns the first row with the same key (values of the given columns) for each row. @p counts contains the number of rows of each key at the index of its first row.
+	///Only rows set in @p rows are grouped (all if empty), the first row of other rows is -1.
+	///Keys are hashed from the native column values in parallel blocks. Rows are then grouped with a hash table per hash partition (in parallel).
+	QVector<int> firstRowsOfKeys(const QList<int>& columns, QVector<int>& counts, const QBitArray& rows = QBitArray()) const;
 	void convertStringToNumeric(int c);
+	void convertStringToDateTime(int c);
+
+	///Returns a description of the loaded part of the file, if not the whole file was loaded (e.g. 'region chr1:1-1000 of file.tsv.gz'). Returns an empty string otherwise.
+	const QString& subset() const
+	{
+		return subset_;
+	}
+
+	///Returns if the dataset is a random sample of the rows of a file.
+	bool isSample() const
+	{
+		return sample_;
+	}
+
+	///Number of rows per page in paged mode.
+	static const int PAGE_ROWS = 8 * PagedFile::CHUNK_ROWS;
+	///Returns if the dataset is in paged mode, i.e. only one page of the file is loaded.
+	bool isPaged() const
+	{
+		return !paged_file_.isNull();
+	}
+	///Returns the current page in paged mode.
+	int page() const
+	{
+		return page_;
+	}
+	///Returns the number of pages (1 if not in paged mode).
+	int pageCount() const;
+	///Returns the number of rows of the file in paged mode, or the number of rows otherwise.
+	qint64 fileRowCount() const;
+	///Returns the values of a column for all rows of the paged file that pass the current filters (non-numeric values are NAN). Rows of chunks the filters are not applicable to are skipped and counted in @p skipped.
+	QVector<double> fileColumnValues(int c, int& skipped) const;
+	///Loads all rows of the paged file that pass the current filters (leaves paged mode). Rows of chunks the filters are not applicable to are skipped and counted in @p skipped.
+	QHash<int, ColumnInfo> loadFilteredRows(int& skipped);
 
 	bool modified() const
 	{
 		return modified_;
 	}
     void setModified(bool changed, bool force_emit=false);
+	///Returns the modification version, which is increased with every modification.
+	quint64 version() const
+	{
+		return version_;
+	}
+	///Returns a copy of the columns, comments and filters, e.g. for storing in a background thread. Column data is implicitly shared, i.e. it is copied only when the dataset is modified later on.
+	QSharedPointer<DataSet> snapshot() const;
+
+	///Changes collected during an update transaction.
+	struct ChangeSet
+	{
+		///Columns were added, removed or replaced, or the number of rows changed.
+		bool structure = false;
+		bool headers = false;
+		bool filters = false;
+		bool modification = false;
+		///Changed rows [start, end) per column index (only meaningful if the structure did not change).
+		QMap<int, QPair<int, int>> rows;
+
+		bool isEmpty() const
+		{
+			return !structure && !headers && !filters && !modification && rows.isEmpty();
+		}
+		///Adds changed rows of a column (ranges of the same column are merged).
+		void addRows(int column, int start, int end);
+	};
+
+	///Starts an update transaction: instead of emitting signals for each change, changes are collected until the matching endUpdate(). Transactions can be nested.
+	void beginUpdate();
+	///Ends an update transaction. When the outermost transaction ends, the collected changes are emitted with as few signals as possible.
+	void endUpdate();
+	///Returns if an update transaction is running.
+	bool updating() const
+	{
+		return update_depth_>0;
+	}
+
+	///RAII guard for update transactions.
+	class UpdateGuard
+	{
+	public:
+		UpdateGuard(DataSet& data)
+			: data_(data)
+		{
+			data_.beginUpdate();
+		}
+		~UpdateGuard()
+		{
+			data_.endUpdate();
+		}
+
+	private:
+		DataSet& data_;
+		UpdateGuard(const UpdateGuard&) = delete;
+		UpdateGuard& operator=(const UpdateGuard&) = delete;
+	};
+
+	///RAII scope of operations that need all values of virtual columns (see VirtualColumn::evaluated), e.g. sorting, grouping or plots.
+	///Evaluated values are kept until the outermost scope of the dataset ends, i.e. they are valid for the whole operation. Scopes can be nested.
+	class EvaluationScope
+	{
+	public:
+		EvaluationScope(const DataSet& data)
+			: data_(data)
+		{
+			data_.beginEvaluation();
+		}
+		~EvaluationScope()
+		{
+			data_.endEvaluation();
+		}
+
+	private:
+		const DataSet& data_;
+		EvaluationScope(const EvaluationScope&) = delete;
+		EvaluationScope& operator=(const EvaluationScope&) = delete;
+	};
+	///Returns if an evaluation scope is active.
+	bool evaluating() const;
+	///Keeps the evaluated values of a virtual column until the outermost evaluation scope ends. Throws a ProgrammingException if no scope is active.
+	void keepEvaluated(QSharedPointer<const BaseColumn> column) const;
 
 	bool filtersEnabled() const
 	{
@@ -121,6 +320,11 @@ public:
 	void setFiltersEnabled(bool enabled);
 	bool filtersPresent() const;
 	QBitArray getRowFilter(bool update = true) const;
+	///Re-evaluates the filters for the rows [start, end) only (e.g. after editing) and patches the cached row filter, which is returned.
+	QBitArray updateRowFilter(int start, int end) const;
+
+	///Returns the interval index of the given chromosome, start and end columns. The index is cached until the data changes.
+	const IntervalIndex& intervalIndex(int chr_col, int start_col, int end_col) const;
 
     void setComments(const QStringList& comments)
 	{
@@ -146,28 +350,94 @@ signals:
 	void headersChanged();
 	void dataChanged();
 	void columnChanged(int column, bool until_end);
+	///Emitted when values of the rows [start, end) of a column changed, but the number of rows did not.
+	void rowsChanged(int column, int start, int end);
 	void filtersChanged();
 	void modificationStatusChanged(bool status);
+	void storeProgress(int percent);
 
 protected slots:
 	void columnDataChanged();
+	void columnRowsChanged(int start, int end);
 	void headerDataChanged();
 	void filterDataChanged();
 
 protected:
 	QVector<BaseColumn*> columns_;
 	QStringList comments_;
+	QString subset_;
+	QSharedPointer<PagedFile> paged_file_;
+	int page_;
+	bool sample_;
 	bool modified_;
+	quint64 version_;
 	bool filters_enabled_;
 	mutable QBitArray filtered_rows_;
+	mutable QSharedPointer<IntervalIndex> interval_index_;
+	mutable QVector<const BaseColumn*> interval_index_columns_;
+	mutable QHash<QString, QVector<GenomicRegion>> bed_cache_;
+	int update_depth_;
+	int update_rows_; //row count when the outermost update transaction started
+	int update_columns_; //column count when the outermost update transaction started
+	ChangeSet changes_;
+	mutable QMutex evaluation_mutex_; //protects the evaluation scope (virtual columns may be evaluated in parallel)
+	mutable int evaluation_depth_;
+	mutable QList<QSharedPointer<const BaseColumn>> evaluated_columns_; //evaluated values of virtual columns kept by the evaluation scope
+	QVector<int> row_order_; //display order of rows (empty: original order)
+	QHash<QString, QVector<int>> sort_orders_; //cached sort orders by sort keys (cleared when the data changes)
 
-    void storePlain(QString filename, const QList<int>& widths);
-    void storeGzipped(QString filename, const QList<int>& widths);
-    void storeAsHtml(QString filename);
-    static void writeHtml(QTextStream& stream, int indent, QByteArray text, bool newline=false);
+	//emit the signals, or collect the changes if an update transaction is running
+	void emitDataChanged();
+	void emitHeadersChanged();
+	void emitFiltersChanged();
+	void emitColumnChanged(int column);
+	void emitRowsChanged(int column, int start, int end);
+	//starts/ends an evaluation scope. When the outermost scope ends, the evaluated values of virtual columns are released.
+	void beginEvaluation() const;
+	void endEvaluation() const;
+	//clears the display order if rows were added or removed
+	void checkRowOrder();
+	//materializes the virtual columns that use one of the given columns (before the columns are removed or replaced)
+	void materializeDependents(const QSet<int>& columns);
+
+	void matchRegionFilter(int chr_col, QBitArray& array) const;
 
-    void storeAsCsv(QString filename);
-    static QString escapeForCsv(QString s);
+	//streams over all chunks of the paged file: each chunk is loaded into a temporary dataset with the current filters. Returns the number of rows skipped because filters are not applicable.
+	int streamFile(std::function<void(const DataSet& chunk, const QBitArray& rows, const QVector<QByteArray>& lines)> func) const;
+
+	//loads a file in the binary columnar TSVB format: the header contains the same meta data as TSV files, followed by aligned blocks of raw column data. The file is memory-mapped.
+	//Numeric and date/time blocks are copied with one memcpy per block. String values are decoded from UTF-8 one by one, because string columns hold a QString per value.
+	QHash<int, ColumnInfo> loadBinary(QString filename, QString display_name);
+
+	//loads an Arrow IPC (Feather v2) file. Comments, filters and column widths are restored if the file was written by TSVview.
+	QHash<int, ColumnInfo> loadArrow(QString filename, QString display_name);
+
+	//loads TSV data line by line from a text stream. If @p columns is not empty, only the columns with these names are stored.
+	template<typename Stream>
+	QHash<int, ColumnInfo> loadLines(Stream& file, QString display_name, const QStringList& columns = QStringList());
+	//returns if a string column contains at least one non-empty value (columns of empty values are not converted to date/time)
+	bool hasValues(int c) const;
+
+    //number of rows that are formatted as one block when storing
+    static const int STORE_BLOCK_ROWS = 16384;
+    void storePlain(QString filename, const QList<int>& widths);
+    //returns comment lines, TSVview-specific header lines and the header line (UTF-8)
+    QByteArray headerLines(const QList<int>& widths) const;
+    //returns the content lines of the given rows (UTF-8)
+    QByteArray formatRows(int start, int end) const;
+    //formats all rows in blocks (in parallel) using the given function and passes the blocks on in order. Emits storeProgress.
+    void formatBlocks(std::function<QByteArray(int start, int end)> format, std::function<void(const QByteArray&)> write);
+    void storeGzipped(QString filename, const QList<int>& widths, int compression_level);
+    void storeBinary(QString filename, const QList<int>& widths, int compression_level);
+    //size of the output buffer when exporting
+    static const int STORE_BUFFER_SIZE = 4 * 1024 * 1024;
+    //exports the given rows and columns as HTML or CSV
+    void storeAsText(QString filename, ExportFormat format, const QBitArray& rows, const QVector<int>& cols);
+    //returns the given rows and columns formatted as HTML table rows or CSV lines (UTF-8)
+    QByteArray formatExportRows(int start, int end, ExportFormat format, const QBitArray& rows, const QVector<int>& cols) const;
+    //appends the UTF-8 text escaped for HTML or CSV
+    static void appendEscaped(QByteArray& output, const char* data, int size, ExportFormat format);
+    void storeAsArrow(QString filename, const QVector<int>& cols);
 
 
 
@@ -0,0 +1,362 @@
+#include "DateTimeColumn.h"
+#include "CustomExceptions.h"
+#include "RadixSort.h"
+#include <algorithm>
+
+namespace
+{
+	const qint64 MS_PER_DAY = 86400000;
+
+	//days since 1970-01-01 (proleptic Gregorian calendar), see http://howardhinnant.github.io/date_algorithms.html
+	qint64 daysFromCivil(int y, int m, int d)
+	{
+		y -= m<=2;
+		const qint64 era = (y>=0 ? y : y-399) / 400;
+		const int yoe = (int)(y - era * 400);
+		const int doy = (153 * (m + (m>2 ? -3 : 9)) + 2) / 5 + d - 1;
+		const int doe = yoe * 365 + yoe/4 - yoe/100 + doy;
+		return era * 146097 + doe - 719468;
+	}
+
+	void civilFromDays(qint64 z, int& y, int& m, int& d)
+	{
+		z += 719468;
+		const qint64 era = (z>=0 ? z : z-146096) / 146097;
+		const int doe = (int)(z - era * 146097);
+		const int yoe = (doe - doe/1460 + doe/36524 - doe/146096) / 365;
+		const int doy = doe - (365*yoe + yoe/4 - yoe/100);
+		const int mp = (5*doy + 2) / 153;
+		d = doy - (153*mp + 2)/5 + 1;
+		m = mp<10 ? mp+3 : mp-9;
+		y = (int)(yoe + era * 400 + (m<=2));
+	}
+
+	bool isLeapYear(int y)
+	{
+		return (y%4==0 && y%100!=0) || y%400==0;
+	}
+
+	int daysInMonth(int y, int m)
+	{
+		static const int days[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+		if (m==2 && isLeapYear(y)) return 29;
+		return days[m-1];
+	}
+
+	//parses a fixed number of digits
+	bool digits(const QChar* s, int count, int& output)
+	{
+		output = 0;
+		for (int i=0; i<count; ++i)
+		{
+			ushort c = s[i].unicode();
+			if (c<'0' || c>'9') return false;
+			output = output*10 + (c-'0');
+		}
+		return true;
+	}
+
+	void appendDigits(char*& p, int value, int count)
+	{
+		for (int i=count-1; i>=0; --i)
+		{
+			p[i] = '0' + value%10;
+			value /= 10;
+		}
+		p += count;
+	}
+}
+
+DateTimeColumn::DateTimeColumn()
+	: BaseColumn(DATETIME)
+	, values_()
+	, formats_()
+{
+}
+
+QVector<double> DateTimeColumn::valuesAsDouble() const
+{
+	QVector<double> output;
+	output.reserve(values_.count());
+	foreach(qint64 value, values_)
+	{
+		output << (value==MISSING ? std::numeric_limits<double>::quiet_NaN() : (double)value);
+	}
+	return output;
+}
+
+void DateTimeColumn::setString(int row, const QString& value)
+{
+	Q_ASSERT(row<values_.count());
+
+	qint64 ms;
+	char format;
+	if (!parse(value, ms, format)) THROW(Exception, "Cannot convert '" + value + "' to a date/time!");
+
+	values_[row] = ms;
+	formats_[row] = format;
+
+	emit rowsChanged(row, row+1);
+}
+
+void DateTimeColumn::appendString(const QString& value)
+{
+	qint64 ms;
+	char format;
+	if (!parse(value, ms, format)) THROW(Exception, "Cannot convert '" + value + "' to a date/time!");
+
+	values_ << ms;
+	formats_ << format;
+
+	emit dataChanged();
+}
+
+void DateTimeColumn::applyPermutation(const QVector<int>& order)
+{
+	permute(values_, order);
+	permute(formats_, order);
+
+	emit dataChanged();
+}
+
+void DateTimeColumn::gather(const QVector<int>& rows)
+{
+	gatherValues(values_, rows);
+	gatherValues(formats_, rows);
+
+	emit dataChanged();
+}
+
+QVector<int> DateTimeColumn::sortOrder(bool reverse) const
+{
+	QVector<quint64> keys(values_.count());
+	for (int i=0; i<values_.count(); ++i)
+	{
+		keys[i] = RadixSort::key(values_[i]);
+	}
+
+	return RadixSort::order(keys, reverse);
+}
+
+void DateTimeColumn::setFilter(Filter filter)
+{
+	if ( filter.type()!=Filter::NONE
+		 && filter.type()!=Filter::DATETIME_BEFORE
+		 && filter.type()!=Filter::DATETIME_AFTER
+		 && filter.type()!=Filter::DATETIME_BETWEEN
+		 )
+	{
+		THROW(FilterTypeException,"Cannot add a non-date/time filter to a date/time column!");
+	}
+
+	//check value
+	if (filter.type()==Filter::DATETIME_BETWEEN)
+	{
+		QStringList parts = filter.value().split('/');
+		if (parts.count()!=2) THROW(FilterTypeException, "Invalid date/time range '" + filter.value() + "'. Expected format is 'start/end'!");
+		filterValue(parts[0]);
+		filterValue(parts[1]);
+	}
+	else if (filter.type()!=Filter::NONE)
+	{
+		filterValue(filter.value());
+	}
+
+	filter_ = filter;
+
+	emit filterChanged();
+}
+
+void DateTimeColumn::matchFilter(QBitArray& array, int start, int end) const
+{
+	Filter::Type type = filter().type();
+	if (type == Filter::NONE)
+	{
+		return;
+	}
+
+	if (type == Filter::DATETIME_BEFORE)
+	{
+		qint64 value = filterValue(filter().value());
+		matchValues(values_, array, [value](qint64 v) { return v!=MISSING && v < value; }, start, end);
+	}
+	else if (type == Filter::DATETIME_AFTER)
+	{
+		qint64 value = filterValue(filter().value());
+		matchValues(values_, array, [value](qint64 v) { return v > value; }, start, end);
+	}
+	else if (type == Filter::DATETIME_BETWEEN)
+	{
+		QStringList parts = filter().value().split('/');
+		qint64 min = filterValue(parts[0]);
+		qint64 max = filterValue(parts[1]);
+		matchValues(values_, array, [min, max](qint64 v) { return v >= min && v <= max; }, start, end);
+	}
+	else
+	{
+		THROW(FilterTypeException,"Internal error: Unknown filter type!");
+	}
+}
+
+qint64 DateTimeColumn::filterValue(const QString& value)
+{
+	qint64 ms;
+	char format;
+	if (!parse(value.trimmed(), ms, format) || ms==MISSING) THROW(FilterTypeException, "Invalid date/time '" + value + "'. Expected ISO format, e.g. '2024-03-01' or '2024-03-01T12:00:00'!");
+	return ms;
+}
+
+bool DateTimeColumn::parse(const QString& value, qint64& ms, char& format)
+{
+	//missing value
+	const int n = value.length();
+	format = 0;
+	if (n==0)
+	{
+		ms = MISSING;
+		return true;
+	}
+
+	//date: YYYY-MM-DD
+	if (n<10) return false;
+	const QChar* s = value.constData();
+	int y, m, d;
+	if (!digits(s, 4, y) || s[4]!='-' || !digits(s+5, 2, m) || s[7]!='-' || !digits(s+8, 2, d)) return false;
+	if (m<1 || m>12 || d<1 || d>daysInMonth(y, m)) return false;
+
+	ms = daysFromCivil(y, m, d) * MS_PER_DAY;
+	if (n==10) return true;
+
+	//time: (T| )HH:MM[:SS]
+	if (n<16) return false;
+	if (s[10]==' ') format |= SPACE_SEPARATOR;
+	else if (s[10]!='T') return false;
+	int hh, mm, ss = 0;
+	if (!digits(s+11, 2, hh) || s[13]!=':' || !digits(s+14, 2, mm)) return false;
+	int pos = 16;
+	if (pos<n && s[pos]==':')
+	{
+		if (pos+3>n || !digits(s+17, 2, ss)) return false;
+		pos += 3;
+	}
+	else
+	{
+		format |= NO_SECONDS;
+	}
+	if (hh>23 || mm>59 || ss>59) return false;
+	ms += ((hh * 60 + mm) * 60 + ss) * 1000ll;
+	format |= HAS_TIME;
+
+	//fraction of seconds (truncated to milliseconds)
+	if (pos<n && s[pos]=='.' && !(format & NO_SECONDS))
+	{
+		++pos;
+		int fraction_digits = 0;
+		int fraction = 0;
+		while (pos<n && s[pos].isDigit())
+		{
+			if (fraction_digits<3) fraction = fraction*10 + (s[pos].unicode()-'0');
+			++fraction_digits;
+			++pos;
+		}
+		if (fraction_digits==0) return false;
+		fraction_digits = std::min(fraction_digits, 3);
+		for (int i=fraction_digits; i<3; ++i) fraction *= 10;
+		ms += fraction;
+		format |= (char)(fraction_digits << 3);
+	}
+
+	//time zone: Z or (+|-)HH[[:]MM], offsets are converted to UTC
+	if (pos<n && s[pos]=='Z')
+	{
+		format |= UTC_SUFFIX;
+		++pos;
+	}
+	else if (pos<n && (s[pos]=='+' || s[pos]=='-'))
+	{
+		const int sign = s[pos]=='+' ? 1 : -1;
+		int offset_h, offset_m = 0;
+		if (pos+3>n || !digits(s+pos+1, 2, offset_h)) return false;
+		pos += 3;
+		const bool colon = pos<n && s[pos]==':';
+		if (colon) ++pos;
+		if (pos<n || colon)
+		{
+			if (pos+2>n || !digits(s+pos, 2, offset_m)) return false;
+			pos += 2;
+		}
+		if (offset_h>23 || offset_m>59) return false;
+		ms -= sign * (offset_h * 60 + offset_m) * 60000ll;
+		format |= UTC_SUFFIX;
+	}
+
+	return pos==n;
+}
+
+QString DateTimeColumn::toString(qint64 ms, char format)
+{
+	char buffer[32];
+	int length = toString(ms, format, buffer);
+	return QString::fromLatin1(buffer, length);
+}
+
+void DateTimeColumn::appendUtf8(int start, int end, QByteArray& output, QVector<int>& ends) const
+{
+	char buffer[32];
+	for (int r=start; r<end; ++r)
+	{
+		output.append(buffer, toString(values_[r], formats_[r], buffer));
+		ends << output.size();
+	}
+}
+
+int DateTimeColumn::toString(qint64 ms, char format, char* buffer)
+{
+	if (ms==MISSING) return 0;
+
+	//split into days and milliseconds of day (floor division)
+	qint64 days = ms / MS_PER_DAY;
+	qint64 ms_of_day = ms % MS_PER_DAY;
+	if (ms_of_day<0)
+	{
+		ms_of_day += MS_PER_DAY;
+		--days;
+	}
+
+	int y, m, d;
+	civilFromDays(days, y, m, d);
+
+	char* p = buffer;
+	appendDigits(p, y, 4);
+	*p++ = '-';
+	appendDigits(p, m, 2);
+	*p++ = '-';
+	appendDigits(p, d, 2);
+
+	if (format & HAS_TIME)
+	{
+		int t = (int)ms_of_day;
+		*p++ = (format & SPACE_SEPARATOR) ? ' ' : 'T';
+		appendDigits(p, t/3600000, 2);
+		*p++ = ':';
+		appendDigits(p, (t/60000)%60, 2);
+		if (!(format & NO_SECONDS))
+		{
+			*p++ = ':';
+			appendDigits(p, (t/1000)%60, 2);
+		}
+
+		int fraction_digits = (format >> 3) & 0x03;
+		if (fraction_digits>0)
+		{
+			int fraction = t%1000;
+			for (int i=fraction_digits; i<3; ++i) fraction /= 10;
+			*p++ = '.';
+			appendDigits(p, fraction, fraction_digits);
+		}
+
+		if (format & UTC_SUFFIX) *p++ = 'Z';
+	}
+
+	return (int)(p-buffer);
+}
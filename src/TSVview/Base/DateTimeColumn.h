@@ -0,0 +1,124 @@
+#ifndef DATETIMECOLUMN_H
+#define DATETIMECOLUMN_H
+
+#include "BaseColumn.h"
+#include <QVector>
+#include <limits>
+
+/// Column of ISO 8601 dates/times (e.g. '2024-03-01' or '2024-03-01T12:30:00.250Z'). Values are stored as milliseconds since the epoch (UTC).
+/// The format of each value is stored as well, so values are written back exactly as they were read, with these exceptions:
+/// - time zone offsets (e.g. '+02:00') are converted to UTC, so the value is written back in UTC with 'Z' suffix.
+/// - fractions of seconds finer than milliseconds are truncated to milliseconds.
+/// Empty strings are missing values (see MISSING).
+class DateTimeColumn
+		: public BaseColumn
+{
+	Q_OBJECT
+
+public:
+	//format flags (bits 0-2 and 5) and number of fraction digits (bits 3-4)
+	static const char HAS_TIME = 0x01;
+	static const char SPACE_SEPARATOR = 0x02;
+	static const char UTC_SUFFIX = 0x04;
+	static const char NO_SECONDS = 0x20;
+
+	///Value of missing date/times (empty string). It is sorted before all other values and matches no filter.
+	static constexpr qint64 MISSING = std::numeric_limits<qint64>::min();
+
+	DateTimeColumn();
+
+	const QVector<qint64>& values() const
+	{
+		return values_;
+	}
+	void setValues(const QVector<qint64>& values, const QVector<char>& formats)
+	{
+		Q_ASSERT(values.count()==formats.count());
+		values_ = values;
+		formats_ = formats;
+		emit dataChanged();
+	}
+	qint64 value(int row) const
+	{
+		Q_ASSERT(row<values_.count());
+		return values_[row];
+	}
+	const QVector<char>& formats() const
+	{
+		return formats_;
+	}
+	char format(int row) const
+	{
+		Q_ASSERT(row<formats_.count());
+		return formats_[row];
+	}
+	///Returns the values as doubles (milliseconds since epoch, NaN for missing values), e.g. for plotting.
+	QVector<double> valuesAsDouble() const;
+
+	virtual void resize(int rows)
+	{
+		values_.resize(rows);
+		formats_.resize(rows);
+		emit dataChanged();
+	}
+	virtual void reserve(int rows)
+	{
+		values_.reserve(rows);
+		formats_.reserve(rows);
+	}
+	virtual void applyPermutation(const QVector<int>& order);
+	virtual void gather(const QVector<int>& rows);
+	virtual qsizetype count() const
+	{
+		return values_.count();
+	}
+	virtual qsizetype capacity() const
+	{
+		return values_.capacity();
+	}
+	virtual BaseColumn* clone() const
+	{
+		return new DateTimeColumn(*this);
+	}
+
+	// See base class
+	virtual QString string(int row) const
+	{
+		Q_ASSERT(row<values_.count());
+		return toString(values_[row], formats_[row]);
+	}
+	virtual void setString(int row, const QString& value);
+	void appendString(const QString& value);
+	virtual void appendUtf8(int start, int end, QByteArray& output, QVector<int>& ends) const;
+
+	virtual void setFilter(Filter filter);
+	using BaseColumn::matchFilter;
+	virtual void matchFilter(QBitArray& array, int start, int end) const;
+
+	///Returns the sort order of the rows (stable radix sort).
+	virtual QVector<int> sortOrder(bool reverse=false) const;
+
+	///Parses an ISO 8601 date/time: 'YYYY-MM-DD', optionally followed by the time '(T| )HH:MM[:SS[.f+]]' and the time zone 'Z' or '(+|-)HH[[:]MM]'.
+	///An empty string is parsed as MISSING. Returns @p false if the string is not a supported date/time.
+	static bool parse(const QString& value, qint64& ms, char& format);
+	///Returns if the string is a supported ISO 8601 date/time.
+	static bool isDateTime(const QString& value)
+	{
+		qint64 ms;
+		char format;
+		return parse(value, ms, format);
+	}
+	///Formats a date/time as ISO 8601 string (empty for missing values).
+	static QString toString(qint64 ms, char format);
+	///Formats a date/time as ISO 8601 string into @p buffer (at least 32 characters). Returns the number of characters written.
+	static int toString(qint64 ms, char format, char* buffer);
+
+protected:
+	QVector<qint64> values_;
+	QVector<char> formats_;
+
+	///Parses a filter value. Throws an exception if it is not a date/time.
+	static qint64 filterValue(const QString& value);
+};
+
+#endif // DATETIMECOLUMN_H
@@ -0,0 +1,866 @@
+#include "Expression.h"
+#include "Exceptions.h"
+#include <QtConcurrent>
+#include <QElapsedTimer>
+#include <QDebug>
+#include <algorithm>
+#include <limits>
+#include <vector>
+#include <cmath>
+#include <cstring>
+#include <charconv>
+
+Expression::Expression(QString formula, const DataSet& data)
+	: formula_(formula)
+	, nodes_()
+	, tokens_()
+	, token_(0)
+	, data_(&data)
+{
+	tokenize();
+	parseConditional();
+	if (token().type!=Token::END) THROW(ArgumentException, error("Unexpected '" + token().text + "'"));
+
+	//parser state is not needed anymore
+	tokens_.clear();
+	data_ = nullptr;
+}
+
+QList<int> Expression::columns() const
+{
+	QList<int> output;
+	foreach(const Node& node, nodes_)
+	{
+		if (node.op==COLUMN && !output.contains(node.column)) output << node.column;
+	}
+	return output;
+}
+
+void Expression::setColumns(const QList<int>& columns)
+{
+	QList<int> old_columns = this->columns();
+	Q_ASSERT(columns.count()==old_columns.count());
+
+	for (Node& node : nodes_)
+	{
+		if (node.op==COLUMN) node.column = columns[old_columns.indexOf(node.column)];
+	}
+}
+
+void Expression::tokenize()
+{
+	const QString& f = formula_;
+	int pos = 0;
+	while (pos<f.size())
+	{
+		const QChar c = f[pos];
+		if (c.isSpace())
+		{
+			++pos;
+			continue;
+		}
+
+		Token token = {Token::SYMBOL, QString(), 0.0, pos};
+		if (c.isDigit() || (c=='.' && pos+1<f.size() && f[pos+1].isDigit())) //number (with optional exponent)
+		{
+			int end = pos;
+			while (end<f.size() && (f[end].isDigit() || f[end]=='.')) ++end;
+			if (end<f.size() && (f[end]=='e' || f[end]=='E'))
+			{
+				int exp_end = end + 1;
+				if (exp_end<f.size() && (f[exp_end]=='+' || f[exp_end]=='-')) ++exp_end;
+				if (exp_end<f.size() && f[exp_end].isDigit())
+				{
+					while (exp_end<f.size() && f[exp_end].isDigit()) ++exp_end;
+					end = exp_end;
+				}
+			}
+			token.type = Token::NUMBER;
+			token.text = f.mid(pos, end-pos);
+			bool ok = false;
+			token.number = token.text.toDouble(&ok);
+			if (!ok) THROW(ArgumentException, "Invalid number '" + token.text + "' at position " + QString::number(pos+1) + " of formula '" + f + "'!");
+			pos = end;
+		}
+		else if (c.isLetter() || c=='_') //name of function or constant
+		{
+			int end = pos;
+			while (end<f.size() && (f[end].isLetterOrNumber() || f[end]=='_' || f[end]=='.')) ++end;
+			token.type = Token::NAME;
+			token.text = f.mid(pos, end-pos);
+			pos = end;
+		}
+		else if (c=='"' || c=='\'') //string (backslash escapes the next character)
+		{
+			int end = pos + 1;
+			while (end<f.size() && f[end]!=c)
+			{
+				if (f[end]=='\\') ++end;
+				if (end<f.size()) token.text.append(f[end]);
+				++end;
+			}
+			if (end>=f.size()) THROW(ArgumentException, "Missing closing quote for string at position " + QString::number(pos+1) + " of formula '" + f + "'!");
+			token.type = Token::STRING;
+			pos = end + 1;
+		}
+		else if (c=='[') //column
+		{
+			int end = f.indexOf(']', pos);
+			if (end==-1) THROW(ArgumentException, "Missing ']' for '[' at position " + QString::number(pos+1) + " of formula '" + f + "'!");
+			token.type = Token::COLUMN;
+			token.text = f.mid(pos+1, end-pos-1).trimmed();
+			pos = end + 1;
+		}
+		else //symbol (JavaScript '===' and '!==' are the same as '==' and '!=')
+		{
+			static const QStringList symbols = QStringList() << "===" << "!==" << "**" << "<=" << ">=" << "==" << "!=" << "&&" << "||" << "+" << "-" << "*" << "/" << "%" << "^" << "(" << ")" << "," << "?" << ":" << "<" << ">" << "!";
+			foreach(const QString& symbol, symbols)
+			{
+				if (f.mid(pos, symbol.size())==symbol)
+				{
+					token.text = symbol.size()==3 ? symbol.left(2) : symbol;
+					pos += symbol.size();
+					break;
+				}
+			}
+			if (token.text.isEmpty()) THROW(ArgumentException, "Unexpected character '" + QString(c) + "' at position " + QString::number(pos+1) + " of formula '" + f + "'!");
+		}
+		tokens_ << token;
+	}
+
+	tokens_ << Token{Token::END, "end of formula", 0.0, (int)f.size()};
+}
+
+bool Expression::accept(QString symbol)
+{
+	if (token().type!=Token::SYMBOL || token().text!=symbol) return false;
+	++token_;
+	return true;
+}
+
+void Expression::expect(QString symbol)
+{
+	if (!accept(symbol)) THROW(ArgumentException, error("Expected '" + symbol + "', but found '" + token().text + "'"));
+}
+
+QString Expression::error(QString message) const
+{
+	return message + " at position " + QString::number(token().pos+1) + " of formula '" + formula_ + "'!";
+}
+
+int Expression::addNode(Op op, bool string, QVector<int> args)
+{
+	Node node;
+	node.op = op;
+	node.string = string;
+	node.value = 0.0;
+	node.column = -1;
+	node.args = args;
+	nodes_ << node;
+	return nodes_.count() - 1;
+}
+
+int Expression::number(int node, QString context) const
+{
+	if (nodes_[node].string) THROW(ArgumentException, error("'" + context + "' expects a number, but got a string"));
+	return node;
+}
+
+int Expression::text(int node)
+{
+	if (nodes_[node].string) return node;
+	return addNode(TO_STRING, true, QVector<int>() << node);
+}
+
+int Expression::parseConditional()
+{
+	int condition = parseOr();
+	if (!accept("?")) return condition;
+	number(condition, "?");
+
+	int a = parseConditional();
+	expect(":");
+	int b = parseConditional();
+
+	//string result if one of the branches is a string
+	const bool string = nodes_[a].string || nodes_[b].string;
+	if (string)
+	{
+		a = text(a);
+		b = text(b);
+	}
+	return addNode(IF, string, QVector<int>() << condition << a << b);
+}
+
+int Expression::parseOr()
+{
+	int left = parseAnd();
+	while (accept("||"))
+	{
+		int right = parseAnd();
+		left = addNode(OR, false, QVector<int>() << number(left, "||") << number(right, "||"));
+	}
+	return left;
+}
+
+int Expression::parseAnd()
+{
+	int left = parseComparison();
+	while (accept("&&"))
+	{
+		int right = parseComparison();
+		left = addNode(AND, false, QVector<int>() << number(left, "&&") << number(right, "&&"));
+	}
+	return left;
+}
+
+int Expression::parseComparison()
+{
+	int left = parseAdditive();
+	while (true)
+	{
+		Op op;
+		if (accept("<")) op = LT;
+		else if (accept("<=")) op = LE;
+		else if (accept(">")) op = GT;
+		else if (accept(">=")) op = GE;
+		else if (accept("==")) op = EQ;
+		else if (accept("!=")) op = NE;
+		else return left;
+
+		//strings are compared if one of the operands is a string
+		int right = parseAdditive();
+		if (nodes_[left].string || nodes_[right].string)
+		{
+			left = text(left);
+			right = text(right);
+		}
+		left = addNode(op, false, QVector<int>() << left << right);
+	}
+}
+
+int Expression::parseAdditive()
+{
+	int left = parseMultiplicative();
+	while (true)
+	{
+		Op op;
+		if (accept("+")) op = ADD;
+		else if (accept("-")) op = SUB;
+		else return left;
+
+		int right = parseMultiplicative();
+		if (op==ADD && (nodes_[left].string || nodes_[right].string)) //concatenation
+		{
+			left = text(left);
+			right = text(right);
+			left = addNode(CONCAT, true, QVector<int>() << left << right);
+		}
+		else
+		{
+			left = addNode(op, false, QVector<int>() << number(left, op==ADD ? "+" : "-") << number(right, op==ADD ? "+" : "-"));
+		}
+	}
+}
+
+int Expression::parseMultiplicative()
+{
+	int left = parseUnary();
+	while (true)
+	{
+		QString symbol = token().text;
+		Op op;
+		if (accept("*")) op = MUL;
+		else if (accept("/")) op = DIV;
+		else if (accept("%")) op = MOD;
+		else return left;
+
+		int right = parseUnary();
+		left = addNode(op, false, QVector<int>() << number(left, symbol) << number(right, symbol));
+	}
+}
+
+int Expression::parseUnary()
+{
+	if (accept("-")) return addNode(NEG, false, QVector<int>() << number(parseUnary(), "-"));
+	if (accept("+")) return number(parseUnary(), "+");
+	if (accept("!")) return addNode(NOT, false, QVector<int>() << number(parseUnary(), "!"));
+	return parsePower();
+}
+
+int Expression::parsePower()
+{
+	//right-associative, binds stronger than unary minus on the left: -2^2 is -(2^2)
+	int base = parsePrimary();
+	if (accept("^") || accept("**"))
+	{
+		int exponent = parseUnary();
+		return addNode(POW, false, QVector<int>() << number(base, "^") << number(exponent, "^"));
+	}
+	return base;
+}
+
+int Expression::parsePrimary()
+{
+	const Token current = token();
+
+	if (current.type==Token::NUMBER)
+	{
+		++token_;
+		int node = addNode(CONSTANT, false, QVector<int>());
+		nodes_[node].value = current.number;
+		return node;
+	}
+
+	if (current.type==Token::STRING)
+	{
+		++token_;
+		int node = addNode(CONSTANT, true, QVector<int>());
+		nodes_[node].text = current.text;
+		return node;
+	}
+
+	if (current.type==Token::COLUMN)
+	{
+		//column by index or by header name
+		bool ok = false;
+		int index = current.text.toInt(&ok);
+		if (ok)
+		{
+			if (index<0 || index>=data_->columnCount()) THROW(ArgumentException, error("Column index '[" + current.text + "]' is out of bounds"));
+		}
+		else
+		{
+			index = data_->indexOf(current.text);
+			if (index==-1) THROW(ArgumentException, error("Unknown column '[" + current.text + "]'"));
+		}
+		++token_;
+		int node = addNode(COLUMN, data_->column(index).type()==BaseColumn::STRING, QVector<int>());
+		nodes_[node].column = index;
+		return node;
+	}
+
+	if (current.type==Token::NAME)
+	{
+		++token_;
+		QString name = current.text;
+		if (name.startsWith("Math.")) name = name.mid(5);
+		if (accept("(")) return parseFunction(name);
+
+		double value;
+		if (name=="NaN" || name=="nan") value = std::numeric_limits<double>::quiet_NaN();
+		else if (name=="PI" || name=="pi") value = std::acos(-1.0);
+		else if (name=="E") value = std::exp(1.0);
+		else if (name=="true") value = 1.0;
+		else if (name=="false") value = 0.0;
+		else THROW(ArgumentException, "Unknown name '" + current.text + "' at position " + QString::number(current.pos+1) + " of formula '" + formula_ + "'!");
+		int node = addNode(CONSTANT, false, QVector<int>());
+		nodes_[node].value = value;
+		return node;
+	}
+
+	if (accept("("))
+	{
+		int node = parseConditional();
+		expect(")");
+		return node;
+	}
+
+	THROW(ArgumentException, error("Unexpected '" + current.text + "'"));
+}
+
+int Expression::parseFunction(QString name)
+{
+	//function table: operation, argument types and result type.
+	//Argument types are 'n' for numbers, 's' for strings (numbers are converted) and 'a' for both (checked by the function). Upper-case arguments are optional, '+' repeats the last argument type.
+	struct Function
+	{
+		const char* name;
+		Op op;
+		const char* args;
+		bool string;
+	};
+	static const Function functions[] = {
+		{"min", MIN, "n+", false}, {"max", MAX, "n+", false}, {"abs", ABS, "n", false}, {"sqrt", SQRT, "n", false}, {"log", LOG, "n", false},
+		{"log2", LOG2, "n", false}, {"log10", LOG10, "n", false}, {"exp", EXP, "n", false}, {"pow", POW, "nn", false}, {"round", ROUND, "n", false},
+		{"floor", FLOOR, "n", false}, {"ceil", CEIL, "n", false}, {"if", IF, "naa", false},
+		{"concat", CONCAT, "s+", true}, {"str", TO_STRING, "s", true}, {"substr", SUBSTR, "snN", true}, {"split", SPLIT, "ssn", true},
+		{"regex", REGEX, "ssN", true}, {"upper", UPPER, "s", true}, {"lower", LOWER, "s", true}, {"trim", TRIM, "s", true},
+		{"length", LENGTH, "s", false}, {"number", TO_NUMBER, "s", false}, {"contains", CONTAINS, "ss", false}
+	};
+	const Function* function = nullptr;
+	for (const Function& f : functions)
+	{
+		if (name==f.name) function = &f;
+	}
+	if (function==nullptr) THROW(ArgumentException, error("Unknown function '" + name + "'"));
+
+	//arguments
+	QVector<int> args;
+	if (!accept(")"))
+	{
+		do
+		{
+			args << parseConditional();
+		}
+		while (accept(","));
+		expect(")");
+	}
+
+	//check argument count and types
+	const QString types = function->args;
+	const bool repeat = types.endsWith('+');
+	const int max_args = repeat ? std::numeric_limits<int>::max() : types.size();
+	int min_args = 0;
+	for (int i=0; i<types.size(); ++i)
+	{
+		if (types[i].isLower()) min_args = i + 1;
+	}
+	if (args.count()<min_args || args.count()>max_args)
+	{
+		QString expected = repeat ? "at least " + QString::number(min_args) : (min_args==max_args ? QString::number(min_args) : QString::number(min_args) + "-" + QString::number(max_args));
+		THROW(ArgumentException, "Function '" + name + "' expects " + expected + " argument(s), but got " + QString::number(args.count()) + " in formula '" + formula_ + "'!");
+	}
+	for (int i=0; i<args.count(); ++i)
+	{
+		const QChar type = types[repeat ? std::min(i, (int)types.size()-2) : i].toLower();
+		if (type=='s') args[i] = text(args[i]);
+		else if (type=='n') args[i] = number(args[i], name);
+	}
+
+	//functions with special handling
+	if (function->op==TO_STRING) return args[0];
+	if (function->op==IF && (nodes_[args[1]].string || nodes_[args[2]].string))
+	{
+		args[1] = text(args[1]);
+		args[2] = text(args[2]);
+		return addNode(IF, true, args);
+	}
+	if (function->op==SUBSTR && args.count()==2) //to the end of the string
+	{
+		args << addNode(CONSTANT, false, QVector<int>());
+		nodes_[args[2]].value = std::numeric_limits<double>::quiet_NaN();
+	}
+	if (function->op==REGEX)
+	{
+		if (args.count()==2) args << addNode(CONSTANT, false, QVector<int>()); //whole match
+		const Node& pattern = nodes_[args[1]];
+		if (pattern.op!=CONSTANT) THROW(ArgumentException, "The pattern of function 'regex' has to be a string constant in formula '" + formula_ + "'!");
+		QRegularExpression regex(pattern.text);
+		if (!regex.isValid()) THROW(ArgumentException, "Invalid regular expression '" + pattern.text + "' in formula '" + formula_ + "': " + regex.errorString());
+		regex.optimize();
+		int node = addNode(REGEX, true, args);
+		nodes_[node].regex = regex;
+		return node;
+	}
+
+	return addNode(function->op, function->string, args);
+}
+
+struct Expression::Buffers
+{
+	Buffers(int nodes)
+		: numbers((size_t)nodes * BLOCK_ROWS)
+		, views((size_t)nodes * BLOCK_ROWS)
+		, chars(nodes)
+		, values(nodes)
+	{
+	}
+
+	std::vector<double> numbers; //numeric results of node i: [i*BLOCK_ROWS, (i+1)*BLOCK_ROWS)
+	std::vector<QStringView> views; //string results of node i (views into column data, constants or character buffers)
+	QVector<QString> chars; //character buffer of each string node that creates new strings
+	QVector<const double*> values; //numeric results of each node (may point to column data)
+	std::vector<qsizetype> ends; //end of each row in a character buffer
+	QByteArray utf8; //string representation of a numeric column
+	QVector<int> utf8_ends;
+};
+
+namespace
+{
+	//Returns the start/length of a substring, clamped to the string (JavaScript substr semantics: a negative start counts from the end, NaN length means to the end).
+	inline QStringView substring(QStringView s, double start, double length)
+	{
+		if (std::isnan(start) || start>=s.size()) return QStringView();
+		qsizetype pos = (qsizetype)std::max(start, -(double)s.size());
+		if (pos<0) pos = std::max((qsizetype)0, s.size() + pos);
+		if (pos>=s.size()) return QStringView();
+		qsizetype count = std::isnan(length) ? s.size() - pos : (qsizetype)std::min(std::max(length, 0.0), (double)(s.size() - pos));
+		return s.sliced(pos, count);
+	}
+
+	//Returns the part @p index of @p s split at @p separator, or an empty view if there is no such part.
+	inline QStringView splitPart(QStringView s, QStringView separator, double index)
+	{
+		if (std::isnan(index) || index<0 || separator.isEmpty()) return index==0 ? s : QStringView();
+		qsizetype start = 0;
+		for (qint64 i=0; i<(qint64)index; ++i)
+		{
+			qsizetype pos = s.indexOf(separator, start);
+			if (pos==-1) return QStringView();
+			start = pos + separator.size();
+		}
+		qsizetype end = s.indexOf(separator, start);
+		return s.sliced(start, (end==-1 ? s.size() : end) - start);
+	}
+}
+
+void Expression::evaluateBlock(const DataSet& data, int start, int n, Buffers& buffers) const
+{
+	const double nan = std::numeric_limits<double>::quiet_NaN();
+
+	//evaluate nodes in order (children are evaluated before their parent)
+	for (int i=0; i<nodes_.count(); ++i)
+	{
+		const Node& node = nodes_[i];
+		double* o = buffers.numbers.data() + (size_t)i * BLOCK_ROWS;
+		QStringView* v = buffers.views.data() + (size_t)i * BLOCK_ROWS;
+		buffers.values[i] = o;
+		auto number = [&](int arg)
+		{
+			return buffers.values[node.args[arg]];
+		};
+		auto string = [&](int arg)
+		{
+			return buffers.views.data() + (size_t)node.args[arg] * BLOCK_ROWS;
+		};
+
+		//plain loops over the buffers of the arguments, which the compiler can vectorize
+		auto unary = [&](auto f)
+		{
+			const double* a = number(0);
+			for (int r=0; r<n; ++r) o[r] = f(a[r]);
+		};
+		auto binary = [&](auto f)
+		{
+			const double* a = number(0);
+			const double* b = number(1);
+			for (int r=0; r<n; ++r) o[r] = f(a[r], b[r]);
+		};
+		//comparisons and logical operations are NaN if an operand is NaN. Strings are compared if the operands are strings.
+		auto predicate = [&](auto f)
+		{
+			if (nodes_[node.args[0]].string)
+			{
+				const QStringView* a = string(0);
+				const QStringView* b = string(1);
+				for (int r=0; r<n; ++r) o[r] = f(a[r].compare(b[r]), 0) ? 1.0 : 0.0;
+			}
+			else
+			{
+				binary([&](double a, double b) { return (a!=a || b!=b) ? nan : (f(a, b) ? 1.0 : 0.0); });
+			}
+		};
+		//creates new strings: each row is appended to the character buffer of the node, the views are created when the buffer is complete
+		auto build = [&](auto f)
+		{
+			QString& chars = buffers.chars[i];
+			chars.truncate(0);
+			buffers.ends.clear();
+			for (int r=0; r<n; ++r)
+			{
+				f(r, chars);
+				buffers.ends.push_back(chars.size());
+			}
+			const QChar* base = chars.constData();
+			qsizetype begin = 0;
+			for (int r=0; r<n; ++r)
+			{
+				v[r] = QStringView(base + begin, buffers.ends[r] - begin);
+				begin = buffers.ends[r];
+			}
+		};
+
+		switch(node.op)
+		{
+			case CONSTANT:
+				if (node.string) std::fill(v, v + n, QStringView(node.text));
+				else std::fill(o, o + n, node.value);
+				break;
+			case COLUMN:
+				if (node.string)
+				{
+					const QString* s = data.stringColumn(node.column).values().constData() + start;
+					for (int r=0; r<n; ++r) v[r] = QStringView(s[r]);
+				}
+				else if (data.column(node.column).type()==BaseColumn::NUMERIC)
+				{
+					buffers.values[i] = data.numericColumn(node.column).values().constData() + start;
+				}
+				else
+				{
+					const qint64* d = data.dateTimeColumn(node.column).values().constData() + start;
+					for (int r=0; r<n; ++r) o[r] = d[r]==DateTimeColumn::MISSING ? nan : (double)d[r];
+				}
+				break;
+			case NEG: unary([](double a) { return -a; }); break;
+			case NOT: unary([nan](double a) { return a!=a ? nan : (a==0.0 ? 1.0 : 0.0); }); break;
+			case ADD: binary([](double a, double b) { return a + b; }); break;
+			case SUB: binary([](double a, double b) { return a - b; }); break;
+			case MUL: binary([](double a, double b) { return a * b; }); break;
+			case DIV: binary([](double a, double b) { return a / b; }); break;
+			case MOD: binary([](double a, double b) { return std::fmod(a, b); }); break;
+			case POW: binary([](double a, double b) { return std::pow(a, b); }); break;
+			case LT: predicate([](auto a, auto b) { return a<b; }); break;
+			case LE: predicate([](auto a, auto b) { return a<=b; }); break;
+			case GT: predicate([](auto a, auto b) { return a>b; }); break;
+			case GE: predicate([](auto a, auto b) { return a>=b; }); break;
+			case EQ: predicate([](auto a, auto b) { return a==b; }); break;
+			case NE: predicate([](auto a, auto b) { return a!=b; }); break;
+			case AND: predicate([](double a, double b) { return a!=0.0 && b!=0.0; }); break;
+			case OR: predicate([](double a, double b) { return a!=0.0 || b!=0.0; }); break;
+			case IF:
+			{
+				const double* c = number(0);
+				if (node.string) //a NaN condition gives an empty string
+				{
+					const QStringView* a = string(1);
+					const QStringView* b = string(2);
+					for (int r=0; r<n; ++r) v[r] = c[r]!=c[r] ? QStringView() : (c[r]!=0.0 ? a[r] : b[r]);
+				}
+				else
+				{
+					const double* a = number(1);
+					const double* b = number(2);
+					for (int r=0; r<n; ++r) o[r] = c[r]!=c[r] ? nan : (c[r]!=0.0 ? a[r] : b[r]);
+				}
+				break;
+			}
+			case MIN:
+			case MAX:
+			{
+				const bool is_min = node.op==MIN;
+				std::memcpy(o, number(0), n * sizeof(double));
+				for (int k=1; k<node.args.count(); ++k)
+				{
+					const double* a = number(k);
+					for (int r=0; r<n; ++r) o[r] = (o[r]!=o[r] || a[r]!=a[r]) ? nan : (is_min ? std::min(o[r], a[r]) : std::max(o[r], a[r]));
+				}
+				break;
+			}
+			case ABS: unary([](double a) { return std::fabs(a); }); break;
+			case SQRT: unary([](double a) { return std::sqrt(a); }); break;
+			case LOG: unary([](double a) { return std::log(a); }); break;
+			case LOG2: unary([](double a) { return std::log2(a); }); break;
+			case LOG10: unary([](double a) { return std::log10(a); }); break;
+			case EXP: unary([](double a) { return std::exp(a); }); break;
+			case ROUND: unary([](double a) { return std::round(a); }); break;
+			case FLOOR: unary([](double a) { return std::floor(a); }); break;
+			case CEIL: unary([](double a) { return std::ceil(a); }); break;
+			case TO_STRING:
+			{
+				const Node& arg = nodes_[node.args[0]];
+				if (arg.op==COLUMN) //string representation of the column (ASCII for numbers and date/times)
+				{
+					buffers.utf8.truncate(0);
+					buffers.utf8_ends.resize(0);
+					data.column(arg.column).appendUtf8(start, start + n, buffers.utf8, buffers.utf8_ends);
+					const char* utf8 = buffers.utf8.constData();
+					const int* ends = buffers.utf8_ends.constData();
+					build([&](int r, QString& chars)
+					{
+						const int begin = r==0 ? 0 : ends[r-1];
+						chars.append(QLatin1String(utf8 + begin, ends[r] - begin));
+					});
+				}
+				else
+				{
+					const double* a = number(0);
+					build([&](int r, QString& chars)
+					{
+						//locale-independent, same as printf '%.15g'
+						if (std::isnan(a[r]))
+						{
+							chars.append(QLatin1String("nan"));
+							return;
+						}
+						char text[32];
+						std::to_chars_result result = std::to_chars(text, text + sizeof(text), a[r], std::chars_format::general, 15);
+						chars.append(QLatin1String(text, result.ptr - text));
+					});
+				}
+				break;
+			}
+			case CONCAT:
+				build([&](int r, QString& chars)
+				{
+					for (int k=0; k<node.args.count(); ++k)
+					{
+						chars.append(string(k)[r]);
+					}
+				});
+				break;
+			case SUBSTR:
+			{
+				const QStringView* a = string(0);
+				const double* b = number(1);
+				const double* c = number(2);
+				for (int r=0; r<n; ++r) v[r] = substring(a[r], b[r], c[r]);
+				break;
+			}
+			case SPLIT:
+			{
+				const QStringView* a = string(0);
+				const QStringView* b = string(1);
+				const double* c = number(2);
+				for (int r=0; r<n; ++r) v[r] = splitPart(a[r], b[r], c[r]);
+				break;
+			}
+			case REGEX: //first match (or the given capture group), empty if there is no match
+			{
+				const QStringView* a = string(0);
+				const double* g = number(2);
+				for (int r=0; r<n; ++r)
+				{
+#if QT_VERSION >= QT_VERSION_CHECK(6, 5, 0)
+					QRegularExpressionMatch match = node.regex.matchView(a[r]);
+#else
+					QRegularExpressionMatch match = node.regex.match(a[r]);
+#endif
+					v[r] = (match.hasMatch() && !std::isnan(g[r])) ? match.capturedView((int)g[r]) : QStringView();
+				}
+				break;
+			}
+			case UPPER:
+			case LOWER:
+			{
+				const QStringView* a = string(0);
+				const bool upper = node.op==UPPER;
+				build([&](int r, QString& chars)
+				{
+					for (QChar c : a[r])
+					{
+						chars.append(upper ? c.toUpper() : c.toLower());
+					}
+				});
+				break;
+			}
+			case TRIM:
+			{
+				const QStringView* a = string(0);
+				for (int r=0; r<n; ++r) v[r] = a[r].trimmed();
+				break;
+			}
+			case LENGTH:
+			{
+				const QStringView* a = string(0);
+				for (int r=0; r<n; ++r) o[r] = a[r].size();
+				break;
+			}
+			case TO_NUMBER:
+			{
+				const QStringView* a = string(0);
+				for (int r=0; r<n; ++r)
+				{
+					bool ok = false;
+					o[r] = a[r].toDouble(&ok);
+					if (!ok) o[r] = nan;
+				}
+				break;
+			}
+			case CONTAINS:
+			{
+				const QStringView* a = string(0);
+				const QStringView* b = string(1);
+				for (int r=0; r<n; ++r) o[r] = a[r].contains(b[r]) ? 1.0 : 0.0;
+				break;
+			}
+		}
+	}
+}
+
+template<typename Output>
+void Expression::evaluateBlocks(const DataSet& data, int start, int end, Output output) const
+{
+	//buffers are allocated once and re-used for all blocks
+	Buffers buffers(nodes_.count());
+	for (int block=start; block<end; block+=BLOCK_ROWS)
+	{
+		const int n = std::min(BLOCK_ROWS, end-block);
+		evaluateBlock(data, block, n, buffers);
+		output(block-start, n, buffers);
+	}
+}
+
+void Expression::evaluate(const DataSet& data, int start, int end, double* output) const
+{
+	Q_ASSERT(!isString());
+
+	//the last node is the root
+	const int root = nodes_.count() - 1;
+	evaluateBlocks(data, start, end, [&](int offset, int n, const Buffers& buffers)
+	{
+		std::memcpy(output + offset, buffers.values[root], n * sizeof(double));
+	});
+}
+
+void Expression::evaluate(const DataSet& data, int start, int end, QString* output) const
+{
+	Q_ASSERT(isString());
+
+	//the last node is the root. Only the final strings are allocated.
+	const int root = nodes_.count() - 1;
+	evaluateBlocks(data, start, end, [&](int offset, int n, const Buffers& buffers)
+	{
+		const QStringView* v = buffers.views.data() + (size_t)root * BLOCK_ROWS;
+		for (int r=0; r<n; ++r)
+		{
+			output[offset + r] = v[r].toString();
+		}
+	});
+}
+
+namespace
+{
+	//Applies a function to chunks of rows [start, end) in parallel.
+	template<typename Func>
+	void forChunks(int rows, int chunk_rows, Func func)
+	{
+		QList<int> starts;
+		for (int start=0; start<rows; start+=chunk_rows)
+		{
+			starts << start;
+		}
+		QtConcurrent::blockingMap(starts, [&](int start)
+		{
+			func(start, std::min(start + chunk_rows, rows));
+		});
+	}
+}
+
+QVector<double> Expression::evaluate(const DataSet& data) const
+{
+	QElapsedTimer timer;
+	timer.start();
+
+	//chunks of several blocks are evaluated in parallel (buffers are allocated once per chunk)
+	const int n = data.rowCount();
+	QVector<double> output(n);
+	double* o = output.data();
+	forChunks(n, 16*BLOCK_ROWS, [&](int start, int end)
+	{
+		evaluate(data, start, end, o + start);
+	});
+
+	qDebug() << "evaluating formula: nodes=" << nodes_.count() << "r=" << n << "ms=" << timer.elapsed();
+
+	return output;
+}
+
+QVector<QString> Expression::evaluateStrings(const DataSet& data) const
+{
+	QElapsedTimer timer;
+	timer.start();
+
+	const int n = data.rowCount();
+	QVector<QString> output(n);
+	QString* o = output.data();
+	forChunks(n, 16*BLOCK_ROWS, [&](int start, int end)
+	{
+		evaluate(data, start, end, o + start);
+	});
+
+	qDebug() << "evaluating string formula: nodes=" << nodes_.count() << "r=" << n << "ms=" << timer.elapsed();
+
+	return output;
+}
@@ -0,0 +1,135 @@
+#ifndef EXPRESSION_H
+#define EXPRESSION_H
+
+#include "DataSet.h"
+#include <QString>
+#include <QStringView>
+#include <QVector>
+#include <QList>
+#include <QRegularExpression>
+
+/// Formula over the columns of a dataset, e.g. 'log([0]) + max([len], [2]) / 2' or 'concat([chr], ":", [pos])'.
+/// The formula is parsed once into an expression tree, which is stored as a node list in evaluation order (children before their parent). Each node has a static type (number or string).
+/// It is evaluated column-at-a-time: each node computes a block of rows into a plain buffer, which lets the compiler vectorize the numeric loops. Blocks of rows are evaluated in parallel.
+/// String values are views (spans) into the column data or into one character buffer per node and block, i.e. intermediate strings are not allocated per row.
+///
+/// Syntax: numbers, strings ("text" or 'text'), columns by index ([0]) or header name ([name]), operators + - * / % ^ (or **), comparisons < <= > >= == !=, logical && || !, 'cond ? a : b' and the functions
+/// min, max, abs, sqrt, log, log2, log10, exp, pow, round, floor, ceil and if(cond, a, b). The prefix 'Math.' is ignored for compatibility with JavaScript formulas.
+/// String functions: concat(a, ...), str(x), substr(s, start[, length]), split(s, separator, index), regex(s, pattern[, group]), upper(s), lower(s), trim(s), length(s), number(s) and contains(s, text).
+/// '+' concatenates if an operand is a string. Indices are 0-based. Date/time columns are numbers (milliseconds since epoch), but their string representation is used when converted to strings.
+///
+/// NaN semantics: NaN values propagate through all numeric operators and functions (including comparisons and conditions), i.e. missing values stay missing.
+class Expression
+{
+public:
+	///Parses a formula. Throws an ArgumentException if the formula is invalid or references invalid columns.
+	Expression(QString formula, const DataSet& data);
+
+	///Returns the formula.
+	const QString& formula() const
+	{
+		return formula_;
+	}
+	///Returns the columns used in the formula.
+	QList<int> columns() const;
+	///Changes the indices of the columns used in the formula, e.g. after columns were inserted or removed. @p columns contains the new index of each column returned by columns() (same order).
+	void setColumns(const QList<int>& columns);
+	///Returns if the result is a string (otherwise it is a number).
+	bool isString() const
+	{
+		return nodes_.last().string;
+	}
+
+	///Evaluates the numeric formula for all rows (blocks of rows in parallel).
+	QVector<double> evaluate(const DataSet& data) const;
+	///Evaluates the string formula for all rows (blocks of rows in parallel).
+	QVector<QString> evaluateStrings(const DataSet& data) const;
+	///Evaluates the numeric formula for the rows [start, end) and writes the results to @p output.
+	void evaluate(const DataSet& data, int start, int end, double* output) const;
+	///Evaluates the string formula for the rows [start, end) and writes the results to @p output.
+	void evaluate(const DataSet& data, int start, int end, QString* output) const;
+
+	///Number of rows evaluated at once.
+	static const int BLOCK_ROWS = 4096;
+
+protected:
+	//operations of expression nodes
+	enum Op
+	{
+		CONSTANT, COLUMN,
+		NEG, NOT, ADD, SUB, MUL, DIV, MOD, POW,
+		LT, LE, GT, GE, EQ, NE, AND, OR, IF,
+		MIN, MAX, ABS, SQRT, LOG, LOG2, LOG10, EXP, ROUND, FLOOR, CEIL,
+		TO_STRING, CONCAT, SUBSTR, SPLIT, REGEX, UPPER, LOWER, TRIM, LENGTH, TO_NUMBER, CONTAINS
+	};
+	//expression node
+	struct Node
+	{
+		Op op;
+		bool string; //result type
+		double value; //numeric CONSTANT
+		QString text; //string CONSTANT
+		int column; //COLUMN
+		QVector<int> args; //child nodes
+		QRegularExpression regex; //REGEX
+	};
+	//token of the formula
+	struct Token
+	{
+		enum Type {NUMBER, STRING, NAME, COLUMN, SYMBOL, END};
+		Type type;
+		QString text;
+		double number;
+		int pos;
+	};
+	//buffers of all nodes for one block of rows
+	struct Buffers;
+
+	QString formula_;
+	QVector<Node> nodes_;
+
+	//parser state
+	QVector<Token> tokens_;
+	int token_;
+	const DataSet* data_;
+
+	//splits the formula into tokens
+	void tokenize();
+	//returns the current token
+	const Token& token() const
+	{
+		return tokens_[token_];
+	}
+	//consumes the current token if it is the symbol @p symbol
+	bool accept(QString symbol);
+	//consumes the symbol @p symbol or throws an exception
+	void expect(QString symbol);
+	//returns an error message with the position of the current token
+	QString error(QString message) const;
+	//appends a node and returns its index
+	int addNode(Op op, bool string, QVector<int> args);
+	//checks that a node is numeric
+	int number(int node, QString context) const;
+	//converts a node to a string node if it is numeric
+	int text(int node);
+
+	//recursive descent parser (by operator precedence). Each function returns the index of the node it added.
+	int parseConditional();
+	int parseOr();
+	int parseAnd();
+	int parseComparison();
+	int parseAdditive();
+	int parseMultiplicative();
+	int parseUnary();
+	int parsePower();
+	int parsePrimary();
+	int parseFunction(QString name);
+
+	//evaluates all nodes for the rows [start, start+n)
+	void evaluateBlock(const DataSet& data, int start, int n, Buffers& buffers) const;
+	//evaluates the rows [start, end) in blocks and passes the root buffers of each block to @p output
+	template<typename Output>
+	void evaluateBlocks(const DataSet& data, int start, int end, Output output) const;
+};
+
+#endif // EXPRESSION_H
@@ -65,6 +65,14 @@ QString Filter::typeToString(Filter::Type type, bool human_readable)
 				return "<";
 			case Filter::FLOAT_LESS_EQUAL:
 				return "<=";
+			case Filter::DATETIME_BEFORE:
+				return "before";
+			case Filter::DATETIME_AFTER:
+				return "after";
+			case Filter::DATETIME_BETWEEN:
+				return "between";
+			case Filter::REGION_OVERLAPS:
+				return "overlaps BED file";
 		}
 	}
 	else
@@ -97,6 +105,14 @@ QString Filter::typeToString(Filter::Type type, bool human_readable)
 				return "FLOAT_LESS";
 			case Filter::FLOAT_LESS_EQUAL:
 				return "FLOAT_LESS_EQUAL";
+			case Filter::DATETIME_BEFORE:
+				return "DATETIME_BEFORE";
+			case Filter::DATETIME_AFTER:
+				return "DATETIME_AFTER";
+			case Filter::DATETIME_BETWEEN:
+				return "DATETIME_BETWEEN";
+			case Filter::REGION_OVERLAPS:
+				return "REGION_OVERLAPS";
 		}
 	}
 
@@ -105,7 +121,7 @@ QString Filter::typeToString(Filter::Type type, bool human_readable)
 
 Filter::Type Filter::stringToType(QString string, bool human_readable)
 {
-	for(int i=0; i<13; ++i)
+	for(int i=0; i<=REGION_OVERLAPS; ++i)
 	{
 		Type type = (Type)i;
 		if(typeToString(type, human_readable)==string)
@@ -142,3 +158,20 @@ Filter Filter::fromString(QString line, int& col)
 		return Filter();
 	}
 }
+
+QString Filter::regionValue(QString start_col, QString end_col, QString bed_file)
+{
+	return start_col + "|" + end_col + "|" + bed_file;
+}
+
+bool Filter::parseRegionValue(QString value, QString& start_col, QString& end_col, QString& bed_file)
+{
+	QStringList parts = value.split('|');
+	if (parts.count()<3) return false;
+
+	start_col = parts[0];
+	end_col = parts[1];
+	bed_file = parts.mid(2).join('|');
+
+	return true;
+}
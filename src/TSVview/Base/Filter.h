@@ -20,7 +20,11 @@ public:
 		STRING_CONTAINS,
 		STRING_CONTAINS_NOT,
 		STRING_REGEXP,
-		STRING_REGEXP_NOT
+		STRING_REGEXP_NOT,
+		DATETIME_BEFORE,
+		DATETIME_AFTER,
+		DATETIME_BETWEEN,
+		REGION_OVERLAPS
 	};
 
 	Filter();
@@ -43,6 +47,11 @@ public:
 	//Parses a serialized filter. Returns a invalid filter object if not parsable or in outdated format.
 	static Filter fromString(QString line, int& col);
 
+	//Returns the filter value of a REGION_OVERLAPS filter, which consists of start column, end column and BED file.
+	static QString regionValue(QString start_col, QString end_col, QString bed_file);
+	//Parses the filter value of a REGION_OVERLAPS filter. Returns false if the value is invalid.
+	static bool parseRegionValue(QString value, QString& start_col, QString& end_col, QString& bed_file);
+
 protected:
 	QString value_;
 	Type type_;
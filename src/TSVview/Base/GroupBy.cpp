@@ -0,0 +1,340 @@
+#include "GroupBy.h"
+#include "RadixSort.h"
+#include "Exceptions.h"
+#include <QElapsedTimer>
+#include <QDebug>
+#include <QtConcurrent>
+#include <algorithm>
+#include <limits>
+#include <vector>
+#include <cmath>
+
+QStringList GroupBy::functionNames()
+{
+	return QStringList() << "count" << "sum" << "mean" << "min" << "max" << "stdev" << "median" << "distinct";
+}
+
+namespace
+{
+	//Sorts the values of each group by group index: the values of group g are in [offsets[g], offsets[g+1]).
+	template<typename T, typename Value>
+	void bucketByGroup(const QVector<int>& groups, int group_count, Value value, QVector<int>& offsets, std::vector<T>& output)
+	{
+		offsets.fill(0, group_count+1);
+		for (int r=0; r<groups.count(); ++r)
+		{
+			if (groups[r]!=-1) ++offsets[groups[r]+1];
+		}
+		for (int g=0; g<group_count; ++g)
+		{
+			offsets[g+1] += offsets[g];
+		}
+
+		output.resize(offsets[group_count]);
+		QVector<int> next = offsets;
+		for (int r=0; r<groups.count(); ++r)
+		{
+			if (groups[r]!=-1) output[next[groups[r]]++] = value(r);
+		}
+	}
+
+	//Applies a function to the value range of each group in parallel chunks of groups.
+	template<typename Func>
+	void forGroups(int group_count, Func func)
+	{
+		QList<QPair<int, int>> chunks;
+		for (int start=0; start<group_count; start+=4096)
+		{
+			chunks << qMakePair(start, std::min(start+4096, group_count));
+		}
+		QtConcurrent::blockingMap(chunks, [&func](const QPair<int, int>& chunk)
+		{
+			for (int g=chunk.first; g<chunk.second; ++g)
+			{
+				func(g);
+			}
+		});
+	}
+
+	//Counts the distinct values of each group.
+	template<typename T, typename Value>
+	QVector<double> distinctCounts(const QVector<int>& groups, int group_count, Value value)
+	{
+		QVector<int> offsets;
+		std::vector<T> values;
+		bucketByGroup(groups, group_count, value, offsets, values);
+
+		QVector<double> output(group_count, 0.0);
+		double* o = output.data();
+		forGroups(group_count, [&](int g)
+		{
+			auto start = values.begin() + offsets[g];
+			auto end = values.begin() + offsets[g+1];
+			std::sort(start, end);
+			o[g] = std::unique(start, end) - start;
+		});
+		return output;
+	}
+}
+
+QVector<double> GroupBy::aggregate(const DataSet& data, const Aggregation& aggregation, const QVector<int>& groups, int group_count)
+{
+	const BaseColumn& column = data.column(aggregation.column).evaluated();
+	const int* g = groups.constData();
+	const int n = groups.count();
+	const double nan = std::numeric_limits<double>::quiet_NaN();
+
+	if (aggregation.function==COUNT)
+	{
+		QVector<double> output(group_count, 0.0);
+		for (int r=0; r<n; ++r)
+		{
+			if (g[r]!=-1) ++output[g[r]];
+		}
+		return output;
+	}
+
+	if (aggregation.function==DISTINCT)
+	{
+		if (column.type()==BaseColumn::NUMERIC)
+		{
+			//NaN values have the same key and are thus counted once
+			const double* v = static_cast<const NumericColumn&>(column).values().constData();
+			return distinctCounts<quint64>(groups, group_count, [v](int r) { return std::isnan(v[r]) ? std::numeric_limits<quint64>::max() : RadixSort::key(v[r]); });
+		}
+		else if (column.type()==BaseColumn::DATETIME)
+		{
+			const qint64* v = static_cast<const DateTimeColumn&>(column).values().constData();
+			return distinctCounts<qint64>(groups, group_count, [v](int r) { return v[r]; });
+		}
+		const QString* v = static_cast<const StringColumn&>(column).values().constData();
+		return distinctCounts<QString>(groups, group_count, [v](int r) { return v[r]; });
+	}
+
+	Q_ASSERT(column.type()==BaseColumn::NUMERIC);
+	const double* v = static_cast<const NumericColumn&>(column).values().constData();
+
+	if (aggregation.function==MEDIAN)
+	{
+		//values without NaN, grouped
+		QVector<int> value_groups = groups;
+		for (int r=0; r<n; ++r)
+		{
+			if (std::isnan(v[r])) value_groups[r] = -1;
+		}
+		QVector<int> offsets;
+		std::vector<double> values;
+		bucketByGroup(value_groups, group_count, [v](int r) { return v[r]; }, offsets, values);
+
+		QVector<double> output(group_count, nan);
+		double* o = output.data();
+		forGroups(group_count, [&](int g)
+		{
+			const int size = offsets[g+1] - offsets[g];
+			if (size==0) return;
+			auto start = values.begin() + offsets[g];
+			auto mid = start + size/2;
+			std::nth_element(start, mid, start + size);
+			o[g] = *mid;
+			if (size%2==0) o[g] = (o[g] + *std::max_element(start, mid)) / 2.0;
+		});
+		return output;
+	}
+
+	if (aggregation.function==MIN || aggregation.function==MAX)
+	{
+		const bool is_min = aggregation.function==MIN;
+		QVector<double> output(group_count, nan);
+		double* o = output.data();
+		for (int r=0; r<n; ++r)
+		{
+			if (g[r]==-1 || std::isnan(v[r])) continue;
+			double& current = o[g[r]];
+			if (std::isnan(current) || (is_min ? v[r]<current : v[r]>current)) current = v[r];
+		}
+		return output;
+	}
+
+	//sum, mean and standard deviation (Welford's algorithm)
+	QVector<double> counts(group_count, 0.0);
+	QVector<double> sums(group_count, 0.0);
+	QVector<double> means(group_count, 0.0);
+	QVector<double> m2s(group_count, 0.0);
+	for (int r=0; r<n; ++r)
+	{
+		if (g[r]==-1 || std::isnan(v[r])) continue;
+		const int group = g[r];
+		counts[group] += 1.0;
+		sums[group] += v[r];
+		const double delta = v[r] - means[group];
+		means[group] += delta / counts[group];
+		m2s[group] += delta * (v[r] - means[group]);
+	}
+
+	QVector<double> output(group_count, nan);
+	for (int group=0; group<group_count; ++group)
+	{
+		if (aggregation.function==SUM) output[group] = sums[group];
+		else if (counts[group]==0) continue;
+		else if (aggregation.function==MEAN) output[group] = means[group];
+		else if (counts[group]>1) output[group] = std::sqrt(m2s[group] / (counts[group] - 1.0));
+	}
+	return output;
+}
+
+void GroupBy::run(const DataSet& data, const QList<int>& keys, int pivot_column, const QList<Aggregation>& aggregations, const QBitArray& rows, DataSet& output)
+{
+	QElapsedTimer timer;
+	timer.start();
+
+	//check parameters (virtual columns are evaluated here, i.e. not in the parallel aggregation)
+	DataSet::EvaluationScope scope(data);
+	const QStringList names = functionNames();
+	foreach(const Aggregation& aggregation, aggregations)
+	{
+		const BaseColumn& column = data.column(aggregation.column).evaluated();
+		if (isNumeric(aggregation.function) && column.type()!=BaseColumn::NUMERIC)
+		{
+			THROW(ArgumentException, "Aggregation '" + names[aggregation.function] + "' is not applicable to the non-numeric column '" + column.headerOrIndex(aggregation.column) + "'!");
+		}
+	}
+	if (keys.contains(pivot_column)) THROW(ArgumentException, "The pivot column must not be a key column!");
+
+	//groups by key columns (ordered by their first row)
+	const int n = data.rowCount();
+	QVector<int> counts;
+	QVector<int> first = data.firstRowsOfKeys(keys, counts, rows);
+	QVector<int> group_rows;
+	QVector<int> groups(n, -1);
+	for (int r=0; r<n; ++r)
+	{
+		if (first[r]==-1) continue;
+		if (first[r]==r)
+		{
+			groups[r] = group_rows.count();
+			group_rows << r;
+		}
+		else
+		{
+			groups[r] = groups[first[r]];
+		}
+	}
+
+	//pivot values: each combination of group and pivot value is a cell
+	QVector<int> pivot_rows;
+	QVector<int> cells = groups;
+	if (pivot_column!=-1)
+	{
+		QVector<int> pivot_counts;
+		QVector<int> pivot_first = data.firstRowsOfKeys(QList<int>() << pivot_column, pivot_counts, rows);
+		QVector<int> pivots(n, -1);
+		for (int r=0; r<n; ++r)
+		{
+			if (pivot_first[r]==-1) continue;
+			if (pivot_first[r]==r)
+			{
+				pivots[r] = pivot_rows.count();
+				pivot_rows << r;
+				if (pivot_rows.count()>MAX_PIVOT_VALUES) THROW(ArgumentException, "The pivot column has more than " + QString::number(MAX_PIVOT_VALUES) + " distinct values!");
+			}
+			else
+			{
+				pivots[r] = pivots[pivot_first[r]];
+			}
+		}
+		if ((qint64)group_rows.count() * pivot_rows.count() > std::numeric_limits<int>::max()) THROW(ArgumentException, "Too many groups for a pivot table!");
+
+		for (int r=0; r<n; ++r)
+		{
+			if (cells[r]!=-1) cells[r] = cells[r] * pivot_rows.count() + pivots[r];
+		}
+	}
+	const int pivot_count = pivot_column==-1 ? 1 : pivot_rows.count();
+	const int cell_count = group_rows.count() * pivot_count;
+	qDebug() << "group by: groups=" << group_rows.count() << "pivot values=" << pivot_rows.count() << "ms=" << timer.restart();
+
+	//aggregate (in parallel)
+	QVector<QVector<double>> results(aggregations.count());
+	QList<int> indices;
+	for (int i=0; i<aggregations.count(); ++i)
+	{
+		indices << i;
+	}
+	QtConcurrent::blockingMap(indices, [&](int i)
+	{
+		results[i] = aggregate(data, aggregations[i], cells, cell_count);
+	});
+	qDebug() << "group by: aggregations=" << aggregations.count() << "ms=" << timer.restart();
+
+	//create output (key columns, then aggregations)
+	DataSet::UpdateGuard update(output);
+	output.clear(true);
+	const int group_count = group_rows.count();
+	foreach(int key, keys)
+	{
+		const BaseColumn& column = data.column(key);
+		if (column.type()==BaseColumn::NUMERIC)
+		{
+			const NumericColumn& col = data.numericColumn(key);
+			QVector<double> values(group_count);
+			QVector<char> decimals(group_count);
+			for (int i=0; i<group_count; ++i)
+			{
+				values[i] = col.value(group_rows[i]);
+				decimals[i] = col.decimals(group_rows[i]);
+			}
+			output.addColumn(column.header(), values, decimals);
+		}
+		else if (column.type()==BaseColumn::DATETIME)
+		{
+			const DateTimeColumn& col = data.dateTimeColumn(key);
+			QVector<qint64> values(group_count);
+			QVector<char> formats(group_count);
+			for (int i=0; i<group_count; ++i)
+			{
+				values[i] = col.value(group_rows[i]);
+				formats[i] = col.format(group_rows[i]);
+			}
+			output.addColumn(column.header(), values, formats);
+		}
+		else
+		{
+			const StringColumn& col = data.stringColumn(key);
+			QVector<QString> values(group_count);
+			for (int i=0; i<group_count; ++i)
+			{
+				values[i] = col.value(group_rows[i]);
+			}
+			output.addColumn(column.header(), values);
+		}
+	}
+	for (int i=0; i<aggregations.count(); ++i)
+	{
+		const Aggregation& aggregation = aggregations[i];
+		const BaseColumn& column = data.column(aggregation.column);
+		QString header = names[aggregation.function] + "(" + column.headerOrIndex(aggregation.column) + ")";
+
+		//decimals: counts are integers, other values have the decimals of the column (plus two for statistics)
+		char decimals = 0;
+		if (isNumeric(aggregation.function))
+		{
+			const QVector<char>& column_decimals = data.numericColumn(aggregation.column).decimals();
+			if (!column_decimals.isEmpty()) decimals = std::max((char)0, *std::max_element(column_decimals.cbegin(), column_decimals.cend()));
+			if (aggregation.function==MEAN || aggregation.function==STDEV || aggregation.function==MEDIAN) decimals += 2;
+		}
+
+		for (int p=0; p<pivot_count; ++p)
+		{
+			QVector<double> values(group_count);
+			for (int group=0; group<group_count; ++group)
+			{
+				values[group] = results[i][group * pivot_count + p];
+			}
+			QString pivot_header = pivot_column==-1 ? header : header + " " + data.column(pivot_column).string(pivot_rows[p]);
+			output.addColumn(pivot_header, values, QVector<char>(group_count, decimals));
+		}
+	}
+	output.setModified(true);
+
+	qDebug() << "group by: output c=" << output.columnCount() << "r=" << output.rowCount() << "ms=" << timer.elapsed();
+}
@@ -0,0 +1,53 @@
+#ifndef GROUPBY_H
+#define GROUPBY_H
+
+#include "DataSet.h"
+#include <QStringList>
+
+/// Group-by of a dataset with aggregations of columns (pivot tables).
+/// Rows are grouped with the hash kernel of DataSet::firstRowsOfKeys, which partitions the rows by key hash across threads and groups each partition with a local hash table.
+/// Groups of different partitions are disjoint, so merging the partitions is a concatenation. The aggregations are then computed in parallel.
+class GroupBy
+{
+public:
+	///Aggregation functions.
+	enum Function
+	{
+		COUNT,
+		SUM,
+		MEAN,
+		MIN,
+		MAX,
+		STDEV,
+		MEDIAN,
+		DISTINCT
+	};
+	///Returns the names of the aggregation functions (in the order of the enum).
+	static QStringList functionNames();
+	///Returns if the function needs numeric values. Count and distinct count are applicable to all column types.
+	static bool isNumeric(Function function)
+	{
+		return function!=COUNT && function!=DISTINCT;
+	}
+
+	///Aggregation of a column.
+	struct Aggregation
+	{
+		int column;
+		Function function;
+	};
+
+	///Groups the rows set in @p rows (all if empty) by the key columns and fills @p output with one row per group, in the order of the first row of each group: key columns followed by one column per aggregation.
+	///If @p pivot_column is not -1, its distinct values are output as columns, i.e. there is one column per aggregation and pivot value.
+	///NaN values are ignored by all aggregations except count. Throws an exception if an aggregation is not applicable to a column or if there are too many pivot values.
+	static void run(const DataSet& data, const QList<int>& keys, int pivot_column, const QList<Aggregation>& aggregations, const QBitArray& rows, DataSet& output);
+
+	///Maximum number of distinct values of the pivot column.
+	static const int MAX_PIVOT_VALUES = 200;
+
+protected:
+	//aggregates the values of each group. @p groups contains the group of each row (-1 if the row is not aggregated).
+	static QVector<double> aggregate(const DataSet& data, const Aggregation& aggregation, const QVector<int>& groups, int group_count);
+};
+
+#endif // GROUPBY_H
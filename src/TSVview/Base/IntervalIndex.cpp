@@ -0,0 +1,244 @@
+#include "IntervalIndex.h"
+#include "DataSet.h"
+#include "Exceptions.h"
+#include "VersatileTextStream.h"
+#include "BasicStatistics.h"
+#include <numeric>
+#include <algorithm>
+#include <limits>
+
+IntervalIndex::IntervalIndex(const DataSet& data, int chr_col, int start_col, int end_col)
+	: chrs_()
+{
+	const BaseColumn& chr_column = data.column(chr_col);
+	const QVector<double>& starts = data.numericColumn(start_col).values();
+	const QVector<double>& ends = data.numericColumn(end_col).values();
+
+	//group rows by chromosome
+	QHash<QString, QVector<int>> chr_rows;
+	QString last_chr;
+	QVector<int>* last_rows = nullptr;
+	for (int r=0; r<data.rowCount(); ++r)
+	{
+		if (!BasicStatistics::isValidFloat(starts[r]) || !BasicStatistics::isValidFloat(ends[r]) || ends[r]<starts[r]) continue;
+
+		QString chr = chr_column.string(r);
+		if (last_rows==nullptr || chr!=last_chr)
+		{
+			last_chr = chr;
+			last_rows = &chr_rows[normalizeChromosome(chr)];
+		}
+		last_rows->append(r);
+	}
+
+	//create sorted arrays per chromosome
+	for (auto it=chr_rows.begin(); it!=chr_rows.end(); ++it)
+	{
+		QVector<int>& rows = it.value();
+		std::stable_sort(rows.begin(), rows.end(), [&starts](int a, int b) { return starts[a] < starts[b]; });
+
+		Chromosome& chr = chrs_[it.key()];
+		chr.rows = rows;
+		chr.starts.reserve(rows.count());
+		chr.ends.reserve(rows.count());
+		foreach(int r, rows)
+		{
+			chr.starts << (qint64)starts[r];
+			chr.ends << (qint64)ends[r] + 1;
+		}
+		index(chr);
+	}
+}
+
+void IntervalIndex::index(Chromosome& chr)
+{
+	const qint64 n = chr.starts.count();
+	chr.max_ends = chr.ends;
+	chr.max_level = -1;
+	if (n==0) return;
+
+	//level 0 (leafs)
+	qint64 last_i = 0;
+	qint64 last = 0;
+	for (qint64 i=0; i<n; i+=2)
+	{
+		last_i = i;
+		last = chr.max_ends[i] = chr.ends[i];
+	}
+
+	//higher levels
+	int k = 1;
+	for (; (1ll<<k)<=n; ++k)
+	{
+		qint64 x = 1ll<<(k-1);
+		qint64 i0 = (x<<1) - 1;
+		qint64 step = x<<2;
+		for (qint64 i=i0; i<n; i+=step)
+		{
+			qint64 el = chr.max_ends[i-x];
+			qint64 er = i+x<n ? chr.max_ends[i+x] : last;
+			qint64 e = chr.ends[i];
+			if (el>e) e = el;
+			if (er>e) e = er;
+			chr.max_ends[i] = e;
+		}
+		last_i = ((last_i>>k)&1) ? last_i-x : last_i+x;
+		if (last_i<n && chr.max_ends[last_i]>last) last = chr.max_ends[last_i];
+	}
+	chr.max_level = k-1;
+}
+
+template<typename Func>
+void IntervalIndex::query(const Chromosome& chr, qint64 start, qint64 end, Func func)
+{
+	if (chr.max_level<0) return;
+
+	struct Node
+	{
+		qint64 x;
+		int k;
+		bool w;
+	};
+	Node stack[64];
+	int t = 0;
+	const qint64 n = chr.starts.count();
+	const qint64* starts = chr.starts.constData();
+	const qint64* ends = chr.ends.constData();
+	const qint64* max_ends = chr.max_ends.constData();
+
+	stack[t++] = Node{(1ll<<chr.max_level) - 1, chr.max_level, false};
+	while (t>0)
+	{
+		Node z = stack[--t];
+		if (z.k<=3) //small subtree: linear scan
+		{
+			qint64 i0 = z.x >> z.k << z.k;
+			qint64 i1 = i0 + (1ll<<(z.k+1)) - 1;
+			if (i1>=n) i1 = n;
+			for (qint64 i=i0; i<i1 && starts[i]<end; ++i)
+			{
+				if (start<ends[i]) func(chr.rows[i]);
+			}
+		}
+		else if (!z.w) //left child not processed yet
+		{
+			qint64 y = z.x - (1ll<<(z.k-1));
+			stack[t++] = Node{z.x, z.k, true};
+			if (y>=n || max_ends[y]>start) stack[t++] = Node{y, z.k-1, false};
+		}
+		else if (z.x<n && starts[z.x]<end) //current node and right child
+		{
+			if (start<ends[z.x]) func(chr.rows[z.x]);
+			stack[t++] = Node{z.x + (1ll<<(z.k-1)), z.k-1, false};
+		}
+	}
+}
+
+void IntervalIndex::overlapping(const GenomicRegion& region, QBitArray& rows) const
+{
+	auto it = chrs_.constFind(normalizeChromosome(region.chr));
+	if (it==chrs_.constEnd()) return;
+
+	query(it.value(), region.start, region.end+1, [&rows](int row) { rows.setBit(row); });
+}
+
+int IntervalIndex::firstOverlapping(const GenomicRegion& region) const
+{
+	auto it = chrs_.constFind(normalizeChromosome(region.chr));
+	if (it==chrs_.constEnd()) return -1;
+
+	int first = -1;
+	query(it.value(), region.start, region.end+1, [&first](int row) { if (first==-1 || row<first) first = row; });
+	return first;
+}
+
+QString IntervalIndex::normalizeChromosome(const QString& chr)
+{
+	if (chr.startsWith("chr", Qt::CaseInsensitive)) return chr.mid(3);
+	return chr;
+}
+
+GenomicRegion IntervalIndex::parseRegion(QString text)
+{
+	text = text.trimmed();
+	text.remove(',');
+
+	GenomicRegion region;
+	int sep = text.lastIndexOf(':');
+	if (sep==-1)
+	{
+		if (text.isEmpty()) THROW(ArgumentException, "Empty region given!");
+		region.chr = text;
+		region.start = 1;
+		region.end = std::numeric_limits<qint64>::max() - 1;
+		return region;
+	}
+
+	region.chr = text.left(sep);
+	QStringList parts = text.mid(sep+1).split('-');
+	bool ok_start = true;
+	bool ok_end = true;
+	region.start = parts[0].toLongLong(&ok_start);
+	region.end = parts.count()==2 ? parts[1].toLongLong(&ok_end) : region.start;
+	if (region.chr.isEmpty() || parts.count()>2 || !ok_start || !ok_end || region.end<region.start)
+	{
+		THROW(ArgumentException, "Invalid region '" + text + "'. Expected format is 'chr:start-end'!");
+	}
+
+	return region;
+}
+
+QVector<GenomicRegion> IntervalIndex::loadBed(QString filename)
+{
+	QVector<GenomicRegion> output;
+
+	VersatileTextStream file(filename);
+	int line_nr = 0;
+	while (!file.atEnd())
+	{
+		QString line = file.readLine(true);
+		++line_nr;
+
+		//skip empty lines, comments and UCSC headers
+		if (line.isEmpty() || line.startsWith('#') || line.startsWith("track") || line.startsWith("browser")) continue;
+
+		QStringList parts = line.split('\t');
+		if (parts.count()<3) THROW(FileParseException, "BED file line " + QString::number(line_nr) + " has less than three columns: " + line);
+
+		//convert from 0-based half-open to 1-based closed coordinates
+		GenomicRegion region;
+		region.chr = parts[0];
+		region.start = Helper::toInt(parts[1], "BED start position", line) + 1;
+		region.end = Helper::toInt(parts[2], "BED end position", line);
+		output << region;
+	}
+
+	return output;
+}
+
+bool IntervalIndex::guessColumns(const DataSet& data, int& chr_col, int& start_col, int& end_col)
+{
+	chr_col = -1;
+	start_col = -1;
+	end_col = -1;
+	for (int c=0; c<data.columnCount(); ++c)
+	{
+		QString header = data.column(c).header().toLower();
+		if (header.startsWith('#')) header = header.mid(1);
+
+		if (chr_col==-1 && (header=="chr" || header=="chrom" || header=="chromosome"))
+		{
+			chr_col = c;
+		}
+		else if (data.column(c).type()==BaseColumn::NUMERIC)
+		{
+			if (start_col==-1 && (header=="start" || header=="pos" || header=="position" || header=="begin" || header=="chromstart")) start_col = c;
+			else if (end_col==-1 && (header=="end" || header=="stop" || header=="chromend")) end_col = c;
+		}
+	}
+
+	//single position (e.g. VCF-like tables)
+	if (end_col==-1) end_col = start_col;
+
+	return chr_col!=-1 && start_col!=-1;
+}
@@ -0,0 +1,59 @@
+#ifndef INTERVALINDEX_H
+#define INTERVALINDEX_H
+
+#include <QString>
+#include <QHash>
+#include <QVector>
+#include <QBitArray>
+
+class DataSet;
+
+/// Genomic region (1-based, closed coordinates).
+struct GenomicRegion
+{
+	QString chr;
+	qint64 start;
+	qint64 end;
+};
+
+/// Index for fast overlap queries of genomic intervals stored in three columns (chromosome, start, end) of a dataset.
+/// The intervals of each chromosome are sorted by start position and augmented with the maximum end position of each subtree (implicit interval tree, see cgranges).
+/// A query costs O(log(n) + k), where k is the number of overlapping rows.
+class IntervalIndex
+{
+public:
+	///Builds the index. Coordinates in the dataset are 1-based and closed. Rows with invalid coordinates are skipped.
+	IntervalIndex(const DataSet& data, int chr_col, int start_col, int end_col);
+
+	///Sets the bits of all rows that overlap the given region.
+	void overlapping(const GenomicRegion& region, QBitArray& rows) const;
+	///Returns the lowest row index that overlaps the given region, or -1 if no row overlaps.
+	int firstOverlapping(const GenomicRegion& region) const;
+
+	///Returns the chromosome name without 'chr' prefix, so that 'chr1' and '1' are treated the same.
+	static QString normalizeChromosome(const QString& chr);
+	///Parses a region string in the format 'chr:start-end', 'chr:pos' or 'chr'. Throws an exception if the format is invalid.
+	static GenomicRegion parseRegion(QString text);
+	///Loads the regions of a BED file (converted to 1-based closed coordinates).
+	static QVector<GenomicRegion> loadBed(QString filename);
+	///Guesses the chromosome, start and end columns from the column headers. Returns @p false if no matching columns were found.
+	static bool guessColumns(const DataSet& data, int& chr_col, int& start_col, int& end_col);
+
+private:
+	//intervals of one chromosome in half-open coordinates, sorted by start
+	struct Chromosome
+	{
+		QVector<qint64> starts;
+		QVector<qint64> ends;
+		QVector<qint64> max_ends;
+		QVector<int> rows;
+		int max_level;
+	};
+	QHash<QString, Chromosome> chrs_;
+
+	static void index(Chromosome& chr);
+	template<typename Func>
+	static void query(const Chromosome& chr, qint64 start, qint64 end, Func func);
+};
+
+#endif // INTERVALINDEX_H
@@ -0,0 +1,263 @@
+#include "Join.h"
+#include "RowKeys.h"
+#include "Exceptions.h"
+#include <QElapsedTimer>
+#include <QDebug>
+#include <QtConcurrent>
+#include <limits>
+#include <cmath>
+
+QStringList Join::typeNames()
+{
+	return QStringList() << "inner join" << "left join" << "anti join";
+}
+
+int Join::groups(const DataSet& data, const QList<int>& keys, const DataSet& other, const QList<int>& other_keys, QVector<int>& data_groups, QVector<int>& other_groups)
+{
+	//key columns of different types are compared as strings
+	QSet<int> as_strings;
+	for (int k=0; k<keys.count(); ++k)
+	{
+		if (data.column(keys[k]).type()!=other.column(other_keys[k]).type()) as_strings << k;
+	}
+	RowKeys data_row_keys(data, keys, as_strings);
+	RowKeys other_row_keys(other, other_keys, as_strings);
+
+	//build the hash table over the smaller side, probe with the larger side
+	const bool build_other = other.rowCount()<=data.rowCount();
+	const RowKeys& build_keys = build_other ? other_row_keys : data_row_keys;
+	const RowKeys& probe_keys = build_other ? data_row_keys : other_row_keys;
+	QVector<int>& build_groups = build_other ? other_groups : data_groups;
+	QVector<int>& probe_groups = build_other ? data_groups : other_groups;
+
+	//hash table of distinct build keys (linear probing): slots contain the first row of the key, or -1
+	const int build_count = build_keys.count();
+	const QVector<quint64> build_hashes = build_keys.hashes();
+	int size = 16;
+	while (size < 2 * build_count) size *= 2;
+	const quint64 mask = size - 1;
+	QVector<int> table(size, -1);
+	build_groups.fill(-1, build_count);
+	int group_count = 0;
+	for (int r=0; r<build_count; ++r)
+	{
+		quint64 slot = build_hashes[r] & mask;
+		while (true)
+		{
+			const int rep = table[slot];
+			if (rep==-1)
+			{
+				table[slot] = r;
+				build_groups[r] = group_count++;
+				break;
+			}
+			if (build_hashes[rep]==build_hashes[r] && build_keys.equal(rep, r))
+			{
+				build_groups[r] = build_groups[rep];
+				break;
+			}
+			slot = (slot + 1) & mask;
+		}
+	}
+
+	//probe in parallel blocks (the table is only read)
+	const int probe_count = probe_keys.count();
+	const QVector<quint64> probe_hashes = probe_keys.hashes();
+	probe_groups.fill(-1, probe_count);
+	const int* t = table.constData();
+	const int* b = build_groups.constData();
+	const quint64* bh = build_hashes.constData();
+	const quint64* ph = probe_hashes.constData();
+	int* p = probe_groups.data();
+	QList<QPair<int, int>> blocks;
+	for (int start=0; start<probe_count; start+=65536)
+	{
+		blocks << qMakePair(start, std::min(start+65536, probe_count));
+	}
+	QtConcurrent::blockingMap(blocks, [&](const QPair<int, int>& block)
+	{
+		for (int r=block.first; r<block.second; ++r)
+		{
+			quint64 slot = ph[r] & mask;
+			while (t[slot]!=-1)
+			{
+				const int rep = t[slot];
+				if (bh[rep]==ph[r] && probe_keys.equal(r, build_keys, rep))
+				{
+					p[r] = b[rep];
+					break;
+				}
+				slot = (slot + 1) & mask;
+			}
+		}
+	});
+
+	return group_count;
+}
+
+void Join::run(DataSet& data, const QList<int>& keys, const DataSet& other, const QList<int>& other_keys, const QList<int>& columns, Type type)
+{
+	QElapsedTimer timer;
+	timer.start();
+
+	//check parameters
+	if (keys.isEmpty() || keys.count()!=other_keys.count()) THROW(ArgumentException, "The same number of key columns has to be given for both datasets!");
+	foreach(int c, keys)
+	{
+		if (c<0 || c>=data.columnCount()) THROW(ArgumentException, "Invalid key column index " + QString::number(c) + "!");
+	}
+	foreach(int c, other_keys + columns)
+	{
+		if (c<0 || c>=other.columnCount()) THROW(ArgumentException, "Invalid column index " + QString::number(c) + " of the other dataset!");
+	}
+
+	//key groups of all rows (key and joined columns may be virtual)
+	DataSet::EvaluationScope data_scope(data);
+	DataSet::EvaluationScope other_scope(other);
+	QVector<int> data_groups;
+	QVector<int> other_groups;
+	const int group_count = groups(data, keys, other, other_keys, data_groups, other_groups);
+	qDebug() << "join: hashing/probing groups=" << group_count << "ms=" << timer.restart();
+
+	//rows of the other dataset by group (in row order within a group)
+	QVector<int> offsets(group_count+1, 0);
+	for (int r=0; r<other_groups.count(); ++r)
+	{
+		if (other_groups[r]!=-1) ++offsets[other_groups[r]+1];
+	}
+	for (int g=0; g<group_count; ++g)
+	{
+		offsets[g+1] += offsets[g];
+	}
+	QVector<int> other_rows_by_group(offsets[group_count]);
+	QVector<int> next = offsets;
+	for (int r=0; r<other_groups.count(); ++r)
+	{
+		if (other_groups[r]!=-1) other_rows_by_group[next[other_groups[r]]++] = r;
+	}
+
+	//output rows in display order: row of the dataset and matching row of the other dataset (-1 if there is no match)
+	const QVector<int> order = data.rowOrder();
+	const int n = data.rowCount();
+	auto matches = [&](int row)
+	{
+		const int g = data_groups[row];
+		return g==-1 ? 0 : offsets[g+1] - offsets[g];
+	};
+	qint64 output_count = 0;
+	for (int r=0; r<n; ++r)
+	{
+		const int count = matches(r);
+		if (type==INNER) output_count += count;
+		else if (type==LEFT) output_count += std::max(count, 1);
+		else if (count==0) ++output_count;
+	}
+	if (output_count>std::numeric_limits<int>::max()) THROW(ArgumentException, "The join result has too many rows (" + QString::number(output_count) + ")!");
+
+	QVector<int> data_rows;
+	QVector<int> other_rows;
+	data_rows.reserve(output_count);
+	if (type!=ANTI) other_rows.reserve(output_count);
+	for (int i=0; i<n; ++i)
+	{
+		const int r = order.isEmpty() ? i : order[i];
+		const int count = matches(r);
+		if (count==0)
+		{
+			if (type==INNER) continue;
+			data_rows << r;
+			if (type==LEFT) other_rows << -1;
+		}
+		else if (type!=ANTI)
+		{
+			const int start = offsets[data_groups[r]];
+			for (int k=start; k<start+count; ++k)
+			{
+				data_rows << r;
+				other_rows << other_rows_by_group[k];
+			}
+		}
+	}
+	qDebug() << "join: output r=" << data_rows.count() << "ms=" << timer.restart();
+
+	//columns of the other dataset (in parallel): rows without match are empty
+	struct JoinedColumn
+	{
+		BaseColumn::Type type;
+		QVector<double> numbers;
+		QVector<qint64> datetimes;
+		QVector<char> formats;
+		QVector<QString> strings;
+	};
+	QVector<JoinedColumn> joined(type==ANTI ? 0 : columns.count());
+	QList<int> indices;
+	for (int i=0; i<joined.count(); ++i)
+	{
+		indices << i;
+		other.column(columns[i]).evaluated(); //virtual columns are evaluated before, i.e. not in the parallel section
+	}
+	QtConcurrent::blockingMap(indices, [&](int i)
+	{
+		const BaseColumn& column = other.column(columns[i]).evaluated();
+		JoinedColumn& output = joined[i];
+		const int count = other_rows.count();
+		const int* o = other_rows.constData();
+		output.type = column.type();
+		if (output.type==BaseColumn::NUMERIC)
+		{
+			const NumericColumn& col = static_cast<const NumericColumn&>(column);
+			output.numbers.resize(count);
+			output.formats.resize(count);
+			for (int r=0; r<count; ++r)
+			{
+				output.numbers[r] = o[r]==-1 ? std::numeric_limits<double>::quiet_NaN() : col.value(o[r]);
+				output.formats[r] = o[r]==-1 ? 0 : col.decimals(o[r]);
+			}
+		}
+		else if (output.type==BaseColumn::DATETIME)
+		{
+			const DateTimeColumn& col = static_cast<const DateTimeColumn&>(column);
+			output.datetimes.resize(count);
+			output.formats.resize(count);
+			for (int r=0; r<count; ++r)
+			{
+				output.datetimes[r] = o[r]==-1 ? DateTimeColumn::MISSING : col.value(o[r]);
+				output.formats[r] = o[r]==-1 ? 0 : col.format(o[r]);
+			}
+		}
+		else
+		{
+			output.strings.resize(count);
+			for (int r=0; r<count; ++r)
+			{
+				if (o[r]!=-1) output.strings[r] = column.string(o[r]);
+			}
+		}
+	});
+	qDebug() << "join: gathering columns c=" << joined.count() << "ms=" << timer.restart();
+
+	//update dataset: rows are gathered in display order, so the display order is reset first
+	DataSet::UpdateGuard update(data);
+	data.restoreRowOrder();
+	data.gatherRows(data_rows);
+	for (int i=0; i<joined.count(); ++i)
+	{
+		QString header = other.column(columns[i]).header();
+		if (data.indexOf(header)!=-1) header += "_2";
+		if (joined[i].type==BaseColumn::NUMERIC)
+		{
+			data.addColumn(header, joined[i].numbers, joined[i].formats);
+		}
+		else if (joined[i].type==BaseColumn::DATETIME)
+		{
+			data.addColumn(header, joined[i].datetimes, joined[i].formats);
+		}
+		else
+		{
+			data.addColumn(header, joined[i].strings);
+		}
+	}
+	data.setModified(true, true);
+
+	qDebug() << "join: output c=" << data.columnCount() << "r=" << data.rowCount() << "ms=" << timer.elapsed();
+}
@@ -0,0 +1,32 @@
+#ifndef JOIN_H
+#define JOIN_H
+
+#include "DataSet.h"
+#include <QStringList>
+
+/// Hash join of a dataset with another dataset (e.g. a second TSV file) on one or several key columns.
+/// The hash table is built over the distinct keys of the smaller side and the larger side probes it in parallel blocks. Matching rows are then expanded in the row order of the dataset.
+class Join
+{
+public:
+	///Join types.
+	enum Type
+	{
+		INNER, //rows with matching keys, one row per match
+		LEFT, //all rows, one row per match (columns of the other dataset are empty for rows without match)
+		ANTI //rows without matching key
+	};
+	///Returns the names of the join types (in the order of the enum).
+	static QStringList typeNames();
+
+	///Joins @p data with @p other: @p keys of @p data are matched with @p other_keys of @p other and the @p columns of @p other are appended (not for anti joins).
+	///The rows of @p data are reduced/repeated according to the join type. Key columns of different types are compared by their string representation.
+	///Throws an exception if the key columns are invalid or if the output is too large.
+	static void run(DataSet& data, const QList<int>& keys, const DataSet& other, const QList<int>& other_keys, const QList<int>& columns, Type type);
+
+protected:
+	//determines the key group of each row of both datasets. Groups are the distinct keys of the smaller dataset, rows without matching key have group -1 (only on the larger side). Returns the number of groups.
+	static int groups(const DataSet& data, const QList<int>& keys, const DataSet& other, const QList<int>& other_keys, QVector<int>& data_groups, QVector<int>& other_groups);
+};
+
+#endif // JOIN_H
@@ -0,0 +1,113 @@
+#include "JoinDialog.h"
+#include <QComboBox>
+#include <QPushButton>
+#include <algorithm>
+#include <functional>
+
+JoinDialog::JoinDialog(QStringList headers, QList<int> keys, QStringList other_headers, QWidget* parent)
+	: QDialog(parent)
+	, headers_(headers)
+	, other_headers_(other_headers)
+{
+	ui_.setupUi(this);
+	connect(ui_.add, SIGNAL(clicked()), this, SLOT(addKey()));
+	connect(ui_.remove, SIGNAL(clicked()), this, SLOT(removeKey()));
+	connect(ui_.keys, SIGNAL(itemSelectionChanged()), this, SLOT(updateButtons()));
+	connect(ui_.type, SIGNAL(currentIndexChanged(int)), this, SLOT(updateButtons()));
+
+	ui_.type->addItems(Join::typeNames());
+
+	//key columns (matched by name)
+	foreach(int c, keys)
+	{
+		addKey(c, std::max(0, (int)other_headers.indexOf(headers[c])));
+	}
+	if (keys.isEmpty()) addKey();
+
+	//columns to append: all except the keys
+	QList<int> other_keys = otherKeys();
+	for (int c=0; c<other_headers.count(); ++c)
+	{
+		QListWidgetItem* item = new QListWidgetItem(other_headers[c], ui_.columns);
+		item->setFlags(item->flags() | Qt::ItemIsUserCheckable);
+		item->setCheckState(other_keys.contains(c) ? Qt::Unchecked : Qt::Checked);
+	}
+
+	updateButtons();
+}
+
+Join::Type JoinDialog::type() const
+{
+	return (Join::Type)ui_.type->currentIndex();
+}
+
+QList<int> JoinDialog::keys() const
+{
+	QList<int> output;
+	for (int row=0; row<ui_.keys->rowCount(); ++row)
+	{
+		output << qobject_cast<QComboBox*>(ui_.keys->cellWidget(row, 0))->currentIndex();
+	}
+	return output;
+}
+
+QList<int> JoinDialog::otherKeys() const
+{
+	QList<int> output;
+	for (int row=0; row<ui_.keys->rowCount(); ++row)
+	{
+		output << qobject_cast<QComboBox*>(ui_.keys->cellWidget(row, 1))->currentIndex();
+	}
+	return output;
+}
+
+QList<int> JoinDialog::columns() const
+{
+	QList<int> output;
+	for (int c=0; c<ui_.columns->count(); ++c)
+	{
+		if (ui_.columns->item(c)->checkState()==Qt::Checked) output << c;
+	}
+	return output;
+}
+
+void JoinDialog::addKey(int column, int other_column)
+{
+	int row = ui_.keys->rowCount();
+	ui_.keys->insertRow(row);
+
+	QComboBox* header = new QComboBox();
+	header->addItems(headers_);
+	header->setCurrentIndex(column);
+	ui_.keys->setCellWidget(row, 0, header);
+
+	QComboBox* other_header = new QComboBox();
+	other_header->addItems(other_headers_);
+	other_header->setCurrentIndex(other_column);
+	ui_.keys->setCellWidget(row, 1, other_header);
+
+	updateButtons();
+}
+
+void JoinDialog::removeKey()
+{
+	QList<int> rows;
+	foreach(const QModelIndex& index, ui_.keys->selectionModel()->selectedRows())
+	{
+		rows << index.row();
+	}
+	std::sort(rows.begin(), rows.end(), std::greater<int>());
+	foreach(int row, rows)
+	{
+		ui_.keys->removeRow(row);
+	}
+
+	updateButtons();
+}
+
+void JoinDialog::updateButtons()
+{
+	ui_.remove->setEnabled(!ui_.keys->selectionModel()->selectedRows().isEmpty());
+	ui_.columns->setEnabled(type()!=Join::ANTI);
+	ui_.buttonBox->button(QDialogButtonBox::Ok)->setEnabled(ui_.keys->rowCount()>0);
+}
@@ -0,0 +1,39 @@
+#ifndef JOINDIALOG_H
+#define JOINDIALOG_H
+
+#include <QDialog>
+#include <QStringList>
+#include "Join.h"
+#include "ui_JoinDialog.h"
+
+///Dialog to select the join type, the key column pairs and the columns of the other file that are appended.
+class JoinDialog
+		: public QDialog
+{
+	Q_OBJECT
+
+public:
+	///Constructor. @p keys are the initially selected key columns of the dataset, which are matched with the columns of the same name in the other file if possible.
+	JoinDialog(QStringList headers, QList<int> keys, QStringList other_headers, QWidget* parent = 0);
+
+	///Returns the join type.
+	Join::Type type() const;
+	///Returns the key columns of the dataset.
+	QList<int> keys() const;
+	///Returns the key columns of the other file (in the order of keys()).
+	QList<int> otherKeys() const;
+	///Returns the columns of the other file that are appended.
+	QList<int> columns() const;
+
+private slots:
+	void addKey(int column = 0, int other_column = 0);
+	void removeKey();
+	void updateButtons();
+
+private:
+	Ui::JoinDialog ui_;
+	QStringList headers_;
+	QStringList other_headers_;
+};
+
+#endif // JOINDIALOG_H
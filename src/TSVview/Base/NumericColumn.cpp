@@ -1,8 +1,54 @@
 #include "NumericColumn.h"
 #include "CustomExceptions.h"
 #include "BasicStatistics.h"
+#include "RadixSort.h"
 #include <algorithm>
 #include <math.h>
+#include <cmath>
+#include <charconv>
+#include <QtAlgorithms>
+
+namespace
+{
+	//Formats a value exactly like QString::number(value, 'f', decimals), but without memory allocation.
+	//Returns the number of characters written, or -1 if the value has to be formatted by Qt (special values, large values or many decimals).
+	int formatFixed(double value, int decimals, char* buffer, char* buffer_end)
+	{
+		if (decimals<0 || decimals>17 || !std::isfinite(value) || std::fabs(value)>=1e15 || (value==0.0 && std::signbit(value))) return -1;
+
+		//Qt rounds exact ties away from zero, std::to_chars rounds them to even.
+		//A tie is a value with exactly decimals+1 binary fraction digits, i.e. value = m * 2^-(decimals+1) with odd m.
+		if (value!=0.0)
+		{
+			int exponent;
+			double fraction = std::frexp(std::fabs(value), &exponent);
+			quint64 mantissa = (quint64)std::ldexp(fraction, 53);
+			exponent = exponent - 53 + qCountTrailingZeroBits(mantissa);
+			if (-exponent==decimals+1) value = std::nextafter(value, value>0 ? INFINITY : -INFINITY);
+		}
+
+		std::to_chars_result result = std::to_chars(buffer, buffer_end, value, std::chars_format::fixed, decimals);
+		if (result.ec!=std::errc()) return -1;
+		const int length = (int)(result.ptr - buffer);
+
+		//negative values that are rounded to zero
+		if (value<0.0)
+		{
+			bool is_zero = true;
+			for (int i=1; i<length; ++i)
+			{
+				if (buffer[i]>='1' && buffer[i]<='9')
+				{
+					is_zero = false;
+					break;
+				}
+			}
+			if (is_zero) return -1;
+		}
+
+		return length;
+	}
+}
 
 NumericColumn::NumericColumn()
 	: BaseColumn(NUMERIC)
@@ -21,7 +67,7 @@ void NumericColumn::setString(int row, const QString& value)
     values_[row] = tmp.first;
     decimals_[row] = tmp.second;
 
-	emit dataChanged();
+	emit rowsChanged(row, row+1);
 }
 
 StatisticsSummary NumericColumn::statistics(const QBitArray& filter) const
@@ -70,16 +116,41 @@ void NumericColumn::appendString(const QString& value)
 }
 
 
-void NumericColumn::sort(bool reverse)
+void NumericColumn::appendUtf8(int start, int end, QByteArray& output, QVector<int>& ends) const
 {
-	if (!reverse)
-	{
-		std::sort(values_.begin(), values_.end(), NanAwareDoubleComp());
-	}
-	else
+	char buffer[64];
+	for (int r=start; r<end; ++r)
 	{
-		std::sort(values_.begin(), values_.end(), NanAwareDoubleComp(true));
+		int length = formatFixed(values_[r], decimals_[r], buffer, buffer + sizeof(buffer));
+		if (length>=0)
+		{
+			output.append(buffer, length);
+		}
+		else
+		{
+			output.append(string(r).toUtf8());
+		}
+		ends << output.size();
 	}
+}
+
+QVector<int> NumericColumn::sortOrder(bool reverse) const
+{
+	return RadixSort::order(values_, reverse);
+}
+
+void NumericColumn::applyPermutation(const QVector<int>& order)
+{
+	permute(values_, order);
+	permute(decimals_, order);
+
+	emit dataChanged();
+}
+
+void NumericColumn::gather(const QVector<int>& rows)
+{
+	gatherValues(values_, rows);
+	gatherValues(decimals_, rows);
 
 	emit dataChanged();
 }
@@ -93,6 +164,7 @@ void NumericColumn::setFilter(Filter filter)
 		 && filter.type()!=Filter::FLOAT_GREATER_EQUAL
 		 && filter.type()!=Filter::FLOAT_LESS
 		 && filter.type()!=Filter::FLOAT_LESS_EQUAL
+		 && filter.type()!=Filter::REGION_OVERLAPS
 		 )
 	{
 		THROW(FilterTypeException,"Cannot add a non-numeric filter to a numeric column!");
@@ -103,10 +175,10 @@ void NumericColumn::setFilter(Filter filter)
 	emit filterChanged();
 }
 
-void NumericColumn::matchFilter(QBitArray &array) const
+void NumericColumn::matchFilter(QBitArray& array, int start, int end) const
 {
 	Filter::Type type = filter().type();
-	if (type == Filter::NONE)
+	if (type == Filter::NONE || type == Filter::REGION_OVERLAPS) //region filters are applied by the dataset
 	{
 		return;
 	}
@@ -115,63 +187,27 @@ void NumericColumn::matchFilter(QBitArray &array) const
 
 	if (type == Filter::FLOAT_EXACT)
 	{
-		for (int r=0; r<count(); ++r)
-		{
-			if (array[r])
-			{
-				array[r] = fabs(values_[r] - value) < 0.0001;
-			}
-		}
+		matchValues(values_, array, [value](double v) { return fabs(v - value) < 0.0001; }, start, end);
 	}
 	else if (type == Filter::FLOAT_EXACT_NOT)
 	{
-		for (int r=0; r<count(); ++r)
-		{
-			if (array[r])
-			{
-				array[r] = fabs(values_[r] - value) > 0.0001;
-			}
-		}
+		matchValues(values_, array, [value](double v) { return fabs(v - value) > 0.0001; }, start, end);
 	}
 	else if (type == Filter::FLOAT_GREATER)
 	{
-		for (int r=0; r<count(); ++r)
-		{
-			if (array[r])
-			{
-				array[r] = values_[r] > value;
-			}
-		}
+		matchValues(values_, array, [value](double v) { return v > value; }, start, end);
 	}
 	else if (type == Filter::FLOAT_GREATER_EQUAL)
 	{
-		for (int r=0; r<count(); ++r)
-		{
-			if (array[r])
-			{
-				array[r] = values_[r] >= value;
-			}
-		}
+		matchValues(values_, array, [value](double v) { return v >= value; }, start, end);
 	}
 	else if (type == Filter::FLOAT_LESS)
 	{
-		for (int r=0; r<count(); ++r)
-		{
-			if (array[r])
-			{
-				array[r] = values_[r] < value;
-			}
-		}
+		matchValues(values_, array, [value](double v) { return v < value; }, start, end);
 	}
 	else if (type == Filter::FLOAT_LESS_EQUAL)
 	{
-		for (int r=0; r<count(); ++r)
-		{
-			if (array[r])
-			{
-				array[r] = values_[r] <= value;
-			}
-		}
+		matchValues(values_, array, [value](double v) { return v <= value; }, start, end);
 	}
 	else
 	{
@@ -179,31 +215,6 @@ void NumericColumn::matchFilter(QBitArray &array) const
 	}
 }
 
-
-NumericColumn::NanAwareDoubleComp::NanAwareDoubleComp(bool greater)
-	: greater_(greater)
-{
-}
-
-bool NumericColumn::NanAwareDoubleComp::operator()(double a, double b) const
-{
-	//handle NAN
-    if (std::isnan(a)) a = std::numeric_limits<double>::max();
-    if (std::isnan(b)) b = std::numeric_limits<double>::max();
-
-	//compare
-	if (greater_)
-	{
-		if (a>b) return true;
-	}
-	else
-	{
-		if (a<b) return true;
-	}
-
-	return false;
-}
-
 QPair<double, char> NumericColumn::toDouble(const QString& value, bool nan_instead_of_exception)
 {
     //special handling inf
@@ -20,7 +20,7 @@ public:
     QVector<double> values(const QBitArray& filter) const;
     void setValues(const QVector<double>& values, const QVector<char>& decimals)
 	{
-        Q_ASSERT(values_.count()==decimals.count());
+        Q_ASSERT(values.count()==decimals.count());
 		values_ = values;
         decimals_ = decimals;
 		emit dataChanged();
@@ -32,10 +32,10 @@ public:
 	}
     void setValue(int row, double value, char decimals=-1)
 	{
-        Q_ASSERT(row>0 && row<values_.count());
+        Q_ASSERT(row>=0 && row<values_.count());
 		values_[row] = value;
         if (decimals>=0) decimals_[row] = decimals;
-		emit dataChanged();
+		emit rowsChanged(row, row+1);
     }
     const QVector<char>& decimals() const
     {
@@ -63,7 +63,10 @@ public:
 		values_.reserve(rows);
         decimals_.reserve(rows);
 	}
-	virtual void sort(bool reverse=false);
+	///Returns the sort order of the rows (stable radix sort). NaN values are sorted to the end (to the start if @p reverse is set).
+	virtual QVector<int> sortOrder(bool reverse=false) const;
+	virtual void applyPermutation(const QVector<int>& order);
+	virtual void gather(const QVector<int>& rows);
     virtual qsizetype count() const
 	{
 		return values_.count();
@@ -85,9 +88,11 @@ public:
 	}
 	virtual void setString(int row, const QString& value);
 	void appendString(const QString& value);
+	virtual void appendUtf8(int start, int end, QByteArray& output, QVector<int>& ends) const;
 
 	virtual void setFilter(Filter filter);
-	virtual void matchFilter(QBitArray& array) const;
+	using BaseColumn::matchFilter;
+	virtual void matchFilter(QBitArray& array, int start, int end) const;
 
     StatisticsSummary statistics(const QBitArray& filter) const;
     QPair<double, double> getMinMax(const QBitArray& filter) const;
@@ -100,17 +105,6 @@ protected:
 	QVector<double> values_;
     QVector<char> decimals_;
     QString header_;
-
-	///NAN-aware comparator class for doubles. NAN is handled as numeric_limits<double>::max()
-	class NanAwareDoubleComp
-	{
-		public:
-			NanAwareDoubleComp(bool greater = false);
-			bool operator()(double a, double b) const;
-
-		private:
-			bool greater_;
-	};
 };
 
 #endif // NUMERICCOLUMN_H
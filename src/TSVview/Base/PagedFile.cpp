@@ -0,0 +1,215 @@
+#include "PagedFile.h"
+#include "BgzfReader.h"
+#include "Exceptions.h"
+#include <QFileInfo>
+#include <QElapsedTimer>
+#include <QDebug>
+#include <cstring>
+#include <algorithm>
+
+PagedFile::PagedFile(QString filename, qint64 cache_size)
+	: filename_(filename)
+	, bgzf_(BgzfReader::isBgzf(filename))
+	, header_lines_()
+	, rows_(0)
+	, offsets_()
+	, file_(filename)
+	, reader_()
+	, cache_(cache_size)
+{
+	if (!isSupported(filename)) THROW(FileParseException, "File '" + filename + "' cannot be opened in paged mode. Only uncompressed and bgzip-compressed files are supported!");
+
+	QElapsedTimer timer;
+	timer.start();
+
+	if (bgzf_)
+	{
+		reader_.reset(new BgzfReader(filename));
+		indexBgzf();
+	}
+	else
+	{
+		if (!file_.open(QFile::ReadOnly)) THROW(FileAccessException, "Could not open file '" + filename + "' for reading.");
+		indexPlain();
+	}
+
+	qDebug() << "indexing file for paged mode: r=" << rows_ << "chunks=" << chunkCount() << "ms=" << timer.elapsed();
+}
+
+PagedFile::~PagedFile()
+{
+}
+
+bool PagedFile::isSupported(QString filename)
+{
+	if (BgzfReader::isBgzf(filename)) return true;
+
+	//other gzip files do not support random access
+	QFile file(filename);
+	if (!file.open(QFile::ReadOnly)) return false;
+	QByteArray magic = file.read(2);
+	return !(magic.size()==2 && (uchar)magic[0]==31 && (uchar)magic[1]==139);
+}
+
+qint64 PagedFile::estimatedMemory(QString filename)
+{
+	//strings are stored as UTF-16 with some overhead per cell. Compressed TSV files typically have a compression ratio of about 4.
+	qint64 size = QFileInfo(filename).size();
+	if (filename.endsWith(".gz", Qt::CaseInsensitive) || filename.endsWith(".bgz", Qt::CaseInsensitive)) size *= 4;
+	return 3 * size;
+}
+
+void PagedFile::indexPlain()
+{
+	//header lines
+	qint64 line_start = 0;
+	while (!file_.atEnd())
+	{
+		line_start = file_.pos();
+		QByteArray line = file_.readLine();
+		while (line.endsWith('\n') || line.endsWith('\r')) line.chop(1);
+		if (line.isEmpty()) continue;
+		if (line[0]!='#')
+		{
+			file_.seek(line_start);
+			break;
+		}
+		header_lines_ << QString::fromUtf8(line);
+		line_start = file_.pos();
+	}
+
+	//content lines: search for newlines in large blocks
+	const qint64 file_size = file_.size();
+	QByteArray buffer;
+	qint64 buffer_start = line_start;
+	bool line_empty = true;
+	while (buffer_start<file_size)
+	{
+		buffer = file_.read(16 * 1024 * 1024);
+		if (buffer.isEmpty()) THROW(FileAccessException, "Could not read from file '" + filename_ + "'!");
+
+		const char* data = buffer.constData();
+		const int size = buffer.size();
+		int pos = 0;
+		while (pos<size)
+		{
+			const char* newline = (const char*)memchr(data+pos, '\n', size-pos);
+			const int end = newline==nullptr ? size : (int)(newline-data);
+
+			//line content up to the newline ('\r' does not count as content)
+			if (line_empty)
+			{
+				for (int i=pos; i<end; ++i)
+				{
+					if (data[i]!='\r')
+					{
+						line_empty = false;
+						break;
+					}
+				}
+			}
+			if (newline==nullptr) break;
+
+			if (!line_empty) addRow(line_start);
+			line_start = buffer_start + end + 1;
+			line_empty = true;
+			pos = end + 1;
+		}
+
+		buffer_start += size;
+	}
+	if (!line_empty) addRow(line_start);
+
+	offsets_ << file_size;
+}
+
+void PagedFile::indexBgzf()
+{
+	//header lines
+	quint64 line_start = 0;
+	QByteArray line;
+	while (!reader_->atEnd())
+	{
+		line_start = reader_->tell();
+		line = reader_->readLine();
+		if (line.isEmpty()) continue;
+		if (line[0]!='#') break;
+		header_lines_ << QString::fromUtf8(line);
+		line.clear();
+	}
+
+	//content lines (the first one was already read)
+	if (!line.isEmpty()) addRow(line_start);
+	while (!reader_->atEnd())
+	{
+		line_start = reader_->tell();
+		if (!reader_->readLine().isEmpty()) addRow(line_start);
+	}
+
+	offsets_ << reader_->tell();
+}
+
+QVector<QByteArray> PagedFile::chunk(int index) const
+{
+	Q_ASSERT(index>=0 && index<chunkCount());
+
+	QVector<QByteArray>* cached = cache_.object(index);
+	if (cached!=nullptr) return *cached;
+
+	const int rows = (int)std::min((qint64)CHUNK_ROWS, rows_ - (qint64)index * CHUNK_ROWS);
+	QVector<QByteArray> output;
+	output.reserve(rows);
+	if (bgzf_)
+	{
+		reader_->seek(offsets_[index]);
+		while (output.count()<rows && !reader_->atEnd())
+		{
+			QByteArray line = reader_->readLine();
+			if (!line.isEmpty()) output << line;
+		}
+	}
+	else
+	{
+		file_.seek(offsets_[index]);
+		QByteArray data = file_.read(offsets_[index+1] - offsets_[index]);
+		foreach(QByteArray line, data.split('\n'))
+		{
+			if (line.endsWith('\r')) line.chop(1);
+			if (!line.isEmpty()) output << line;
+		}
+	}
+	if (output.count()!=rows) THROW(FileParseException, "File '" + filename_ + "' changed since it was indexed. Please re-open it!");
+
+	//cache chunk (cost is the approximate memory size)
+	qint64 cost = sizeof(QVector<QByteArray>) + rows * sizeof(QByteArray);
+	foreach(const QByteArray& line, output)
+	{
+		cost += line.size() + 32;
+	}
+	cache_.insert(index, new QVector<QByteArray>(output), cost);
+
+	return output;
+}
+
+QVector<QByteArray> PagedFile::lines(qint64 first_row, int count) const
+{
+	QVector<QByteArray> output;
+	count = (int)std::max(0ll, std::min((qint64)count, rows_ - first_row));
+	output.reserve(count);
+
+	qint64 row = first_row;
+	while (output.count()<count)
+	{
+		int index = (int)(row / CHUNK_ROWS);
+		QVector<QByteArray> lines = chunk(index);
+		int start = (int)(row - (qint64)index * CHUNK_ROWS);
+		int end = std::min((int)lines.count(), start + (count - (int)output.count()));
+		for (int i=start; i<end; ++i)
+		{
+			output << lines[i];
+		}
+		row += end - start;
+	}
+
+	return output;
+}
@@ -0,0 +1,82 @@
+#ifndef PAGEDFILE_H
+#define PAGEDFILE_H
+
+#include <QFile>
+#include <QCache>
+#include <QVector>
+#include <QByteArray>
+#include <QStringList>
+#include <QSharedPointer>
+
+class BgzfReader;
+
+/// Random access to the content lines of TSV files that do not fit into memory (uncompressed or bgzip-compressed).
+/// A fast first pass indexes the file offset of every chunk of CHUNK_ROWS content lines. Chunks are read on demand and kept in a LRU cache of limited size.
+class PagedFile
+{
+public:
+	///Number of content lines per chunk.
+	static const int CHUNK_ROWS = 16384;
+
+	///Indexes the file. @p cache_size is the maximum size of cached chunks in bytes. Throws an exception if the file cannot be paged.
+	PagedFile(QString filename, qint64 cache_size);
+	~PagedFile();
+
+	///Returns if the file supports paging, i.e. if it is uncompressed or bgzip-compressed (random access).
+	static bool isSupported(QString filename);
+	///Returns the estimated memory in bytes needed to load the file completely.
+	static qint64 estimatedMemory(QString filename);
+
+	const QString& filename() const
+	{
+		return filename_;
+	}
+	///Returns the header/comment lines at the start of the file.
+	const QStringList& headerLines() const
+	{
+		return header_lines_;
+	}
+	///Returns the number of content lines (empty lines are not counted).
+	qint64 rowCount() const
+	{
+		return rows_;
+	}
+	int chunkCount() const
+	{
+		return offsets_.count() - 1;
+	}
+
+	///Returns the content lines of a chunk (without newline characters).
+	QVector<QByteArray> chunk(int index) const;
+	///Returns the content lines in the given range.
+	QVector<QByteArray> lines(qint64 first_row, int count) const;
+
+protected:
+	QString filename_;
+	bool bgzf_;
+	QStringList header_lines_;
+	qint64 rows_;
+	//start offset of each chunk, plus end offset of the last chunk. Virtual offsets for BGZF files.
+	QVector<quint64> offsets_;
+
+	mutable QFile file_;
+	mutable QSharedPointer<BgzfReader> reader_;
+	mutable QCache<int, QVector<QByteArray>> cache_;
+
+	void indexPlain();
+	void indexBgzf();
+	//adds a content line to the index, which starts at the given offset
+	void addRow(quint64 offset)
+	{
+		if (rows_%CHUNK_ROWS==0) offsets_ << offset;
+		++rows_;
+	}
+
+private:
+	//not implemented
+	PagedFile(const PagedFile& rhs);
+	//not implemented
+	PagedFile& operator=(const PagedFile& rhs);
+};
+
+#endif // PAGEDFILE_H
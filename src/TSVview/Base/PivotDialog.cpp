@@ -0,0 +1,99 @@
+#include "PivotDialog.h"
+#include <QComboBox>
+#include <QPushButton>
+#include <algorithm>
+#include <functional>
+
+PivotDialog::PivotDialog(QStringList headers, QList<int> keys, QWidget* parent)
+	: QDialog(parent)
+	, headers_(headers)
+{
+	ui_.setupUi(this);
+	connect(ui_.add, SIGNAL(clicked()), this, SLOT(addAggregation()));
+	connect(ui_.remove, SIGNAL(clicked()), this, SLOT(removeAggregation()));
+	connect(ui_.aggregations, SIGNAL(itemSelectionChanged()), this, SLOT(updateButtons()));
+
+	//key columns
+	for (int c=0; c<headers.count(); ++c)
+	{
+		QListWidgetItem* item = new QListWidgetItem(headers[c], ui_.keys);
+		item->setFlags(item->flags() | Qt::ItemIsUserCheckable);
+		item->setCheckState(keys.contains(c) ? Qt::Checked : Qt::Unchecked);
+	}
+
+	//pivot column
+	ui_.pivot->addItem("[none]");
+	ui_.pivot->addItems(headers);
+
+	//count rows of each group by default
+	addAggregation(keys.isEmpty() ? 0 : keys[0], GroupBy::COUNT);
+	updateButtons();
+}
+
+QList<int> PivotDialog::keys() const
+{
+	QList<int> output;
+	for (int c=0; c<ui_.keys->count(); ++c)
+	{
+		if (ui_.keys->item(c)->checkState()==Qt::Checked) output << c;
+	}
+	return output;
+}
+
+int PivotDialog::pivotColumn() const
+{
+	return ui_.pivot->currentIndex() - 1;
+}
+
+QList<GroupBy::Aggregation> PivotDialog::aggregations() const
+{
+	QList<GroupBy::Aggregation> output;
+	for (int row=0; row<ui_.aggregations->rowCount(); ++row)
+	{
+		GroupBy::Aggregation aggregation;
+		aggregation.column = qobject_cast<QComboBox*>(ui_.aggregations->cellWidget(row, 0))->currentIndex();
+		aggregation.function = (GroupBy::Function)qobject_cast<QComboBox*>(ui_.aggregations->cellWidget(row, 1))->currentIndex();
+		output << aggregation;
+	}
+	return output;
+}
+
+void PivotDialog::addAggregation(int column, GroupBy::Function function)
+{
+	int row = ui_.aggregations->rowCount();
+	ui_.aggregations->insertRow(row);
+
+	QComboBox* header = new QComboBox();
+	header->addItems(headers_);
+	header->setCurrentIndex(column);
+	ui_.aggregations->setCellWidget(row, 0, header);
+
+	QComboBox* functions = new QComboBox();
+	functions->addItems(GroupBy::functionNames());
+	functions->setCurrentIndex(function);
+	ui_.aggregations->setCellWidget(row, 1, functions);
+
+	updateButtons();
+}
+
+void PivotDialog::removeAggregation()
+{
+	QList<int> rows;
+	foreach(const QModelIndex& index, ui_.aggregations->selectionModel()->selectedRows())
+	{
+		rows << index.row();
+	}
+	std::sort(rows.begin(), rows.end(), std::greater<int>());
+	foreach(int row, rows)
+	{
+		ui_.aggregations->removeRow(row);
+	}
+
+	updateButtons();
+}
+
+void PivotDialog::updateButtons()
+{
+	ui_.remove->setEnabled(!ui_.aggregations->selectionModel()->selectedRows().isEmpty());
+	ui_.buttonBox->button(QDialogButtonBox::Ok)->setEnabled(ui_.aggregations->rowCount()>0);
+}
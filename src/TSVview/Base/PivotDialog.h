@@ -0,0 +1,36 @@
+#ifndef PIVOTDIALOG_H
+#define PIVOTDIALOG_H
+
+#include <QDialog>
+#include <QStringList>
+#include "GroupBy.h"
+#include "ui_PivotDialog.h"
+
+///Dialog to select the key columns, the pivot column and the aggregations of a group-by.
+class PivotDialog
+		: public QDialog
+{
+	Q_OBJECT
+
+public:
+	///Constructor. @p keys are the initially selected key columns.
+	PivotDialog(QStringList headers, QList<int> keys, QWidget* parent = 0);
+
+	///Returns the key columns.
+	QList<int> keys() const;
+	///Returns the pivot column, or -1 if no pivot column is selected.
+	int pivotColumn() const;
+	///Returns the aggregations.
+	QList<GroupBy::Aggregation> aggregations() const;
+
+private slots:
+	void addAggregation(int column = 0, GroupBy::Function function = GroupBy::COUNT);
+	void removeAggregation();
+	void updateButtons();
+
+private:
+	Ui::PivotDialog ui_;
+	QStringList headers_;
+};
+
+#endif // PIVOTDIALOG_H
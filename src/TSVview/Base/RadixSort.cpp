@@ -0,0 +1,183 @@
+#include "RadixSort.h"
+#include <numeric>
+#include <cmath>
+#include <algorithm>
+#include <functional>
+#include <QThread>
+#include <QtConcurrent>
+
+//keys are sorted in 6 passes of 11-bit digits
+static const int BITS = 11;
+static const int DIGITS = (64 + BITS - 1) / BITS;
+static const int BUCKETS = 1 << BITS;
+static const quint64 MASK = BUCKETS - 1;
+
+QVector<int> RadixSort::order(QVector<quint64> keys, bool reverse)
+{
+	const int n = keys.count();
+
+	//descending order: invert keys (keeps the sort stable)
+	if (reverse)
+	{
+		for (int i=0; i<n; ++i)
+		{
+			keys[i] = ~keys[i];
+		}
+	}
+
+	//split keys into chunks that are processed in parallel
+	const int chunks = n<PARALLEL_MIN ? 1 : std::max(1, std::min(QThread::idealThreadCount(), 64));
+	const int chunk_size = (n + chunks - 1) / std::max(1, chunks);
+	QList<int> chunk_indices;
+	for (int c=0; c<chunks; ++c)
+	{
+		chunk_indices << c;
+	}
+	auto forChunks = [&](std::function<void(int c, int start, int end)> func)
+	{
+		if (chunks==1)
+		{
+			func(0, 0, n);
+			return;
+		}
+		QtConcurrent::blockingMap(chunk_indices, [&](int c)
+		{
+			func(c, std::min(n, c*chunk_size), std::min(n, (c+1)*chunk_size));
+		});
+	};
+
+	//create histograms of all digits in one pass (to skip digits that are the same for all keys)
+	QVector<int> chunk_counts(chunks * DIGITS * BUCKETS, 0);
+	forChunks([&](int c, int start, int end)
+	{
+		int* counts = chunk_counts.data() + c*DIGITS*BUCKETS;
+		const quint64* k = keys.constData();
+		for (int i=start; i<end; ++i)
+		{
+			quint64 key = k[i];
+			for (int d=0; d<DIGITS; ++d)
+			{
+				++counts[d*BUCKETS + ((key >> (BITS*d)) & MASK)];
+			}
+		}
+	});
+	QVector<int> counts(DIGITS * BUCKETS, 0);
+	for (int c=0; c<chunks; ++c)
+	{
+		for (int i=0; i<DIGITS*BUCKETS; ++i)
+		{
+			counts[i] += chunk_counts[c*DIGITS*BUCKETS + i];
+		}
+	}
+
+	QVector<int> indices(n);
+	std::iota(indices.begin(), indices.end(), 0);
+	QVector<int> indices_tmp(n);
+	QVector<quint64> keys_tmp(n);
+
+	QVector<int> offsets(chunks * BUCKETS);
+	for (int d=0; d<DIGITS; ++d)
+	{
+		//skip digits that are the same for all keys
+		bool skip = false;
+		for (int b=0; b<BUCKETS; ++b)
+		{
+			if (counts[d*BUCKETS + b]==n)
+			{
+				skip = true;
+				break;
+			}
+		}
+		if (skip) continue;
+
+		//count digits per chunk
+		const int shift = BITS*d;
+		offsets.fill(0);
+		forChunks([&](int c, int start, int end)
+		{
+			int* count = offsets.data() + c*BUCKETS;
+			const quint64* k = keys.constData();
+			for (int i=start; i<end; ++i)
+			{
+				++count[(k[i] >> shift) & MASK];
+			}
+		});
+
+		//convert counts to start positions: by digit, then by chunk (keeps the sort stable)
+		int pos = 0;
+		for (int b=0; b<BUCKETS; ++b)
+		{
+			for (int c=0; c<chunks; ++c)
+			{
+				int tmp = offsets[c*BUCKETS + b];
+				offsets[c*BUCKETS + b] = pos;
+				pos += tmp;
+			}
+		}
+
+		//scatter
+		const quint64* k_in = keys.constData();
+		const int* i_in = indices.constData();
+		quint64* k_out = keys_tmp.data();
+		int* i_out = indices_tmp.data();
+		forChunks([&](int c, int start, int end)
+		{
+			int* count = offsets.data() + c*BUCKETS;
+			for (int i=start; i<end; ++i)
+			{
+				int p = count[(k_in[i] >> shift) & MASK]++;
+				k_out[p] = k_in[i];
+				i_out[p] = i_in[i];
+			}
+		});
+
+		keys.swap(keys_tmp);
+		indices.swap(indices_tmp);
+	}
+
+	return indices;
+}
+
+QVector<int> RadixSort::order(const QVector<double>& values, bool reverse)
+{
+	const int n = values.count();
+
+	//partition NaN values out up front
+	QVector<quint64> keys;
+	keys.reserve(n);
+	QVector<int> rows; //rows of the keys (only if NaN values are present)
+	QVector<int> nan_rows;
+	const double* v = values.constData();
+	for (int i=0; i<n; ++i)
+	{
+		if (std::isnan(v[i]))
+		{
+			if (nan_rows.isEmpty())
+			{
+				rows.resize(i);
+				std::iota(rows.begin(), rows.end(), 0);
+			}
+			nan_rows << i;
+		}
+		else
+		{
+			if (!nan_rows.isEmpty()) rows << i;
+			keys << key(v[i]);
+		}
+	}
+
+	QVector<int> order = RadixSort::order(keys, reverse);
+	if (nan_rows.isEmpty()) return order;
+
+	//convert key indices to rows and add NaN rows
+	QVector<int> output;
+	output.reserve(n);
+	if (reverse) output << nan_rows;
+	foreach(int i, order)
+	{
+		output << rows[i];
+	}
+	if (!reverse) output << nan_rows;
+
+	return output;
+}
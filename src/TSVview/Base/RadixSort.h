@@ -0,0 +1,35 @@
+#ifndef RADIXSORT_H
+#define RADIXSORT_H
+
+#include <QVector>
+#include <cstring>
+
+/// LSD radix sort on 64-bit keys (11-bit digits). Sorting is stable and returns the sort order (indices into the key array).
+/// Large inputs are split into chunks, which are counted and scattered in parallel.
+class RadixSort
+{
+public:
+	///Returns the stable sort order of the given keys.
+	static QVector<int> order(QVector<quint64> keys, bool reverse = false);
+	///Returns the stable sort order of the given values. NaN values are sorted to the end (to the start if @p reverse is set) and keep their order.
+	static QVector<int> order(const QVector<double>& values, bool reverse = false);
+
+	///Converts a signed integer to a key with the same ordering.
+	static quint64 key(qint64 value)
+	{
+		return (quint64)value ^ 0x8000000000000000ull;
+	}
+	///Converts a double (not NaN) to a key with the same ordering: the sign bit of positive values is set, all bits of negative values are inverted.
+	static quint64 key(double value)
+	{
+		if (value==0.0) value = 0.0; //-0.0 equals 0.0
+		quint64 bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		return (bits & 0x8000000000000000ull) ? ~bits : (bits | 0x8000000000000000ull);
+	}
+
+	///Minimum number of keys that are sorted in parallel.
+	static const int PARALLEL_MIN = 1 << 20;
+};
+
+#endif // RADIXSORT_H
@@ -0,0 +1,106 @@
+#include "RowKeys.h"
+#include "DataSet.h"
+#include <QtConcurrent>
+#include <cstring>
+#include <cmath>
+
+RowKeys::RowKeys(const DataSet& data, const QList<int>& columns, const QSet<int>& as_strings)
+	: keys_()
+	, rows_(data.rowCount())
+	, strings_()
+{
+	for (int k=0; k<columns.count(); ++k)
+	{
+		const int c = columns[k];
+		Key key = { data.column(c).type(), nullptr, nullptr, nullptr };
+		if (as_strings.contains(k) && key.type!=BaseColumn::STRING)
+		{
+			QVector<QString> strings(rows_);
+			for (int r=0; r<rows_; ++r)
+			{
+				strings[r] = data.column(c).string(r);
+			}
+			strings_ << strings;
+			key.type = BaseColumn::STRING;
+			key.strings = strings_.last().constData();
+		}
+		else if (key.type==BaseColumn::NUMERIC) key.numbers = data.numericColumn(c).values().constData();
+		else if (key.type==BaseColumn::DATETIME) key.datetimes = data.dateTimeColumn(c).values().constData();
+		else key.strings = data.stringColumn(c).values().constData();
+		keys_ << key;
+	}
+}
+
+quint64 RowKeys::hash(int row) const
+{
+	quint64 hash = 0x9e3779b97f4a7c15ull;
+	foreach(const Key& key, keys_)
+	{
+		quint64 value;
+		if (key.type==BaseColumn::NUMERIC)
+		{
+			double number = key.numbers[row];
+			if (number==0.0) number = 0.0; //-0.0 equals 0.0
+			if (std::isnan(number)) value = 0x7ff8000000000000ull; //all NaN values are equal
+			else std::memcpy(&value, &number, sizeof(value));
+		}
+		else if (key.type==BaseColumn::DATETIME)
+		{
+			value = (quint64)key.datetimes[row];
+		}
+		else
+		{
+			value = qHash(key.strings[row], 0);
+		}
+		hash = mix64(hash ^ value);
+	}
+	return hash;
+}
+
+QVector<quint64> RowKeys::hashes() const
+{
+	QVector<quint64> output(rows_);
+	quint64* h = output.data();
+
+	QList<QPair<int, int>> blocks;
+	for (int start=0; start<rows_; start+=65536)
+	{
+		blocks << qMakePair(start, std::min(start+65536, rows_));
+	}
+	QtConcurrent::blockingMap(blocks, [this, h](const QPair<int, int>& block)
+	{
+		for (int r=block.first; r<block.second; ++r)
+		{
+			h[r] = hash(r);
+		}
+	});
+
+	return output;
+}
+
+bool RowKeys::equal(int a, const RowKeys& other, int b) const
+{
+	Q_ASSERT(keys_.count()==other.keys_.count());
+
+	for (int k=0; k<keys_.count(); ++k)
+	{
+		const Key& key = keys_[k];
+		const Key& other_key = other.keys_[k];
+		Q_ASSERT(key.type==other_key.type);
+		if (key.type==BaseColumn::NUMERIC)
+		{
+			const double v1 = key.numbers[a];
+			const double v2 = other_key.numbers[b];
+			if (v1!=v2 && !(std::isnan(v1) && std::isnan(v2))) return false;
+		}
+		else if (key.type==BaseColumn::DATETIME)
+		{
+			if (key.datetimes[a]!=other_key.datetimes[b]) return false;
+		}
+		else if (key.strings[a]!=other_key.strings[b])
+		{
+			return false;
+		}
+	}
+	return true;
+}
@@ -0,0 +1,60 @@
+#ifndef ROWKEYS_H
+#define ROWKEYS_H
+
+#include "BaseColumn.h"
+#include <QVector>
+#include <QList>
+#include <QSet>
+#include <QString>
+
+class DataSet;
+
+/// Keys of rows formed by the values of several columns, e.g. for grouping, de-duplication and joins.
+/// Keys are hashed and compared on the native column values (double bits, date/time integers, strings), i.e. without virtual calls or string conversion per row.
+class RowKeys
+{
+public:
+	///Creates the keys of the given columns. Columns at the key positions in @p as_strings are compared by their string representation, e.g. if key columns of different types are joined.
+	RowKeys(const DataSet& data, const QList<int>& columns, const QSet<int>& as_strings = QSet<int>());
+
+	///Returns the number of rows.
+	int count() const
+	{
+		return rows_;
+	}
+	///Returns the 64-bit hash of the key of a row.
+	quint64 hash(int row) const;
+	///Returns the hashes of all rows (computed in parallel blocks).
+	QVector<quint64> hashes() const;
+	///Returns if the keys of two rows are equal.
+	bool equal(int a, int b) const
+	{
+		return equal(a, *this, b);
+	}
+	///Returns if the key of row @p a equals the key of row @p b of @p other (which has to have the same key types).
+	bool equal(int a, const RowKeys& other, int b) const;
+
+	///Finalizer of splitmix64: fast 64-bit hash of a 64-bit value.
+	static quint64 mix64(quint64 x)
+	{
+		x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+		x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+		return x ^ (x >> 31);
+	}
+
+protected:
+	//native values of a key column
+	struct Key
+	{
+		BaseColumn::Type type;
+		const double* numbers;
+		const qint64* datetimes;
+		const QString* strings;
+	};
+	QVector<Key> keys_;
+	int rows_;
+	//string representations of the columns compared as strings
+	QList<QVector<QString>> strings_;
+};
+
+#endif // ROWKEYS_H
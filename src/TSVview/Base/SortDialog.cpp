@@ -0,0 +1,82 @@
+#include "SortDialog.h"
+#include <QComboBox>
+#include <QPushButton>
+#include <algorithm>
+#include <functional>
+
+SortDialog::SortDialog(QStringList headers, QList<int> columns, QWidget* parent)
+	: QDialog(parent)
+	, headers_(headers)
+{
+	ui_.setupUi(this);
+	connect(ui_.add, SIGNAL(clicked()), this, SLOT(addKey()));
+	connect(ui_.remove, SIGNAL(clicked()), this, SLOT(removeKey()));
+	connect(ui_.keys, SIGNAL(itemSelectionChanged()), this, SLOT(updateButtons()));
+
+	foreach(int column, columns)
+	{
+		addKey(column);
+	}
+	if (columns.isEmpty()) addKey();
+	updateButtons();
+}
+
+QList<int> SortDialog::columns() const
+{
+	QList<int> output;
+	for (int row=0; row<ui_.keys->rowCount(); ++row)
+	{
+		output << qobject_cast<QComboBox*>(ui_.keys->cellWidget(row, 0))->currentIndex();
+	}
+	return output;
+}
+
+QList<bool> SortDialog::reverse() const
+{
+	QList<bool> output;
+	for (int row=0; row<ui_.keys->rowCount(); ++row)
+	{
+		output << (qobject_cast<QComboBox*>(ui_.keys->cellWidget(row, 1))->currentIndex()==1);
+	}
+	return output;
+}
+
+void SortDialog::addKey(int column)
+{
+	int row = ui_.keys->rowCount();
+	ui_.keys->insertRow(row);
+
+	QComboBox* header = new QComboBox();
+	header->addItems(headers_);
+	header->setCurrentIndex(column);
+	ui_.keys->setCellWidget(row, 0, header);
+
+	QComboBox* direction = new QComboBox();
+	direction->addItems(QStringList() << "ascending" << "descending");
+	ui_.keys->setCellWidget(row, 1, direction);
+
+	updateButtons();
+}
+
+void SortDialog::removeKey()
+{
+	QList<int> rows;
+	foreach(const QModelIndex& index, ui_.keys->selectionModel()->selectedRows())
+	{
+		rows << index.row();
+	}
+	std::sort(rows.begin(), rows.end(), std::greater<int>());
+	foreach(int row, rows)
+	{
+		ui_.keys->removeRow(row);
+	}
+
+	updateButtons();
+}
+
+void SortDialog::updateButtons()
+{
+	int selected = ui_.keys->selectionModel()->selectedRows().count();
+	ui_.remove->setEnabled(selected>0 && selected<ui_.keys->rowCount());
+	ui_.buttonBox->button(QDialogButtonBox::Ok)->setEnabled(ui_.keys->rowCount()>0);
+}
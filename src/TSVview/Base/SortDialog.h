@@ -0,0 +1,33 @@
+#ifndef SORTDIALOG_H
+#define SORTDIALOG_H
+
+#include <QDialog>
+#include <QStringList>
+#include "ui_SortDialog.h"
+
+///Dialog to select the sort keys for sorting by several columns.
+class SortDialog
+		: public QDialog
+{
+	Q_OBJECT
+
+public:
+	///Constructor. @p columns are the initial sort keys (in ascending order).
+	SortDialog(QStringList headers, QList<int> columns, QWidget* parent = 0);
+
+	///Returns the column indices of the sort keys, starting with the primary key.
+	QList<int> columns() const;
+	///Returns the sort direction of each sort key (true for descending).
+	QList<bool> reverse() const;
+
+private slots:
+	void addKey(int column = 0);
+	void removeKey();
+	void updateButtons();
+
+private:
+	Ui::SortDialog ui_;
+	QStringList headers_;
+};
+
+#endif // SORTDIALOG_H
@@ -1,26 +1,217 @@
 #include "StringColumn.h"
 #include "CustomExceptions.h"
+#include "RadixSort.h"
 #include <algorithm>
+#include <numeric>
+#include <vector>
 #include <QRegularExpression>
+#include <QHash>
+#include <QCollator>
+#include <QElapsedTimer>
+#include <QDebug>
+#include <QtConcurrent>
 
 StringColumn::StringColumn()
 	: BaseColumn(STRING)
 	, values_()
 	, header_()
+	, sort_mode_(BINARY)
+	, sort_ranks_()
 {
 }
 
-void StringColumn::sort(bool reverse)
+void StringColumn::appendUtf8(int start, int end, QByteArray& output, QVector<int>& ends) const
 {
-	if (!reverse)
+	for (int r=start; r<end; ++r)
 	{
-		std::sort(values_.begin(), values_.end());
+		const QString& value = values_[r];
+		const char16_t* data = value.utf16();
+		const int length = value.length();
+
+		//ASCII strings are copied directly (no temporary UTF-8 string)
+		bool is_ascii = true;
+		for (int i=0; i<length; ++i)
+		{
+			if (data[i]>=0x80)
+			{
+				is_ascii = false;
+				break;
+			}
+		}
+
+		if (is_ascii)
+		{
+			const int pos = output.size();
+			output.resize(pos + length);
+			char* out = output.data() + pos;
+			for (int i=0; i<length; ++i)
+			{
+				out[i] = (char)data[i];
+			}
+		}
+		else
+		{
+			output.append(value.toUtf8());
+		}
+		ends << output.size();
+	}
+}
+
+QVector<int> StringColumn::sortOrder(bool reverse) const
+{
+	const QVector<int>& ranks = sortRanks();
+
+	QVector<quint64> keys(ranks.count());
+	for (int i=0; i<ranks.count(); ++i)
+	{
+		keys[i] = ranks[i];
+	}
+
+	return RadixSort::order(keys, reverse);
+}
+
+namespace
+{
+	//Assigns dense ranks to values in sorted order (equal values get the same rank).
+	template<typename Equal>
+	QVector<int> denseRanks(const QVector<int>& order, Equal equal)
+	{
+		QVector<int> ranks(order.count());
+		int rank = -1;
+		for (int i=0; i<order.count(); ++i)
+		{
+			if (i==0 || !equal(order[i], order[i-1])) ++rank;
+			ranks[order[i]] = rank;
+		}
+		return ranks;
+	}
+}
+
+const QVector<int>& StringColumn::sortRanks() const
+{
+	if (!sort_ranks_.isEmpty() || values_.isEmpty()) return sort_ranks_;
+
+	QElapsedTimer timer;
+	timer.start();
+
+	//distinct values (sort keys are computed only once per value)
+	QHash<QString, int> unique_index;
+	QVector<QString> uniques;
+	QVector<int> row_unique(values_.count());
+	for (int r=0; r<values_.count(); ++r)
+	{
+		auto it = unique_index.constFind(values_[r]);
+		if (it==unique_index.constEnd())
+		{
+			it = unique_index.insert(values_[r], uniques.count());
+			uniques << values_[r];
+		}
+		row_unique[r] = it.value();
+	}
+
+	//sort distinct values
+	QVector<int> order(uniques.count());
+	std::iota(order.begin(), order.end(), 0);
+	QVector<int> unique_ranks;
+	if (sort_mode_==NATURAL)
+	{
+		QVector<QByteArray> keys = QtConcurrent::blockingMapped<QVector<QByteArray>>(uniques, &StringColumn::naturalSortKey);
+		const QByteArray* k = keys.constData();
+		std::sort(order.begin(), order.end(), [k](int a, int b) { return k[a] < k[b]; });
+		unique_ranks = denseRanks(order, [k](int a, int b) { return k[a] == k[b]; });
+	}
+	else if (sort_mode_==LOCALE)
+	{
+		QCollator collator;
+		std::vector<QCollatorSortKey> keys;
+		keys.reserve(uniques.count());
+		foreach(const QString& value, uniques)
+		{
+			keys.push_back(collator.sortKey(value));
+		}
+		std::sort(order.begin(), order.end(), [&keys](int a, int b) { return keys[a].compare(keys[b]) < 0; });
+		unique_ranks = denseRanks(order, [&keys](int a, int b) { return keys[a].compare(keys[b]) == 0; });
 	}
 	else
 	{
-		std::sort(values_.begin(), values_.end(), std::greater<QString>());
+		const QString* v = uniques.constData();
+		std::sort(order.begin(), order.end(), [v](int a, int b) { return v[a] < v[b]; });
+		unique_ranks = denseRanks(order, [](int a, int b) { return a == b; });
+	}
+
+	//ranks of rows
+	sort_ranks_.resize(values_.count());
+	for (int r=0; r<values_.count(); ++r)
+	{
+		sort_ranks_[r] = unique_ranks[row_unique[r]];
 	}
 
+	qDebug() << "computing string sort ranks: mode=" << sort_mode_ << "distinct=" << uniques.count() << "ms=" << timer.elapsed();
+
+	return sort_ranks_;
+}
+
+QByteArray StringColumn::naturalSortKey(const QString& value)
+{
+	//Natural part: numbers are encoded as 0x01, number of digits (without leading zeros, 2 bytes) and the digits. Other characters are encoded as 0x02 and the case-folded UTF-16 code unit (2 bytes).
+	//Numbers thus sort before text and by value. The original UTF-16 code units follow after a 0x00 separator to order strings that are equal in natural order (e.g. 'a' and 'A', '1' and '01').
+	const char16_t* data = value.utf16();
+	const int length = value.length();
+
+	QByteArray key;
+	key.reserve(5 * length + 1);
+	int i = 0;
+	while (i<length)
+	{
+		if (data[i]>='0' && data[i]<='9')
+		{
+			int end = i;
+			while (end<length && data[end]>='0' && data[end]<='9') ++end;
+			int start = i;
+			while (start<end-1 && data[start]=='0') ++start;
+			const int digits = std::min(end - start, 0xFFFF);
+			key.append((char)0x01);
+			key.append((char)(digits >> 8));
+			key.append((char)(digits & 0xFF));
+			for (int j=start; j<start+digits; ++j)
+			{
+				key.append((char)data[j]);
+			}
+			i = end;
+		}
+		else
+		{
+			const char16_t folded = QChar(data[i]).toCaseFolded().unicode();
+			key.append((char)0x02);
+			key.append((char)(folded >> 8));
+			key.append((char)(folded & 0xFF));
+			++i;
+		}
+	}
+
+	key.append((char)0x00);
+	for (int j=0; j<length; ++j)
+	{
+		key.append((char)(data[j] >> 8));
+		key.append((char)(data[j] & 0xFF));
+	}
+
+	return key;
+}
+
+void StringColumn::applyPermutation(const QVector<int>& order)
+{
+	permute(values_, order);
+	if (!sort_ranks_.isEmpty()) permute(sort_ranks_, order);
+
+	emit dataChanged();
+}
+
+void StringColumn::gather(const QVector<int>& rows)
+{
+	gatherValues(values_, rows);
+	if (!sort_ranks_.isEmpty()) gatherValues(sort_ranks_, rows);
+
 	emit dataChanged();
 }
 
@@ -32,7 +223,8 @@ void StringColumn::setFilter(Filter filter)
 		 && filter.type()!=Filter::STRING_EXACT
 		 && filter.type()!=Filter::STRING_EXACT_NOT
 		 && filter.type()!=Filter::STRING_REGEXP
-		 && filter.type()!=Filter::STRING_REGEXP_NOT)
+		 && filter.type()!=Filter::STRING_REGEXP_NOT
+		 && filter.type()!=Filter::REGION_OVERLAPS)
 	{
 		THROW(FilterTypeException,"Cannot add a non-string filter to a string column!");
 	}
@@ -42,10 +234,10 @@ void StringColumn::setFilter(Filter filter)
 	emit filterChanged();
 }
 
-void StringColumn::matchFilter(QBitArray& array) const
+void StringColumn::matchFilter(QBitArray& array, int start, int end) const
 {
 	Filter::Type type = filter().type();
-	if (type == Filter::NONE)
+	if (type == Filter::NONE || type == Filter::REGION_OVERLAPS) //region filters are applied by the dataset
 	{
 		return;
 	}
@@ -54,7 +246,7 @@ void StringColumn::matchFilter(QBitArray& array) const
 
 	if (type == Filter::STRING_EXACT)
 	{
-		for (int r=0; r<count(); ++r)
+		for (int r=start; r<end; ++r)
 		{
 			if (array[r])
 			{
@@ -64,7 +256,7 @@ void StringColumn::matchFilter(QBitArray& array) const
 	}
 	else if (type == Filter::STRING_EXACT_NOT)
 	{
-		for (int r=0; r<count(); ++r)
+		for (int r=start; r<end; ++r)
 		{
 			if (array[r])
 			{
@@ -74,7 +266,7 @@ void StringColumn::matchFilter(QBitArray& array) const
 	}
 	else if (type == Filter::STRING_CONTAINS)
 	{
-		for (int r=0; r<count(); ++r)
+		for (int r=start; r<end; ++r)
 		{
 			if (array[r])
 			{
@@ -84,7 +276,7 @@ void StringColumn::matchFilter(QBitArray& array) const
 	}
 	else if (type == Filter::STRING_CONTAINS_NOT)
 	{
-		for (int r=0; r<count(); ++r)
+		for (int r=start; r<end; ++r)
 		{
 			if (array[r])
 			{
@@ -95,7 +287,7 @@ void StringColumn::matchFilter(QBitArray& array) const
 	else if (type == Filter::STRING_REGEXP)
 	{
 		QRegularExpression regexp(value);
-		for (int r=0; r<count(); ++r)
+		for (int r=start; r<end; ++r)
 		{
 			if (array[r])
 			{
@@ -106,7 +298,7 @@ void StringColumn::matchFilter(QBitArray& array) const
 	else if (type == Filter::STRING_REGEXP_NOT)
 	{
 		QRegularExpression regexp(value);
-		for (int r=0; r<count(); ++r)
+		for (int r=start; r<end; ++r)
 		{
 			if (array[r])
 			{
@@ -12,6 +12,34 @@ class StringColumn
 public:
 	StringColumn();
 
+	///Order of strings when sorting.
+	enum SortMode
+	{
+		BINARY, //UTF-16 code unit order
+		NATURAL, //numbers are ordered by value and case is ignored, e.g. 'chr2' before 'chr10'
+		LOCALE //collation of the system locale
+	};
+	SortMode sortMode() const
+	{
+		return sort_mode_;
+	}
+	void setSortMode(SortMode mode)
+	{
+		sort_mode_ = mode;
+		sort_ranks_.clear();
+	}
+	///Returns the rank of each row in the sort order of the current sort mode (values that compare equal have the same rank).
+	///The ranks are computed from the distinct values once and cached until the data changes.
+	const QVector<int>& sortRanks() const;
+	///Returns if the sort ranks are cached, i.e. if sortRanks() returns without computation.
+	///In BINARY and NATURAL mode, the ranks are unique per value, i.e. dictionary codes of the distinct values. In LOCALE mode, distinct values that collate equal share a rank.
+	bool hasSortRanks() const
+	{
+		return !sort_ranks_.isEmpty();
+	}
+	///Returns the binary sort key for natural order, i.e. the byte-wise comparison of keys is the natural order of the strings.
+	static QByteArray naturalSortKey(const QString& value);
+
 	const QVector<QString>& values() const
 	{
 		return values_;
@@ -19,6 +47,7 @@ public:
 	void setValues(const QVector<QString>& values)
 	{
 		values_ = values;
+		sort_ranks_.clear();
 		emit dataChanged();
 	}
 	const QString& value(int row) const
@@ -30,18 +59,22 @@ public:
 	{
 		Q_ASSERT(row<values_.count());
 		values_[row] = value;
-		emit dataChanged();
+		sort_ranks_.clear();
+		emit rowsChanged(row, row+1);
 	}
 	virtual void resize(int rows)
 	{
 		values_.resize(rows);
+		sort_ranks_.clear();
 		emit dataChanged();
 	}
 	virtual void reserve(int rows)
 	{
 		values_.reserve(rows);
 	}
-	virtual void sort(bool reverse = false);
+	virtual QVector<int> sortOrder(bool reverse = false) const;
+	virtual void applyPermutation(const QVector<int>& order);
+	virtual void gather(const QVector<int>& rows);
     virtual qsizetype count() const
 	{
 		return values_.count();
@@ -56,7 +89,8 @@ public:
 	}
 
 	virtual void setFilter(Filter filter);
-	virtual void matchFilter(QBitArray& array) const;
+	using BaseColumn::matchFilter;
+	virtual void matchFilter(QBitArray& array, int start, int end) const;
 
 	// See base class
 	virtual QString string(int row) const
@@ -68,18 +102,24 @@ public:
 	{
 		Q_ASSERT(row<values_.count());
 		values_[row] = value;
-		emit dataChanged();
+		sort_ranks_.clear();
+		emit rowsChanged(row, row+1);
 	}
 	void appendString(const QString& value)
 	{
 		values_ << value;
+		sort_ranks_.clear();
 		emit dataChanged();
 	}
+	virtual void appendUtf8(int start, int end, QByteArray& output, QVector<int>& ends) const;
 
 
 protected:
 	QVector<QString> values_;
 	QString header_;
+	SortMode sort_mode_;
+	//cached sort ranks (empty if not computed or outdated)
+	mutable QVector<int> sort_ranks_;
 };
 
 #endif // STRINGCOLUMN_H
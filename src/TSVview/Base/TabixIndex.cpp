@@ -0,0 +1,285 @@
+#include "TabixIndex.h"
+#include "BgzfReader.h"
+#include "Exceptions.h"
+#include <QFile>
+#include <algorithm>
+
+namespace
+{
+	//first bin of the given level of the binning scheme
+	quint32 firstBin(int level)
+	{
+		return ((1u << (3*level)) - 1) / 7;
+	}
+}
+
+TabixIndex::TabixIndex(QString filename)
+	: filename_(indexFile(filename))
+	, is_csi_(false)
+	, min_shift_(14)
+	, depth_(5)
+	, format_(0)
+	, col_chr_(0)
+	, col_start_(1)
+	, col_end_(-1)
+	, meta_('#')
+	, skip_(0)
+	, names_()
+	, refs_()
+{
+	if (filename_.isEmpty()) THROW(FileAccessException, "No tabix index (.tbi or .csi) found for file '" + filename + "'!");
+
+	//index files are BGZF-compressed
+	BgzfReader reader(filename_);
+	parse(reader.readAll());
+}
+
+QString TabixIndex::indexFile(QString filename)
+{
+	if (QFile::exists(filename + ".tbi")) return filename + ".tbi";
+	if (QFile::exists(filename + ".csi")) return filename + ".csi";
+	return "";
+}
+
+void TabixIndex::parse(const QByteArray& data)
+{
+	QDataStream stream(data);
+	stream.setByteOrder(QDataStream::LittleEndian);
+
+	QByteArray magic(4, 0);
+	stream.readRawData(magic.data(), 4);
+	qint32 n_ref = 0;
+	if (magic=="TBI\1")
+	{
+		stream >> n_ref;
+		parseTabixHeader(stream);
+	}
+	else if (magic=="CSI\1")
+	{
+		is_csi_ = true;
+		qint32 min_shift, depth, l_aux;
+		stream >> min_shift >> depth >> l_aux;
+		if (min_shift<1 || min_shift>30 || depth<1 || depth>10 || min_shift+3*depth>62) THROW(FileParseException, "Invalid binning scheme in CSI index '" + filename_ + "'!");
+		min_shift_ = min_shift;
+		depth_ = depth;
+
+		//auxiliary data contains the tabix header (not present e.g. for BAM files)
+		if (l_aux<28) THROW(FileParseException, "CSI index '" + filename_ + "' does not contain a tabix header!");
+		QByteArray aux(l_aux, 0);
+		stream.readRawData(aux.data(), l_aux);
+		QDataStream aux_stream(aux);
+		aux_stream.setByteOrder(QDataStream::LittleEndian);
+		parseTabixHeader(aux_stream);
+
+		stream >> n_ref;
+	}
+	else
+	{
+		THROW(FileParseException, "File '" + filename_ + "' is not a tabix index (.tbi or .csi)!");
+	}
+	if (n_ref<0 || n_ref!=names_.count()) THROW(FileParseException, "Reference sequence count and name count differ in index '" + filename_ + "'!");
+
+	//bins and linear index of each reference sequence
+	const quint32 pseudo_bin = firstBin(depth_+1) + 1;
+	refs_.resize(n_ref);
+	for (int r=0; r<n_ref; ++r)
+	{
+		Reference& ref = refs_[r];
+
+		qint32 n_bin = 0;
+		stream >> n_bin;
+		for (int b=0; b<n_bin && stream.status()==QDataStream::Ok; ++b)
+		{
+			quint32 bin_nr;
+			quint64 min_offset = 0;
+			qint32 n_chunk;
+			stream >> bin_nr;
+			if (is_csi_) stream >> min_offset;
+			stream >> n_chunk;
+
+			Bin bin;
+			bin.min_offset = min_offset;
+			bin.chunks.resize(std::max(0, n_chunk));
+			for (int c=0; c<n_chunk; ++c)
+			{
+				stream >> bin.chunks[c].first >> bin.chunks[c].second;
+			}
+
+			//the pseudo-bin contains meta data only
+			if (bin_nr!=pseudo_bin) ref.bins.insert(bin_nr, bin);
+		}
+
+		if (!is_csi_)
+		{
+			qint32 n_intv = 0;
+			stream >> n_intv;
+			ref.linear.resize(std::max(0, n_intv));
+			for (int i=0; i<n_intv; ++i)
+			{
+				stream >> ref.linear[i];
+			}
+		}
+
+		if (stream.status()!=QDataStream::Ok) THROW(FileParseException, "Truncated tabix index '" + filename_ + "'!");
+	}
+}
+
+void TabixIndex::parseTabixHeader(QDataStream& stream)
+{
+	qint32 format, col_seq, col_beg, col_end, meta, skip, l_nm;
+	stream >> format >> col_seq >> col_beg >> col_end >> meta >> skip >> l_nm;
+	if (stream.status()!=QDataStream::Ok || col_seq<1 || col_beg<1 || l_nm<0) THROW(FileParseException, "Invalid tabix header in index '" + filename_ + "'!");
+
+	format_ = format;
+	col_chr_ = col_seq - 1;
+	col_start_ = col_beg - 1;
+	col_end_ = col_end - 1;
+	meta_ = (char)meta;
+	skip_ = skip;
+
+	//names are null-terminated
+	QByteArray names(l_nm, 0);
+	stream.readRawData(names.data(), l_nm);
+	if (names.endsWith('\0')) names.chop(1);
+	names_.clear();
+	if (!names.isEmpty())
+	{
+		foreach(const QByteArray& name, names.split('\0'))
+		{
+			names_ << QString::fromUtf8(name);
+		}
+	}
+}
+
+int TabixIndex::referenceIndex(const QString& chr) const
+{
+	int index = names_.indexOf(chr);
+	if (index!=-1) return index;
+
+	//'chr1' and '1' are treated the same
+	QString chr_norm = IntervalIndex::normalizeChromosome(chr);
+	for (int i=0; i<names_.count(); ++i)
+	{
+		if (IntervalIndex::normalizeChromosome(names_[i])==chr_norm) return i;
+	}
+
+	return -1;
+}
+
+QVector<TabixIndex::Chunk> TabixIndex::chunks(const GenomicRegion& region) const
+{
+	QVector<Chunk> output;
+
+	int ref_index = referenceIndex(region.chr);
+	if (ref_index==-1) return output;
+	const Reference& ref = refs_[ref_index];
+
+	//convert to 0-based, half-open coordinates and clip to the maximum coordinate of the binning scheme
+	const qint64 max_pos = 1ll << (min_shift_ + 3*depth_);
+	qint64 start = std::max(0ll, region.start - 1);
+	qint64 end = std::min(max_pos, region.end);
+	if (start>=end) return output;
+
+	//minimum offset: lines before that offset end before the region start
+	quint64 min_offset = 0;
+	if (is_csi_)
+	{
+		//smallest existing bin containing the start position
+		quint32 bin = firstBin(depth_) + (quint32)(start >> min_shift_);
+		while (bin>0 && !ref.bins.contains(bin))
+		{
+			quint32 first = (((bin-1) >> 3) << 3) + 1;
+			bin = bin>first ? bin-1 : (bin-1) >> 3;
+		}
+		if (ref.bins.contains(bin)) min_offset = ref.bins[bin].min_offset;
+	}
+	else if (!ref.linear.isEmpty())
+	{
+		qint64 window = start >> min_shift_;
+		min_offset = ref.linear[std::min(window, (qint64)ref.linear.count()-1)];
+	}
+
+	//collect chunks of all bins overlapping the region
+	qint64 last = end - 1;
+	quint32 offset = 0;
+	for (int level=0, shift=min_shift_+3*depth_; level<=depth_; ++level, shift-=3)
+	{
+		quint32 b_start = offset + (quint32)(start >> shift);
+		quint32 b_end = offset + (quint32)(last >> shift);
+		for (quint32 b=b_start; b<=b_end; ++b)
+		{
+			auto it = ref.bins.constFind(b);
+			if (it==ref.bins.constEnd()) continue;
+
+			foreach(const Chunk& chunk, it.value().chunks)
+			{
+				if (chunk.second>min_offset) output << Chunk(std::max(chunk.first, min_offset), chunk.second);
+			}
+		}
+		offset += 1u << (3*level);
+	}
+
+	//sort and merge overlapping chunks
+	std::sort(output.begin(), output.end());
+	int merged = 0;
+	for (int i=1; i<output.count(); ++i)
+	{
+		if (output[i].first<=output[merged].second)
+		{
+			output[merged].second = std::max(output[merged].second, output[i].second);
+		}
+		else
+		{
+			output[++merged] = output[i];
+		}
+	}
+	if (!output.isEmpty()) output.resize(merged+1);
+
+	return output;
+}
+
+bool TabixIndex::interval(const QList<QByteArray>& parts, qint64& start, qint64& end) const
+{
+	if (col_start_>=parts.count()) return false;
+
+	bool ok = false;
+	start = parts[col_start_].toLongLong(&ok);
+	if (!ok) return false;
+
+	//coordinates are 1-based unless the 'zero-based' flag is set (e.g. BED files)
+	const bool zero_based = format_ & 0x10000;
+	if (!zero_based) start -= 1;
+
+	end = start + 1;
+	if ((format_ & 0xFFFF)==2) //VCF: end is determined by length of the reference allele
+	{
+		if (parts.count()>3) end = start + std::max(1ll, (qint64)parts[3].size());
+	}
+	else if (col_end_>=0 && col_end_!=col_start_ && col_end_<parts.count())
+	{
+		end = parts[col_end_].toLongLong(&ok);
+		if (!ok) return false;
+		if (end<=start) end = start + 1;
+	}
+
+	return true;
+}
+
+bool TabixIndex::overlaps(const QList<QByteArray>& parts, const GenomicRegion& region) const
+{
+	if (col_chr_>=parts.count()) return false;
+	if (IntervalIndex::normalizeChromosome(QString::fromUtf8(parts[col_chr_]))!=IntervalIndex::normalizeChromosome(region.chr)) return false;
+
+	qint64 start, end;
+	if (!interval(parts, start, end)) return false;
+
+	return start<region.end && region.start-1<end;
+}
+
+bool TabixIndex::after(const QList<QByteArray>& parts, const GenomicRegion& region) const
+{
+	qint64 start, end;
+	if (!interval(parts, start, end)) return false;
+
+	return start>=region.end;
+}
@@ -0,0 +1,83 @@
+#ifndef TABIXINDEX_H
+#define TABIXINDEX_H
+
+#include "IntervalIndex.h"
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+#include <QPair>
+#include <QDataStream>
+
+/// Tabix index (.tbi or .csi) of a bgzip-compressed, coordinate-sorted TSV file.
+/// The index maps genomic bins to chunks of virtual file offsets, see the SAM/tabix specification.
+class TabixIndex
+{
+public:
+	///Chunk of virtual offsets in the BGZF file [start, end).
+	typedef QPair<quint64, quint64> Chunk;
+
+	///Loads the index of the given data file. Throws an exception if no index exists or if it cannot be parsed.
+	TabixIndex(QString filename);
+
+	///Returns the index file of the given data file ('.tbi' or '.csi'), or an empty string if there is none.
+	static QString indexFile(QString filename);
+
+	///Returns the sorted and merged chunks that contain all lines overlapping the region (1-based, closed).
+	QVector<Chunk> chunks(const GenomicRegion& region) const;
+	///Returns if a data line overlaps the region. Lines on other chromosomes or with unparsable coordinates do not overlap.
+	bool overlaps(const QList<QByteArray>& parts, const GenomicRegion& region) const;
+	///Returns if a data line starts after the region (i.e. no later line of the chromosome can overlap it).
+	bool after(const QList<QByteArray>& parts, const GenomicRegion& region) const;
+
+	///Returns the chromosome names contained in the index.
+	const QStringList& chromosomes() const
+	{
+		return names_;
+	}
+	///Returns the meta character marking header/comment lines.
+	char metaChar() const
+	{
+		return meta_;
+	}
+	///Returns the number of lines to skip at the beginning of the file.
+	int skipLines() const
+	{
+		return skip_;
+	}
+
+protected:
+	//bins of one reference sequence
+	struct Bin
+	{
+		quint64 min_offset; //CSI only
+		QVector<Chunk> chunks;
+	};
+	struct Reference
+	{
+		QHash<quint32, Bin> bins;
+		QVector<quint64> linear; //TBI only
+	};
+
+	QString filename_;
+	bool is_csi_;
+	int min_shift_;
+	int depth_;
+	int format_;
+	int col_chr_;
+	int col_start_;
+	int col_end_;
+	char meta_;
+	int skip_;
+	QStringList names_;
+	QVector<Reference> refs_;
+
+	void parse(const QByteArray& data);
+	void parseTabixHeader(QDataStream& stream);
+	//returns the index of the reference sequence, or -1 if it is not contained in the index
+	int referenceIndex(const QString& chr) const;
+	//determines the 0-based, half-open interval of a data line. Returns false if the coordinates cannot be parsed.
+	bool interval(const QList<QByteArray>& parts, qint64& start, qint64& end) const;
+};
+
+#endif // TABIXINDEX_H
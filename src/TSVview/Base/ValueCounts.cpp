@@ -0,0 +1,187 @@
+#include "ValueCounts.h"
+#include "RowKeys.h"
+#include "RadixSort.h"
+#include <QElapsedTimer>
+#include <QDebug>
+#include <QtConcurrent>
+#include <QThread>
+#include <algorithm>
+
+namespace
+{
+	//Hash table of distinct values (linear probing): slots contain the index of the entry, or -1.
+	class CountTable
+	{
+	public:
+		CountTable(const RowKeys& keys, const quint64* hashes)
+			: keys_(keys)
+			, hashes_(hashes)
+			, slots_(1024, -1)
+			, entries_()
+		{
+		}
+
+		//adds @p count rows with the value of @p row. If the value is new, @p row becomes its first row.
+		void add(int row, int count)
+		{
+			if (2 * (entries_.count() + 1) > slots_.count()) grow();
+
+			const quint64 mask = slots_.count() - 1;
+			quint64 slot = hashes_[row] & mask;
+			while (true)
+			{
+				const int e = slots_[slot];
+				if (e==-1)
+				{
+					slots_[slot] = entries_.count();
+					entries_ << ValueCounts::Entry{row, count};
+					return;
+				}
+				const int rep = entries_[e].row;
+				if (hashes_[rep]==hashes_[row] && keys_.equal(rep, row))
+				{
+					entries_[e].count += count;
+					return;
+				}
+				slot = (slot + 1) & mask;
+			}
+		}
+
+		const QVector<ValueCounts::Entry>& entries() const
+		{
+			return entries_;
+		}
+
+	protected:
+		const RowKeys& keys_;
+		const quint64* hashes_;
+		QVector<int> slots_;
+		QVector<ValueCounts::Entry> entries_;
+
+		//doubles the number of slots
+		void grow()
+		{
+			slots_.fill(-1, 2 * slots_.count());
+			const quint64 mask = slots_.count() - 1;
+			for (int e=0; e<entries_.count(); ++e)
+			{
+				quint64 slot = hashes_[entries_[e].row] & mask;
+				while (slots_[slot]!=-1) slot = (slot + 1) & mask;
+				slots_[slot] = e;
+			}
+		}
+	};
+}
+
+QVector<ValueCounts::Entry> ValueCounts::countCodes(const QVector<int>& codes, const QList<QPair<int, int>>& blocks, const QBitArray& rows)
+{
+	const int code_count = codes.isEmpty() ? 0 : *std::max_element(codes.cbegin(), codes.cend()) + 1;
+	const int* c = codes.constData();
+
+	//count per block (first row and count of each code)
+	QVector<QVector<int>> firsts(blocks.count());
+	QVector<QVector<int>> counts(blocks.count());
+	QVector<int>* f = firsts.data();
+	QVector<int>* n = counts.data();
+	QList<int> indices;
+	for (int i=0; i<blocks.count(); ++i)
+	{
+		indices << i;
+	}
+	QtConcurrent::blockingMap(indices, [&](int i)
+	{
+		QVector<int> first(code_count, -1);
+		QVector<int> count(code_count, 0);
+		for (int r=blocks[i].first; r<blocks[i].second; ++r)
+		{
+			if (!rows.isEmpty() && !rows.testBit(r)) continue;
+			if (count[c[r]]++==0) first[c[r]] = r;
+		}
+		f[i] = first;
+		n[i] = count;
+	});
+
+	//merge in block order
+	QVector<Entry> output;
+	for (int code=0; code<code_count; ++code)
+	{
+		Entry entry = {-1, 0};
+		for (int i=0; i<blocks.count(); ++i)
+		{
+			if (counts[i][code]==0) continue;
+			if (entry.row==-1) entry.row = firsts[i][code];
+			entry.count += counts[i][code];
+		}
+		if (entry.count>0) output << entry;
+	}
+	return output;
+}
+
+QVector<ValueCounts::Entry> ValueCounts::countValues(const DataSet& data, int column, const QList<QPair<int, int>>& blocks, const QBitArray& rows)
+{
+	RowKeys keys(data, QList<int>() << column);
+	const QVector<quint64> hashes = keys.hashes();
+
+	//count per block
+	QVector<QVector<Entry>> entries(blocks.count());
+	QVector<Entry>* e = entries.data();
+	QList<int> indices;
+	for (int i=0; i<blocks.count(); ++i)
+	{
+		indices << i;
+	}
+	QtConcurrent::blockingMap(indices, [&](int i)
+	{
+		CountTable table(keys, hashes.constData());
+		for (int r=blocks[i].first; r<blocks[i].second; ++r)
+		{
+			if (rows.isEmpty() || rows.testBit(r)) table.add(r, 1);
+		}
+		e[i] = table.entries();
+	});
+
+	//merge in block order (the first row of each value is thus kept)
+	if (entries.count()==1) return entries[0];
+	CountTable table(keys, hashes.constData());
+	foreach(const QVector<Entry>& block_entries, entries)
+	{
+		foreach(const Entry& entry, block_entries)
+		{
+			table.add(entry.row, entry.count);
+		}
+	}
+	return table.entries();
+}
+
+QVector<ValueCounts::Entry> ValueCounts::count(const DataSet& data, int column, const QBitArray& rows)
+{
+	QElapsedTimer timer;
+	timer.start();
+	DataSet::EvaluationScope scope(data);
+
+	//one block of rows per thread
+	const int n = data.rowCount();
+	Q_ASSERT(rows.isEmpty() || rows.count()==n);
+	const int block_count = n<RadixSort::PARALLEL_MIN ? 1 : QThread::idealThreadCount();
+	QList<QPair<int, int>> blocks;
+	for (int i=0; i<block_count; ++i)
+	{
+		blocks << qMakePair((int)((qint64)n * i / block_count), (int)((qint64)n * (i+1) / block_count));
+	}
+
+	//count
+	const BaseColumn& col = data.column(column);
+	//locale collation can rank distinct strings equal, so its ranks are not used as codes
+	const bool codes = col.type()==BaseColumn::STRING && data.stringColumn(column).sortMode()!=StringColumn::LOCALE && data.stringColumn(column).hasSortRanks();
+	QVector<Entry> output = codes ? countCodes(data.stringColumn(column).sortRanks(), blocks, rows) : countValues(data, column, blocks, rows);
+
+	//sort by count
+	std::sort(output.begin(), output.end(), [](const Entry& a, const Entry& b)
+	{
+		return a.count>b.count || (a.count==b.count && a.row<b.row);
+	});
+
+	qDebug() << "counting values: distinct=" << output.count() << "dictionary codes=" << codes << "ms=" << timer.elapsed();
+
+	return output;
+}
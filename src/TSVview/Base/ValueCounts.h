@@ -0,0 +1,29 @@
+#ifndef VALUECOUNTS_H
+#define VALUECOUNTS_H
+
+#include "DataSet.h"
+
+/// Counts of the distinct values of a column (value frequencies).
+/// Rows are counted in parallel: each thread counts a contiguous block of rows in its own hash table and the tables are merged in block order at the end.
+/// String columns with cached sort ranks (except for locale collation, which can rank distinct strings equal) use the ranks as dictionary codes, which are counted in plain arrays instead of hash tables.
+class ValueCounts
+{
+public:
+	///Distinct value: first row with the value and number of rows.
+	struct Entry
+	{
+		int row;
+		int count;
+	};
+
+	///Returns the distinct values of the rows set in @p rows (all if empty), sorted by descending count (values with the same count in the order of their first row).
+	static QVector<Entry> count(const DataSet& data, int column, const QBitArray& rows);
+
+protected:
+	//counts using the sort ranks of a string column as dictionary codes
+	static QVector<Entry> countCodes(const QVector<int>& codes, const QList<QPair<int, int>>& blocks, const QBitArray& rows);
+	//counts using hash tables of the native column values
+	static QVector<Entry> countValues(const DataSet& data, int column, const QList<QPair<int, int>>& blocks, const QBitArray& rows);
+};
+
+#endif // VALUECOUNTS_H
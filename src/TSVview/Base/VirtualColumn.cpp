@@ -0,0 +1,344 @@
+#include "VirtualColumn.h"
+#include "Exceptions.h"
+#include <QElapsedTimer>
+#include <QDebug>
+#include <algorithm>
+
+VirtualColumn::VirtualColumn(const DataSet& data, QString formula, char decimals)
+	: BaseColumn(NUMERIC)
+	, data_(data)
+	, expression_(formula, data)
+	, sources_()
+	, decimals_(decimals)
+	, rows_(data.rowCount())
+	, mutex_()
+	, blocks_()
+	, uses_(0)
+	, evaluated_()
+{
+	type_ = expression_.isString() ? STRING : NUMERIC;
+
+	//changes of the source columns clear the cache
+	foreach(int c, expression_.columns())
+	{
+		const BaseColumn& source = data.column(c);
+		if (source.isVirtual()) THROW(ArgumentException, "Virtual column '" + source.headerOrIndex(c) + "' cannot be used in the formula '" + formula + "' of another virtual column!");
+		sources_ << &source;
+		connect(&source, SIGNAL(dataChanged()), this, SLOT(sourceDataChanged()));
+		connect(&source, SIGNAL(rowsChanged(int, int)), this, SLOT(sourceRowsChanged(int, int)));
+	}
+}
+
+const BaseColumn& VirtualColumn::evaluated() const
+{
+	if (!data_.evaluating()) THROW(ProgrammingException, "Virtual column '" + header_ + "' evaluated outside of an evaluation scope!");
+
+	QSharedPointer<BaseColumn> output;
+	{
+		QMutexLocker locker(&mutex_);
+		if (evaluated_.isNull()) evaluated_.reset(evaluateAll());
+		output = evaluated_;
+	}
+
+	//the evaluation scope keeps the values until the operation is finished, even if the cache is cleared in the meantime
+	data_.keepEvaluated(output);
+
+	return *output;
+}
+
+void VirtualColumn::releaseEvaluated() const
+{
+	QMutexLocker locker(&mutex_);
+	evaluated_.clear();
+}
+
+StatisticsSummary VirtualColumn::statistics(const QBitArray& filter) const
+{
+	Q_ASSERT(type_==NUMERIC);
+	Q_ASSERT(filter.isEmpty() || filter.count()==rows_);
+
+	QMutexLocker locker(&mutex_);
+	if (!evaluated_.isNull()) return static_cast<const NumericColumn&>(*evaluated_).statistics(filter);
+	updateColumns();
+
+	//only the values of filtered rows are kept, blocks without filtered rows are skipped
+	QVector<double> values;
+	values.reserve(filter.isEmpty() ? rows_ : filter.count(true));
+	QVector<double> buffer(BLOCK_ROWS);
+	for (int start=0; start<rows_; start+=BLOCK_ROWS)
+	{
+		const int end = std::min(start + BLOCK_ROWS, rows_);
+		if (!filter.isEmpty())
+		{
+			bool any = false;
+			for (int r=start; r<end && !any; ++r)
+			{
+				any = filter.testBit(r);
+			}
+			if (!any) continue;
+		}
+
+		expression_.evaluate(data_, start, end, buffer.data());
+		for (int r=start; r<end; ++r)
+		{
+			if (filter.isEmpty() || filter.testBit(r)) values << buffer[r-start];
+		}
+	}
+
+	return basicStatistics(values);
+}
+
+QString VirtualColumn::string(int row) const
+{
+	Q_ASSERT(row<rows_);
+
+	QMutexLocker locker(&mutex_);
+	if (!evaluated_.isNull()) return evaluated_->string(row);
+	return block(row / BLOCK_ROWS).string(row % BLOCK_ROWS);
+}
+
+void VirtualColumn::setString(int /*row*/, const QString& /*value*/)
+{
+	THROW(ArgumentException, "Virtual column '" + header_ + "' cannot be edited. Materialize it first!");
+}
+
+void VirtualColumn::appendString(const QString& /*value*/)
+{
+	THROW(ArgumentException, "Virtual column '" + header_ + "' cannot be edited. Materialize it first!");
+}
+
+void VirtualColumn::appendUtf8(int start, int end, QByteArray& output, QVector<int>& ends) const
+{
+	QMutexLocker locker(&mutex_);
+	if (!evaluated_.isNull())
+	{
+		evaluated_->appendUtf8(start, end, output, ends);
+		return;
+	}
+
+	for (int b=start/BLOCK_ROWS; b*BLOCK_ROWS<end; ++b)
+	{
+		const int block_start = b * BLOCK_ROWS;
+		block(b).appendUtf8(std::max(start, block_start) - block_start, std::min(end, block_start + BLOCK_ROWS) - block_start, output, ends);
+	}
+}
+
+void VirtualColumn::resize(int rows)
+{
+	rows_ = rows;
+	invalidate();
+
+	emit dataChanged();
+}
+
+QVector<int> VirtualColumn::sortOrder(bool reverse) const
+{
+	DataSet::EvaluationScope scope(data_);
+	return evaluated().sortOrder(reverse);
+}
+
+void VirtualColumn::applyPermutation(const QVector<int>& /*order*/)
+{
+	//the source columns are reordered
+	invalidate();
+}
+
+void VirtualColumn::gather(const QVector<int>& rows)
+{
+	//the source columns are gathered
+	rows_ = rows.count();
+	invalidate();
+}
+
+BaseColumn* VirtualColumn::clone() const
+{
+	QMutexLocker locker(&mutex_);
+	BaseColumn* output = evaluated_.isNull() ? evaluateAll() : evaluated_->clone();
+	output->setHeader(header_);
+	return output;
+}
+
+void VirtualColumn::setFilter(Filter filter)
+{
+	//filter types are checked by a column of the same type
+	if (type_==STRING) StringColumn().setFilter(filter);
+	else NumericColumn().setFilter(filter);
+
+	filter_ = filter;
+
+	//the cached columns are filtered in the same way
+	{
+		QMutexLocker locker(&mutex_);
+		if (!evaluated_.isNull()) evaluated_->setFilter(filter_);
+		for (auto it=blocks_.begin(); it!=blocks_.end(); ++it)
+		{
+			it->column->setFilter(filter_);
+		}
+	}
+
+	emit filterChanged();
+}
+
+void VirtualColumn::matchFilter(QBitArray& array, int start, int end) const
+{
+	Filter::Type type = filter().type();
+	if (type == Filter::NONE || type == Filter::REGION_OVERLAPS) //region filters are applied by the dataset
+	{
+		return;
+	}
+
+	QMutexLocker locker(&mutex_);
+	if (!evaluated_.isNull())
+	{
+		evaluated_->matchFilter(array, start, end);
+		return;
+	}
+
+	//the rows of each block are checked by the filter of the block column
+	for (int b=start/BLOCK_ROWS; b*BLOCK_ROWS<end; ++b)
+	{
+		const int block_start = b * BLOCK_ROWS;
+		const int block_end = std::min(block_start + BLOCK_ROWS, rows_);
+		const int match_start = std::max(start, block_start);
+		const int match_end = std::min(end, block_end);
+
+		const BaseColumn& column = block(b);
+		QBitArray bits(block_end - block_start, true);
+		for (int r=match_start; r<match_end; ++r)
+		{
+			if (!array.testBit(r)) bits.clearBit(r - block_start);
+		}
+		column.matchFilter(bits, match_start - block_start, match_end - block_start);
+		for (int r=match_start; r<match_end; ++r)
+		{
+			if (!bits.testBit(r - block_start)) array.clearBit(r);
+		}
+	}
+}
+
+void VirtualColumn::sourceDataChanged()
+{
+	invalidate();
+
+	emit dataChanged();
+}
+
+void VirtualColumn::sourceRowsChanged(int start, int end)
+{
+	{
+		QMutexLocker locker(&mutex_);
+		for (int b=start/BLOCK_ROWS; b*BLOCK_ROWS<end; ++b)
+		{
+			blocks_.remove(b);
+		}
+		evaluated_.clear();
+	}
+
+	emit rowsChanged(start, end);
+}
+
+void VirtualColumn::updateColumns() const
+{
+	QList<int> columns = expression_.columns();
+	bool changed = false;
+	for (int i=0; i<sources_.count(); ++i)
+	{
+		if (columns[i]<data_.columnCount() && &data_.column(columns[i])==sources_[i]) continue;
+
+		columns[i] = -1;
+		for (int c=0; c<data_.columnCount(); ++c)
+		{
+			if (&data_.column(c)==sources_[i]) columns[i] = c;
+		}
+		Q_ASSERT(columns[i]!=-1); //virtual columns are materialized before their source columns are removed or replaced
+		changed = true;
+	}
+
+	if (changed) expression_.setColumns(columns);
+}
+
+BaseColumn* VirtualColumn::evaluate(int start, int end) const
+{
+	const int n = end - start;
+	BaseColumn* output;
+	if (type_==STRING)
+	{
+		QVector<QString> values(n);
+		expression_.evaluate(data_, start, end, values.data());
+		StringColumn* column = new StringColumn();
+		column->setValues(values);
+		output = column;
+	}
+	else
+	{
+		QVector<double> values(n);
+		expression_.evaluate(data_, start, end, values.data());
+		NumericColumn* column = new NumericColumn();
+		column->setValues(values, QVector<char>(n, decimals_));
+		output = column;
+	}
+	output->setFilter(filter_);
+	return output;
+}
+
+BaseColumn* VirtualColumn::evaluateAll() const
+{
+	QElapsedTimer timer;
+	timer.start();
+
+	updateColumns();
+	BaseColumn* output;
+	if (type_==STRING)
+	{
+		StringColumn* column = new StringColumn();
+		column->setValues(expression_.evaluateStrings(data_));
+		output = column;
+	}
+	else
+	{
+		QVector<double> values = expression_.evaluate(data_);
+		NumericColumn* column = new NumericColumn();
+		column->setValues(values, QVector<char>(values.count(), decimals_));
+		output = column;
+	}
+	output->setHeader(header_);
+	output->setFilter(filter_);
+
+	qDebug() << "evaluating virtual column: r=" << rows_ << "ms=" << timer.elapsed();
+
+	return output;
+}
+
+BaseColumn& VirtualColumn::block(int index) const
+{
+	auto it = blocks_.find(index);
+	if (it==blocks_.end())
+	{
+		//drop the least recently used block
+		if (blocks_.count()>=MAX_CACHED_BLOCKS)
+		{
+			auto oldest = blocks_.begin();
+			for (auto it2=blocks_.begin(); it2!=blocks_.end(); ++it2)
+			{
+				if (it2->used<oldest->used) oldest = it2;
+			}
+			blocks_.erase(oldest);
+		}
+
+		updateColumns();
+		const int start = index * BLOCK_ROWS;
+		Block entry;
+		entry.column.reset(evaluate(start, std::min(start + BLOCK_ROWS, rows_)));
+		it = blocks_.insert(index, entry);
+	}
+	it->used = ++uses_;
+
+	return *it->column;
+}
+
+void VirtualColumn::invalidate()
+{
+	QMutexLocker locker(&mutex_);
+	blocks_.clear();
+	evaluated_.clear();
+}
@@ -0,0 +1,124 @@
+#ifndef VIRTUALCOLUMN_H
+#define VIRTUALCOLUMN_H
+
+#include "BaseColumn.h"
+#include "Expression.h"
+#include "StatisticsSummary.h"
+#include <QHash>
+#include <QMutex>
+#include <QSharedPointer>
+
+/// Column whose values are computed from other columns of the dataset using a formula (see Expression) when they are needed, i.e. the values are not stored.
+/// Values are evaluated in blocks of rows, e.g. the rows shown in the grid or the rows checked by a filter. Evaluated blocks are kept in a bounded cache (least recently used blocks are dropped), which is cleared when the source columns change.
+/// Operations that need all values at once (sorting, grouping, plots, ...) use evaluated(), which evaluates the whole column. These values are only kept during a DataSet::EvaluationScope of the operation. Snapshots (and thus storing) contain the evaluated values.
+/// Virtual columns cannot be edited - they have to be materialized first (see DataSet::materializeColumn). The type is numeric or string, depending on the result of the formula.
+class VirtualColumn
+		: public BaseColumn
+{
+	Q_OBJECT
+
+public:
+	///Parses the formula. Throws an ArgumentException if the formula is invalid or uses other virtual columns. @p decimals is used for all values of numeric formulas.
+	VirtualColumn(const DataSet& data, QString formula, char decimals);
+
+	///Returns the formula.
+	const QString& formula() const
+	{
+		return expression_.formula();
+	}
+	///Returns the source columns, i.e. the columns used in the formula.
+	const QVector<const BaseColumn*>& sources() const
+	{
+		return sources_;
+	}
+	///Returns the decimals of the values (numeric formulas only).
+	char decimals() const
+	{
+		return decimals_;
+	}
+
+	virtual bool isVirtual() const
+	{
+		return true;
+	}
+	///Evaluates the whole column. The values are valid until the evaluation scope of the dataset ends. Throws a ProgrammingException if no DataSet::EvaluationScope is active.
+	virtual const BaseColumn& evaluated() const;
+	///Releases the evaluated values (called when the outermost evaluation scope of the dataset ends).
+	void releaseEvaluated() const;
+
+	///Returns statistics of the rows set in @p filter (all rows if empty). Values are evaluated block by block without caching them. Numeric formulas only.
+	StatisticsSummary statistics(const QBitArray& filter) const;
+
+	// See base class
+	virtual QString string(int row) const;
+	virtual void setString(int row, const QString& value);
+	virtual void appendString(const QString& value);
+	virtual void appendUtf8(int start, int end, QByteArray& output, QVector<int>& ends) const;
+	virtual void resize(int rows);
+	virtual void reserve(int /*rows*/)
+	{
+	}
+	virtual QVector<int> sortOrder(bool reverse=false) const;
+	virtual void applyPermutation(const QVector<int>& order);
+	virtual void gather(const QVector<int>& rows);
+	virtual qsizetype count() const
+	{
+		return rows_;
+	}
+	virtual qsizetype capacity() const
+	{
+		return rows_;
+	}
+	///Returns a copy with the evaluated values (a numeric or string column).
+	virtual BaseColumn* clone() const;
+
+	virtual void setFilter(Filter filter);
+	using BaseColumn::matchFilter;
+	virtual void matchFilter(QBitArray& array, int start, int end) const;
+
+	///Number of rows per cached block.
+	static const int BLOCK_ROWS = Expression::BLOCK_ROWS;
+	///Maximum number of cached blocks.
+	static const int MAX_CACHED_BLOCKS = 256;
+
+protected slots:
+	void sourceDataChanged();
+	void sourceRowsChanged(int start, int end);
+
+protected:
+	//evaluated block of rows
+	struct Block
+	{
+		QSharedPointer<BaseColumn> column; //values as numeric or string column
+		quint64 used; //last use (for dropping the least recently used block)
+	};
+
+	const DataSet& data_;
+	mutable Expression expression_;
+	QVector<const BaseColumn*> sources_; //source columns in the order of expression_.columns()
+	char decimals_;
+	int rows_;
+	mutable QMutex mutex_; //protects the cache (filters and exports may evaluate blocks in parallel)
+	mutable QHash<int, Block> blocks_;
+	mutable quint64 uses_;
+	mutable QSharedPointer<BaseColumn> evaluated_; //all values (during evaluation scopes, see evaluated())
+
+	//updates the column indices of the formula if columns were inserted or removed before the source columns. The mutex has to be locked.
+	void updateColumns() const;
+	//returns the rows [start, end) as numeric or string column (with the filter of this column)
+	BaseColumn* evaluate(int start, int end) const;
+	//returns all rows as numeric or string column (with the header and filter of this column). The mutex has to be locked.
+	BaseColumn* evaluateAll() const;
+	//returns the cached block with the given index, which is evaluated if necessary. The mutex has to be locked.
+	BaseColumn& block(int index) const;
+	//clears the cache
+	void invalidate();
+
+private:
+	//not implemented
+	VirtualColumn(const VirtualColumn& rhs);
+	//not implemented
+	VirtualColumn& operator=(const VirtualColumn& rhs);
+};
+
+#endif // VIRTUALCOLUMN_H
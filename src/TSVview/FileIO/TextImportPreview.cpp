@@ -124,11 +124,8 @@ void TextImportPreview::tryImport()
 	//Parse and render data
 	try
     {
-		data_.blockSignals(true);
-        data_.import(filename_, display_name_, params_, 20);
-        data_.blockSignals(false);
+        data_.import(filename_, display_name_, params_, 20); //the grid is rendered once when importing is finished
         ui_.error_message->setText("");
-        grid_->render();
         grid_->resizeColumnsToContents();
         ui_.buttonBox->button(QDialogButtonBox::Ok)->setEnabled(true);
     }
@@ -2,6 +2,8 @@
 
 #include <QMenu>
 #include <QSet>
+#include <QMessageBox>
+#include "CustomExceptions.h"
 #include "cppCORE_global.h"
 #include "Helper.h"
 
@@ -23,6 +25,12 @@ FilterDialog::FilterDialog(BaseColumn* column, QWidget* parent)
 		addOperation_(Filter::FLOAT_GREATER);
 		addOperation_(Filter::FLOAT_GREATER_EQUAL);
 	}
+	else if (column_->type() == BaseColumn::DATETIME)
+	{
+		addOperation_(Filter::DATETIME_BEFORE);
+		addOperation_(Filter::DATETIME_AFTER);
+		addOperation_(Filter::DATETIME_BETWEEN);
+	}
 	else
 	{
 		addOperation_(Filter::STRING_EXACT);
@@ -33,11 +41,22 @@ FilterDialog::FilterDialog(BaseColumn* column, QWidget* parent)
 		addOperation_(Filter::STRING_REGEXP_NOT);
 	}
 
+	//region filters can only be created from the context menu, but should remain editable
+	if (column_->filter().type() == Filter::REGION_OVERLAPS)
+	{
+		addOperation_(Filter::REGION_OVERLAPS);
+	}
+
 	//prepare dropdown list of texts
 	if (column_->type() == BaseColumn::NUMERIC)
 	{
 		ui_.text_dropdown->hide();
 	}
+	else if (column_->type() == BaseColumn::DATETIME)
+	{
+		ui_.text_dropdown->hide();
+		ui_.value->setPlaceholderText("ISO date/time, e.g. 2024-03-01 or 2024-03-01/2024-03-31");
+	}
 	else
 	{
 		ui_.text_dropdown->setMenu(new QMenu());
@@ -86,7 +105,15 @@ void FilterDialog::set_()
 	Filter filter;
 	filter.setValue(ui_.value->text());
 	filter.setType((Filter::Type)(ui_.operation->itemData(ui_.operation->currentIndex(), Qt::UserRole).toInt()));
-	column_->setFilter(filter);
+	try
+	{
+		column_->setFilter(filter);
+	}
+	catch (FilterTypeException& e)
+	{
+		QMessageBox::warning(this, "Invalid filter", e.message());
+		return;
+	}
 
 	accept();
 }
@@ -9,6 +9,7 @@
 #include <QMimeData>
 #include <QWindow>
 #include <QTextBrowser>
+#include <QtConcurrent>
 #include "MainWindow.h"
 #include "TextImportPreview.h"
 #include "StatisticsSummaryWidget.h"
@@ -19,6 +20,14 @@
 #include "ScatterPlot.h"
 #include "HistogramPlot.h"
 #include "BoxPlot.h"
+#include "TabixIndex.h"
+#include "PagedFile.h"
+#include "ArrowFile.h"
+#include "GroupBy.h"
+#include "PivotDialog.h"
+#include "Join.h"
+#include "JoinDialog.h"
+#include "VirtualColumn.h"
 #include <QStyleFactory>
 #include <QLibraryInfo>
 #include "Helper.h"
@@ -44,6 +53,16 @@ MainWindow::MainWindow(QWidget *parent)
 	info_widget_ = new QLabel("cols: 0 rows: 0");
 	statusBar()->addPermanentWidget(info_widget_);
 
+	//create progress bar for storing in the background
+	store_progress_ = new QProgressBar();
+	store_progress_->setRange(0, 100);
+	store_progress_->setMaximumWidth(150);
+	store_progress_->setFormat("saving %p%");
+	store_progress_->setVisible(false);
+	statusBar()->addPermanentWidget(store_progress_);
+	connect(&store_.watcher, SIGNAL(finished()), this, SLOT(storeFinished()));
+	ui_.compressBinaryFiles->setChecked(Settings::contains("compress_binary_files") && Settings::boolean("compress_binary_files"));
+
 	//create grid and dataset
 	connect(ui_.grid, SIGNAL(customContextMenuRequested(QPoint)), this, SLOT(tableContextMenu(QPoint)));
 	connect(ui_.grid, SIGNAL(rendered()), this, SLOT(updateInfoWidget()));
@@ -81,6 +100,15 @@ MainWindow::MainWindow(QWidget *parent)
 	connect(filter_widget_, SIGNAL(storeFilter()), ui_.grid, SLOT(storeFilter()));
 	connect(filter_widget_, SIGNAL(deleteFilter()), ui_.grid, SLOT(deleteFilter()));
 
+	//create value counts widget (updated when the data or the filters change)
+	value_counts_widget_ = new ValueCountsWidget();
+	value_counts_widget_->setVisible(false);
+	addDockWidget(Qt::RightDockWidgetArea, value_counts_widget_);
+	connect(value_counts_widget_, SIGNAL(filterValue(int, QString)), ui_.grid, SLOT(filterValue(int, QString)));
+	connect(&data_, SIGNAL(dataChanged()), this, SLOT(updateValueCounts()));
+	connect(&data_, SIGNAL(rowsChanged(int, int, int)), this, SLOT(updateValueCounts()));
+	connect(&data_, SIGNAL(filtersChanged()), this, SLOT(updateValueCounts()));
+
 	//enable drop event
 	setAcceptDrops(true);
 
@@ -91,8 +119,8 @@ MainWindow::MainWindow(QWidget *parent)
 
 void MainWindow::delayedInitialization()
 {
-	//load argument file
-	if (QApplication::arguments().count()==2)
+	//load argument file (not for windows that already show data, e.g. group-by results)
+	if (QApplication::arguments().count()==2 && data_.columnCount()==0)
 	{
 		QString filename = QApplication::arguments().at(1);
 		openFile_(filename);
@@ -110,6 +138,9 @@ void MainWindow::closeEvent(QCloseEvent* event)
 
 void MainWindow::storeModifiedDataset_()
 {
+	//the dataset is replaced after this call > wait until the data is stored
+	waitForStore_();
+
     if (data_.modified() && data_.columnCount()!=0)
 	{
 		QMessageBox box(this);
@@ -120,7 +151,143 @@ void MainWindow::storeModifiedDataset_()
 		if (box.exec() == QMessageBox::Yes)
 		{
 			on_saveFile_triggered(true);
+			waitForStore_();
+		}
+	}
+}
+
+void MainWindow::store_(QString filename)
+{
+	//only one store operation at a time
+	waitForStore_();
+
+	//disable file watcher (re-enabled when storing is finished)
+	file_watcher_.clearFile();
+
+	//take snapshot of the data (editing is possible while storing)
+	store_.snapshot = data_.snapshot();
+	store_.filename = filename;
+	store_.version = data_.version();
+	store_.is_export = false;
+
+	//store in background
+	store_progress_->setValue(0);
+	store_progress_->setVisible(true);
+	connect(store_.snapshot.data(), SIGNAL(storeProgress(int)), store_progress_, SLOT(setValue(int)));
+	DataSet* snapshot = store_.snapshot.data();
+	QList<int> widths = ui_.grid->columnWidths();
+	int level = compressionLevel_();
+	if (filename.endsWith(".tsvb", Qt::CaseInsensitive) && !ui_.compressBinaryFiles->isChecked()) level = 0;
+	store_.watcher.setFuture(QtConcurrent::run([snapshot, filename, widths, level]() -> QString
+	{
+		try
+		{
+			snapshot->store(filename, widths, level);
+		}
+		catch (Exception& e)
+		{
+			return e.message();
+		}
+		return QString();
+	}));
+}
+
+void MainWindow::export_(QString filename, ExportFormat format)
+{
+	//only one store operation at a time
+	waitForStore_();
+
+	//rows/columns to export (empty means all)
+	QBitArray rows;
+	QBitArray cols;
+	//subsets of rows are not supported for Arrow files
+	bool filtered = format!=ExportFormat::ARROW && data_.filtersEnabled() && data_.filtersPresent();
+	QList<int> selected = ui_.grid->selectedColumns();
+	if (filtered || !selected.isEmpty())
+	{
+		QString what = filtered && !selected.isEmpty() ? "filtered rows and selected columns" : (filtered ? "filtered rows" : "selected columns");
+		if (QMessageBox::question(this, "Export", "Export only " + what + "?")==QMessageBox::Yes)
+		{
+			if (filtered) rows = data_.getRowFilter();
+			if (!selected.isEmpty())
+			{
+				cols.fill(false, data_.columnCount());
+				foreach(int c, selected)
+				{
+					cols.setBit(c);
+				}
+			}
+		}
+	}
+
+	//take snapshot of the data
+	store_.snapshot = data_.snapshot();
+	store_.filename = filename;
+	store_.version = data_.version();
+	store_.is_export = true;
+
+	//export in background
+	store_progress_->setValue(0);
+	store_progress_->setVisible(true);
+	connect(store_.snapshot.data(), SIGNAL(storeProgress(int)), store_progress_, SLOT(setValue(int)));
+	DataSet* snapshot = store_.snapshot.data();
+	store_.watcher.setFuture(QtConcurrent::run([snapshot, filename, format, rows, cols]() -> QString
+	{
+		try
+		{
+			snapshot->storeAs(filename, format, rows, cols);
+		}
+		catch (Exception& e)
+		{
+			return e.message();
 		}
+		return QString();
+	}));
+}
+
+void MainWindow::waitForStore_()
+{
+	if (store_.watcher.isRunning())
+	{
+		QApplication::setOverrideCursor(Qt::BusyCursor);
+		store_.watcher.waitForFinished();
+		QApplication::restoreOverrideCursor();
+	}
+
+	//handle result now (the 'finished' signal is delivered later)
+	storeFinished();
+}
+
+void MainWindow::storeFinished()
+{
+	//already handled
+	if (store_.snapshot.isNull()) return;
+
+	store_progress_->setVisible(false);
+	store_.snapshot.clear();
+
+	QString error = store_.watcher.result();
+	if (store_.is_export)
+	{
+		if (!error.isEmpty()) QMessageBox::warning(this, "Error exporting file '" + store_.filename + "'", error);
+		return;
+	}
+	if (!error.isEmpty())
+	{
+		QMessageBox::warning(this, "Error storing file '" + store_.filename + "'", error);
+
+		//re-enable file watcher
+		if (!filename_.isEmpty()) file_watcher_.setFile(filename_);
+		return;
+	}
+
+	//update name (and add to recent files)
+	setFile(store_.filename);
+
+	//data is unmodified only if it was not changed while storing
+	if (data_.version()==store_.version)
+	{
+		data_.setModified(false);
 	}
 }
 
@@ -131,7 +298,9 @@ void MainWindow::datasetStatusChanged(bool /*modified*/)
 
 void MainWindow::updateWindowTitle_()
 {
-    QString title = QApplication::applicationName() + " - " + (filename_.isEmpty() ? "untitled" : filename_);
+    QString name = filename_;
+    if (name.isEmpty()) name = data_.subset().isEmpty() ? "untitled" : data_.subset();
+    QString title = QApplication::applicationName() + " - " + name;
 	if (data_.modified())
 	{
 		title += "*";
@@ -151,12 +320,46 @@ void MainWindow::on_openTsvFile_triggered(bool)
 {
 	storeModifiedDataset_();
 
-    QString filename = QFileDialog::getOpenFileName(this, "Open TSV file", Settings::path("path_open", true), "TSV files (*.tsv *.tsv.gz)");
+    QString filename = QFileDialog::getOpenFileName(this, "Open TSV file", Settings::path("path_open", true), "TSV files (*.tsv *.tsv.gz *.tsvb);;Arrow files (*.arrow *.feather)");
     if (filename.isEmpty()) return;
 
 	openFile_(filename);
 }
 
+void MainWindow::on_openTsvRegion_triggered(bool)
+{
+	storeModifiedDataset_();
+
+	QString filename = QFileDialog::getOpenFileName(this, "Open region of indexed TSV file", Settings::path("path_open", true), "Indexed TSV files (*.tsv.gz *.bgz *.gz);;All files (*.*)");
+	if (filename.isEmpty()) return;
+
+	if (TabixIndex::indexFile(filename).isEmpty())
+	{
+		QMessageBox::warning(this, "Open region", "No tabix index (.tbi or .csi) found for file '" + filename + "'!");
+		return;
+	}
+
+	bool ok = true;
+	QString region = QInputDialog::getText(this, "Open region", "Region (chr:start-end):", QLineEdit::Normal, "", &ok).trimmed();
+	if (!ok || region.isEmpty()) return;
+
+	openFile_(filename, true, false, region);
+}
+
+void MainWindow::on_openTsvSample_triggered(bool)
+{
+	storeModifiedDataset_();
+
+	QString filename = QFileDialog::getOpenFileName(this, "Open sample of TSV file", Settings::path("path_open", true), "TSV files (*.tsv *.tsv.gz)");
+	if (filename.isEmpty()) return;
+
+	bool ok = true;
+	int rows = QInputDialog::getInt(this, "Open sample", "Number of rows:", 10000, 1, 100000000, 1000, &ok);
+	if (!ok) return;
+
+	openFile_(filename, true, false, "", rows);
+}
+
 void MainWindow::on_actionImportTxtFile_triggered(bool)
 {
     storeModifiedDataset_();
@@ -167,7 +370,7 @@ void MainWindow::on_actionImportTxtFile_triggered(bool)
     openFile_(filename, true, true);
 }
 
-void MainWindow::openFile_(QString filename, bool remember_path, bool show_import_dialog)
+void MainWindow::openFile_(QString filename, bool remember_path, bool show_import_dialog, QString region, int sample_rows)
 {
 	//close plots
 	QWindowList windows = QApplication::allWindows();
@@ -189,14 +392,54 @@ void MainWindow::openFile_(QString filename, bool remember_path, bool show_impor
 	if (!isTsv(filename)) show_import_dialog = true;
 
 	//try to load data if no import dialog shall be shown. If loading fails, show import dialog anyway.
-	data_.blockSignals(true);
+	data_.beginUpdate();
 	QHash<int, ColumnInfo> col_infos;
-	if (!show_import_dialog) //try loading
+	if (!region.isEmpty()) //load region of indexed file (the file name is not set to avoid overwriting the complete file)
+	{
+		try
+		{
+			col_infos = data_.loadRegion(filename, region, filename);
+		}
+		catch (Exception& e)
+		{
+			data_.clear(true);
+			QMessageBox::warning(this, "Error loading region.", e.message());
+		}
+		updateWindowTitle_();
+	}
+	else if (sample_rows>0) //load sample of file (the file name is not set to avoid overwriting the complete file)
+	{
+		QApplication::setOverrideCursor(Qt::BusyCursor);
+		QString error;
+		try
+		{
+			col_infos = data_.loadSample(filename, sample_rows, filename);
+		}
+		catch (Exception& e)
+		{
+			data_.clear(true);
+			error = e.message();
+		}
+		QApplication::restoreOverrideCursor();
+		if (!error.isEmpty()) QMessageBox::warning(this, "Error loading sample.", error);
+		updateWindowTitle_();
+	}
+	else if (!show_import_dialog) //try loading
 	{
 		try
 		{
-			col_infos = data_.load(filename, filename);
-			setFile(filename);
+			qint64 budget = (qint64)memoryBudget_() * 1024 * 1024;
+			if (PagedFile::estimatedMemory(filename)>budget && PagedFile::isSupported(filename) && !DataSet::isBinary(filename) && !ArrowFile::isArrow(filename)) //paged mode (the file name is not set to avoid overwriting the complete file with one page)
+			{
+				col_infos = data_.loadPaged(filename, budget/4);
+				addToRecentFiles_(filename);
+				updateWindowTitle_();
+			}
+			else
+			{
+				col_infos = data_.load(filename, filename);
+				setFile(filename);
+			}
 		}
 		catch (Exception& e)
 		{
@@ -222,9 +465,8 @@ void MainWindow::openFile_(QString filename, bool remember_path, bool show_impor
 		}
 	}
 
-	//update GUI
-	updateFilters();
-    ui_.grid->render();
+	//update GUI (the changes collected while loading are emitted)
+	data_.endUpdate();
 
     //resize
     bool col_widths_from_file_used = false;
@@ -242,9 +484,6 @@ void MainWindow::openFile_(QString filename, bool remember_path, bool show_impor
 		ui_.grid->resizeColumnWidth();
 		ui_.grid->resizeColumnHeight(true);
     }
-
-	//re-enable data signals
-    data_.blockSignals(false);
 }
 
 void MainWindow::on_saveFile_triggered(bool)
@@ -252,43 +491,25 @@ void MainWindow::on_saveFile_triggered(bool)
     //no filename > get it from the user
     if (filename_.isEmpty())
     {
-        QString filename = QFileDialog::getSaveFileName(this, "Save file", Settings::path("path_open", true) + filename_, "TSV files (*.tsv *.tsv.gz)");
+        QString filename = QFileDialog::getSaveFileName(this, "Save file", Settings::path("path_open", true) + filename_, "TSV files (*.tsv *.tsv.gz);;Binary TSV files (*.tsvb)");
         if (filename.isEmpty()) return;
 
         filename_ = filename;
         Settings::setPath("path_open", filename_);
 	}
 
-    //disable file watcher
-    file_watcher_.clearFile();
-
     //store
-	try
-	{
-        data_.store(filename_, ui_.grid->columnWidths());
-	}
-    catch (FileAccessException& e)
-	{
-        QMessageBox::warning(this, "Error storing file '"+filename_ + "'", e.message());
-	}
-
-    //update name (and add to recent files)
-    setFile(filename_);
-
-	//re-enable file watcher
-    file_watcher_.setFile(filename_);
-
-	data_.setModified(false);
+    store_(filename_);
 }
 
 void MainWindow::on_actionSaveAs_triggered(bool)
 {
     if (data_.columnCount()==0) return;
 
-    QString filename = QFileDialog::getSaveFileName(this, "Save as",  filename_, "TSV files (*.tsv *.tsv.gz);;All files (*.*)");
-    data_.store(filename, ui_.grid->columnWidths());
-    setFile(filename);
-	data_.setModified(false);
+    QString filename = QFileDialog::getSaveFileName(this, "Save as",  filename_, "TSV files (*.tsv *.tsv.gz);;Binary TSV files (*.tsvb);;All files (*.*)");
+    if (filename.isEmpty()) return;
+
+    store_(filename);
 }
 
 void MainWindow::on_actionExportHTML_triggered(bool)
@@ -296,7 +517,9 @@ void MainWindow::on_actionExportHTML_triggered(bool)
     if (data_.columnCount()==0) return;
 
     QString filename = QFileDialog::getSaveFileName(this, "Export as HTML",  filename_+".html", "HTML files (*.html);;All files (*.*)");
-    data_.storeAs(filename, ExportFormat::HTML);
+    if (filename.isEmpty()) return;
+
+    export_(filename, ExportFormat::HTML);
 }
 
 void MainWindow::on_actionExportCSV_triggered(bool)
@@ -304,7 +527,19 @@ void MainWindow::on_actionExportCSV_triggered(bool)
     if (data_.columnCount()==0) return;
 
     QString filename = QFileDialog::getSaveFileName(this, "Export as CSV",  filename_+".csv", "CSV files (*.csv);;All files (*.*)");
-    data_.storeAs(filename, ExportFormat::CSV);
+    if (filename.isEmpty()) return;
+
+    export_(filename, ExportFormat::CSV);
+}
+
+void MainWindow::on_actionExportArrow_triggered(bool)
+{
+    if (data_.columnCount()==0) return;
+
+    QString filename = QFileDialog::getSaveFileName(this, "Export as Arrow",  filename_+".arrow", "Arrow files (*.arrow *.feather);;All files (*.*)");
+    if (filename.isEmpty()) return;
+
+    export_(filename, ExportFormat::ARROW);
 }
 
 void  MainWindow::on_resizeColumnWidth_triggered(bool)
@@ -336,6 +571,147 @@ void  MainWindow::on_goToRow_triggered(bool)
 	goto_widget_->setFocus();
 }
 
+void MainWindow::on_goToRegion_triggered(bool)
+{
+	if (data_.columnCount()==0) return;
+
+	//determine chromosome, start and end column (selected or guessed from headers)
+	int chr_col = -1;
+	int start_col = -1;
+	int end_col = -1;
+	QList<int> selected = ui_.grid->selectedColumns();
+	if (ui_.grid->selectionInfo().isColumnSelection && selected.count()==3)
+	{
+		chr_col = selected[0];
+		start_col = selected[1];
+		end_col = selected[2];
+	}
+	else if (!IntervalIndex::guessColumns(data_, chr_col, start_col, end_col))
+	{
+		QMessageBox::warning(this, "Go to region", "Could not determine chromosome, start and end column.\nPlease select the three columns and try again.");
+		return;
+	}
+	if (data_.column(start_col).type()!=BaseColumn::NUMERIC || data_.column(end_col).type()!=BaseColumn::NUMERIC)
+	{
+		QMessageBox::warning(this, "Go to region", "Start and end column have to be numeric!");
+		return;
+	}
+
+	//get region
+	bool ok = true;
+	QString text = QInputDialog::getText(this, "Go to region", "Region (chr:start-end):", QLineEdit::Normal, "", &ok);
+	if (!ok || text.trimmed().isEmpty()) return;
+
+	try
+	{
+		GenomicRegion region = IntervalIndex::parseRegion(text);
+		int row = data_.intervalIndex(chr_col, start_col, end_col).firstOverlapping(region);
+		if (row==-1)
+		{
+			statusBar()->showMessage("No row overlaps region '" + text + "'!", 5000);
+			return;
+		}
+
+		//convert to row index of the grid (filters and display order)
+		int grid_row = ui_.grid->gridRow(row);
+		if (grid_row==-1)
+		{
+			statusBar()->showMessage("The first row overlapping region '" + text + "' is hidden by filters!", 5000);
+			return;
+		}
+
+		//paged mode: row index of the whole file
+		if (data_.isPaged()) grid_row += data_.page() * DataSet::PAGE_ROWS;
+
+		goToRow(grid_row+1);
+	}
+	catch (Exception& e)
+	{
+		QMessageBox::warning(this, "Go to region", e.message());
+	}
+}
+
+void MainWindow::on_previousPage_triggered(bool)
+{
+	showPage_(data_.page()-1);
+}
+
+void MainWindow::on_nextPage_triggered(bool)
+{
+	showPage_(data_.page()+1);
+}
+
+void MainWindow::showPage_(int page)
+{
+	if (!data_.isPaged() || page<0 || page>=data_.pageCount() || page==data_.page()) return;
+
+	if (data_.modified())
+	{
+		QMessageBox::StandardButton button = QMessageBox::question(this, "Change page", "Changes of the current page are lost when changing the page.\nDo you want to continue?", QMessageBox::Yes|QMessageBox::No, QMessageBox::No);
+		if (button!=QMessageBox::Yes) return;
+	}
+
+	//load page (keep column widths)
+	QList<int> widths = ui_.grid->columnWidths();
+	data_.beginUpdate();
+	try
+	{
+		data_.loadPage(page);
+	}
+	catch (Exception& e)
+	{
+		QMessageBox::warning(this, "Error loading page.", e.message());
+	}
+
+	//update GUI
+	data_.endUpdate();
+	if (widths.count()==data_.columnCount())
+	{
+		for (int c=0; c<widths.count(); ++c)
+		{
+			ui_.grid->setColumnWidth(c, widths[c]);
+		}
+	}
+	updateWindowTitle_();
+}
+
+int MainWindow::memoryBudget_()
+{
+	if (Settings::contains("memory_budget")) return Settings::integer("memory_budget");
+
+	return 4096;
+}
+
+void MainWindow::on_memoryBudget_triggered(bool)
+{
+	bool ok = true;
+	int budget = QInputDialog::getInt(this, "Memory budget", "Files that need more memory (MB) are opened in paged mode:", memoryBudget_(), 64, 1024*1024, 256, &ok);
+	if (!ok) return;
+
+	Settings::setInteger("memory_budget", budget);
+}
+
+int MainWindow::compressionLevel_()
+{
+	if (Settings::contains("compression_level")) return Settings::integer("compression_level");
+
+	return 6;
+}
+
+void MainWindow::on_compressionLevel_triggered(bool)
+{
+	bool ok = true;
+	int level = QInputDialog::getInt(this, "Compression level", "Compression level for saving GZ files (1=fastest, 9=smallest):", compressionLevel_(), 1, 9, 1, &ok);
+	if (!ok) return;
+
+	Settings::setInteger("compression_level", level);
+}
+
+void MainWindow::on_compressBinaryFiles_triggered(bool checked)
+{
+	Settings::setBoolean("compress_binary_files", checked);
+}
+
 void  MainWindow::on_findText_triggered(bool)
 {
 	if(!find_widget_->isHidden())
@@ -420,6 +796,10 @@ void MainWindow::on_transpose_triggered(bool /*checked*/)
 		}
 	}
 
+	//rows are transposed in display order
+	DataSet::UpdateGuard update(data_);
+	data_.applyRowOrder();
+
 	//create new header column
 	QString header_col_header = data_.column(0).header();
 	QVector<QString> header_col;
@@ -437,23 +817,31 @@ void MainWindow::on_transpose_triggered(bool /*checked*/)
         headers << data_.column(0).string(r);
 	}
 
-	//create new data columns
+	//create new data columns (virtual columns are evaluated)
 	QVector< QVector<double> > cols;
     QVector< QVector<char> > decimals;
 	cols.reserve(data_.rowCount());
-	for (int r=0; r<data_.rowCount(); ++r)
 	{
-		QVector<double> col;
-        col.reserve(col_count);
-        QVector<char> dec;
-        dec.reserve(col_count);
-        for (int c=1; c<col_count; ++c)
+		DataSet::EvaluationScope scope(data_);
+		QList<const NumericColumn*> numeric_cols;
+		for (int c=1; c<col_count; ++c)
 		{
-            col << data_.numericColumn(c).value(r);
-            dec << data_.numericColumn(c).decimals(r);
+			numeric_cols << &static_cast<const DataSet&>(data_).numericColumn(c);
+		}
+		for (int r=0; r<data_.rowCount(); ++r)
+		{
+			QVector<double> col;
+			col.reserve(col_count);
+			QVector<char> dec;
+			dec.reserve(col_count);
+			foreach(const NumericColumn* numeric_col, numeric_cols)
+			{
+				col << numeric_col->value(r);
+				dec << numeric_col->decimals(r);
+			}
+			cols << col;
+			decimals << dec;
 		}
-        cols << col;
-        decimals << dec;
 	}
 
 	//update dataset and GUI
@@ -461,11 +849,8 @@ void MainWindow::on_transpose_triggered(bool /*checked*/)
 	data_.addColumn(header_col_header, header_col);
 	for (int c=0; c<cols.count(); ++c)
 	{
-		data_.blockSignals(true);
         data_.addColumn(headers[c], cols[c], decimals[c]);
-		data_.blockSignals(false);
 	}
-	ui_.grid->render();
 }
 
 void MainWindow::on_grep_triggered(bool /*checked*/)
@@ -484,9 +869,11 @@ void MainWindow::tableContextMenu(QPoint point)
 		QList<int> selected = ui_.grid->selectedColumns();
 		int selected_count = selected.size();
 		int text_count = 0;
+		int datetime_count = 0;
 		for (int i=0; i<selected.size(); ++i)
 		{
 			text_count += (data_.column(selected[i]).type()==BaseColumn::STRING);
+			datetime_count += (data_.column(selected[i]).type()==BaseColumn::DATETIME);
 		}
 
 		//separator
@@ -494,23 +881,35 @@ void MainWindow::tableContextMenu(QPoint point)
 
 		//statistics
 		QAction* action = main_menu->addAction("Basic statistics", this, SLOT(basicStatistics()));
-		action->setEnabled(selected_count==1 && text_count==0);
+		action->setEnabled(selected_count==1 && text_count==0 && datetime_count==0);
 
-		//plots
+		//plots (date/time columns are used as X axis)
 		QMenu* menu = main_menu->addMenu("Plots");
 		menu->setEnabled(selected_count>0 && text_count==0);
 		action = menu->addAction(QIcon(":/Icons/Histogram.png"), "Histogram", this, SLOT(histogram()));
-		action->setEnabled(selected_count==1);
+		action->setEnabled(selected_count==1 && datetime_count==0);
 		action = menu->addAction(QIcon(":/Icons/Scatterplot.png"), "Scatter plot", this, SLOT(scatterPlot()));
 		action->setEnabled(selected_count==2);
 		action = menu->addAction(QIcon(":/Icons/Lineplot.png"), "Plot", this, SLOT(dataPlot()));
-		action->setEnabled(selected_count>0);
+		action->setEnabled(selected_count>datetime_count && datetime_count<=1);
 		action = menu->addAction(QIcon(":/Icons/Boxplot.png"), "Box plot", this, SLOT(boxPlot()));
+		action->setEnabled(selected_count>0 && datetime_count==0);
+
+		//value counts
+		action = main_menu->addAction("Value counts", this, SLOT(valueCounts()));
+		action->setEnabled(selected_count==1);
+
+		//group-by
+		action = main_menu->addAction("Group by / pivot table...", this, SLOT(groupBy()));
 		action->setEnabled(selected_count>0);
 
+		//join
+		action = main_menu->addAction("Join with file...", this, SLOT(joinWithFile()));
+		action->setEnabled(selected_count>0 && !data_.isPaged());
+
 		//signal processing
         menu = main_menu->addMenu("Smoothing");
-		menu->setEnabled(selected_count==1 && text_count==0);
+		menu->setEnabled(selected_count==1 && text_count==0 && datetime_count==0);
 		menu->addAction("Moving average", this, SLOT(smoothAverage()));
 		menu->addAction("Moving median", this, SLOT(smoothMedian()));
 		menu->addAction("Savitzky-Golay", this, SLOT(smoothSavitzkyGolay()));
@@ -521,6 +920,95 @@ void MainWindow::tableContextMenu(QPoint point)
 	delete main_menu;
 }
 
+void MainWindow::groupBy()
+{
+	PivotDialog dlg(data_.headers(), ui_.grid->selectedColumns(), this);
+	if (!dlg.exec()) return;
+
+	//aggregate filtered rows, the result is shown in a new window
+	MainWindow* window = new MainWindow();
+	window->setAttribute(Qt::WA_DeleteOnClose);
+	QApplication::setOverrideCursor(Qt::BusyCursor);
+	try
+	{
+		GroupBy::run(data_, dlg.keys(), dlg.pivotColumn(), dlg.aggregations(), data_.getRowFilter(), window->data_);
+	}
+	catch (Exception& e)
+	{
+		QApplication::restoreOverrideCursor();
+		QMessageBox::warning(this, "Group by", e.message());
+		delete window;
+		return;
+	}
+	QApplication::restoreOverrideCursor();
+
+	window->show();
+}
+
+void MainWindow::valueCounts()
+{
+	value_counts_widget_->setColumn(data_, ui_.grid->selectedColumns()[0]);
+}
+
+void MainWindow::updateValueCounts()
+{
+	value_counts_widget_->renderCounts(data_);
+}
+
+void MainWindow::joinWithFile()
+{
+	QString filename = QFileDialog::getOpenFileName(this, "Join with file", Settings::path("path_open", true), "TSV files (*.tsv *.tsv.gz *.tsvb);;Arrow files (*.arrow *.feather)");
+	if (filename.isEmpty()) return;
+
+	QStringList other_headers;
+	try
+	{
+		other_headers = DataSet::fileHeaders(filename);
+	}
+	catch (Exception& e)
+	{
+		QMessageBox::warning(this, "Join with file", e.message());
+		return;
+	}
+
+	JoinDialog dlg(data_.headers(), ui_.grid->selectedColumns(), other_headers, this);
+	if (!dlg.exec()) return;
+
+	//load only the key columns and the appended columns of the other file
+	QStringList names;
+	foreach(int c, dlg.otherKeys() + dlg.columns())
+	{
+		if (!names.contains(other_headers[c])) names << other_headers[c];
+	}
+
+	QApplication::setOverrideCursor(Qt::BusyCursor);
+	try
+	{
+		DataSet other;
+		other.load(filename, "", names);
+
+		QList<int> other_keys;
+		foreach(int c, dlg.otherKeys())
+		{
+			other_keys << other.indexOf(other_headers[c]);
+		}
+		QList<int> columns;
+		foreach(int c, dlg.columns())
+		{
+			columns << other.indexOf(other_headers[c]);
+		}
+
+		Join::run(data_, dlg.keys(), other, other_keys, columns, dlg.type());
+	}
+	catch (Exception& e)
+	{
+		QApplication::restoreOverrideCursor();
+		QMessageBox::warning(this, "Join with file", e.message());
+		return;
+	}
+	QApplication::restoreOverrideCursor();
+}
+
 void MainWindow::smoothAverage()
 {
 	smooth_(Smoothing::MovingAverage, "_ma");
@@ -546,11 +1034,14 @@ void MainWindow::smooth_(Smoothing::Type type, QString suffix)
 
 	int index = ui_.grid->selectedColumns().at(0);
 	QString header = data_.column(index).header();
-	QVector<double> dataset = data_.numericColumn(index).values();
+	DataSet::EvaluationScope scope(data_);
+	const NumericColumn& column = static_cast<const DataSet&>(data_).numericColumn(index);
+	QVector<double> dataset = column.values();
+	QVector<char> decimals = column.decimals();
 
 	Smoothing::smooth(dataset, type, params);
 
-    data_.addColumn(header + suffix, dataset, data_.numericColumn(index).decimals());
+    data_.addColumn(header + suffix, dataset, decimals);
 }
 
 QString MainWindow::fileNameLabel()
@@ -578,8 +1069,34 @@ void MainWindow::basicStatistics()
 	int index = ui_.grid->selectedColumns().at(0);
 
 	StatisticsSummaryWidget* stats = new StatisticsSummaryWidget();
-	stats->setData(data_.numericColumn(index).statistics(data_.getRowFilter()));
-	auto dlg = GUIHelper::createDialog(stats, "Basic statistics of '" + data_.column(index).headerOrIndex(index) + fileNameLabel());
+	QString title = "Basic statistics of '" + data_.column(index).headerOrIndex(index) + fileNameLabel();
+	if (data_.isPaged()) //paged mode: statistics of all rows of the file
+	{
+		QApplication::setOverrideCursor(Qt::BusyCursor);
+		int skipped = 0;
+		try
+		{
+			stats->setData(::basicStatistics(data_.fileColumnValues(index, skipped)));
+		}
+		catch (Exception& e)
+		{
+			QApplication::restoreOverrideCursor();
+			QMessageBox::warning(this, "Basic statistics", e.message());
+			delete stats;
+			return;
+		}
+		QApplication::restoreOverrideCursor();
+		if (skipped>0) QMessageBox::warning(this, "Basic statistics", QString::number(skipped) + " rows were skipped because the filters are not applicable to them (different column type).");
+		title += " - all pages";
+	}
+	else
+	{
+		//virtual columns are evaluated block by block
+		const BaseColumn& column = data_.column(index);
+		if (column.isVirtual()) stats->setData(static_cast<const VirtualColumn&>(column).statistics(data_.getRowFilter()));
+		else stats->setData(data_.numericColumn(index).statistics(data_.getRowFilter()));
+	}
+	auto dlg = GUIHelper::createDialog(stats, title);
 	dlg->exec();
 }
 
@@ -760,6 +1277,13 @@ void MainWindow::keyPressEvent(QKeyEvent* e)
 
 void MainWindow::goToRow(int row)
 {
+	//paged mode: row index refers to the whole file
+	if (data_.isPaged() && row>0)
+	{
+		showPage_((row-1) / DataSet::PAGE_ROWS);
+		row -= data_.page() * DataSet::PAGE_ROWS;
+	}
+
 	row -= 1;
 
 	// abort if not found
@@ -869,7 +1393,18 @@ void MainWindow::updateInfoWidget()
 		filter_info = " (of " + QString::number(data_.rowCount()) + ")";
 	}
 
-	info_widget_->setText("cols: " + QString::number(data_.columnCount()) + " rows: " + QString::number(ui_.grid->rowCount()) + filter_info);
+	QString page_info;
+	if (data_.isPaged())
+	{
+		page_info = " page: " + QString::number(data_.page()+1) + "/" + QString::number(data_.pageCount()) + " (" + QString::number(data_.fileRowCount()) + " rows)";
+	}
+
+	if (data_.isSample())
+	{
+		page_info = " (random sample)";
+	}
+
+	info_widget_->setText("cols: " + QString::number(data_.columnCount()) + " rows: " + QString::number(ui_.grid->rowCount()) + filter_info + page_info);
 }
 
 void MainWindow::dragEnterEvent(QDragEnterEvent* e)
@@ -937,5 +1472,5 @@ void MainWindow::setFile(QString name)
 bool MainWindow::isTsv(QString filename)
 {
     filename = filename.toLower();
-    return filename.endsWith(".tsv") || filename.endsWith(".tsv.gz");
+    return filename.endsWith(".tsv") || filename.endsWith(".tsv.gz") || filename.endsWith(".tsvb") || filename.endsWith(".arrow") || filename.endsWith(".feather");
 }
@@ -11,7 +11,10 @@
 #include "Smoothing.h"
 #include "DataSet.h"
 #include "FilterWidget.h"
+#include "ValueCountsWidget.h"
 #include "FileWatcher.h"
+#include <QFutureWatcher>
+#include <QProgressBar>
 
 class MainWindow
 		: public QMainWindow
@@ -31,15 +34,24 @@ public slots:
 	void on_exit_triggered(bool checked = false);
 	void on_newFile_triggered(bool);
     void on_openTsvFile_triggered(bool);
+    void on_openTsvRegion_triggered(bool);
+    void on_openTsvSample_triggered(bool);
     void on_actionImportTxtFile_triggered(bool);
 	void on_saveFile_triggered(bool);
     void on_actionSaveAs_triggered(bool);
     void on_actionExportHTML_triggered(bool);
     void on_actionExportCSV_triggered(bool);
+    void on_actionExportArrow_triggered(bool);
     void on_resizeColumnWidth_triggered(bool);
 	void on_resizeColumnHeightMinimum_triggered(bool);
 	void on_resizeColumnHeight_triggered(bool);
 	void on_goToRow_triggered(bool);
+	void on_goToRegion_triggered(bool);
+	void on_previousPage_triggered(bool);
+	void on_nextPage_triggered(bool);
+	void on_memoryBudget_triggered(bool);
+	void on_compressionLevel_triggered(bool);
+	void on_compressBinaryFiles_triggered(bool checked);
 	void on_findText_triggered(bool);
 	void on_filter_triggered(bool);
 	void on_toggleColumnIndex_triggered(bool);
@@ -57,6 +69,10 @@ public slots:
 	void scatterPlot();
 	void dataPlot();
 	void boxPlot();
+	void groupBy();
+	void joinWithFile();
+	void valueCounts();
+	void updateValueCounts();
 
 	void smoothAverage();
 	void smoothMedian();
@@ -76,6 +92,7 @@ public slots:
 	void dropEvent(QDropEvent* e);
 
 	void fileChanged();
+	void storeFinished();
 
 protected:
 	virtual void keyPressEvent(QKeyEvent* event);
@@ -89,6 +106,7 @@ private:
 	QStringList recent_files_;
 	GoToDockWidget* goto_widget_;
 	FilterWidget* filter_widget_;
+	ValueCountsWidget* value_counts_widget_;
 
 	///Open file struct
     QString filename_;
@@ -105,15 +123,38 @@ private:
 
 	QLabel* info_widget_;
 
+	///Background store struct
+	struct
+	{
+		QSharedPointer<DataSet> snapshot;
+		QString filename;
+		quint64 version;
+		bool is_export;
+		QFutureWatcher<QString> watcher;
+	}
+	store_;
+	QProgressBar* store_progress_;
+
 	void smooth_(Smoothing::Type type, QString suffix);
 	void updateWindowTitle_();
 	void closeEvent(QCloseEvent* event);
-    void openFile_(QString filename, bool remember_path=true, bool show_import_dialog=false);
+    void openFile_(QString filename, bool remember_path=true, bool show_import_dialog=false, QString region="", int sample_rows=0);
 	void storeModifiedDataset_();
+	//stores a snapshot of the dataset in a background thread
+	void store_(QString filename);
+	//exports a snapshot of the dataset in a background thread. The user is asked whether to export only filtered rows and selected columns.
+	void export_(QString filename, ExportFormat format);
+	//waits until a background store is finished
+	void waitForStore_();
 	void addToRecentFiles_(QString filename);
 	void updateRecentFilesMenu_();
     void setFile(QString name);
     static bool isTsv(QString filename);
+	void showPage_(int page);
+	//returns the memory budget in MB
+	static int memoryBudget_();
+	//returns the compression level for GZ files
+	static int compressionLevel_();
 };
 
 #endif
@@ -12,6 +12,9 @@
 #include <QClipboard>
 #include <QSpacerItem>
 #include <QXYSeries>
+#include <QValueAxis>
+#include <QDateTimeAxis>
+#include <QTimeZone>
 #include "BasePlot.h"
 #include "Settings.h"
 
@@ -260,3 +263,53 @@ QAbstractSeries* BasePlot::search(QString name) const
 
 	return nullptr;
 }
+
+QVector<double> BasePlot::columnValues(const DataSet& data, int column)
+{
+	DataSet::EvaluationScope scope(data);
+	if (data.column(column).type()==BaseColumn::DATETIME)
+	{
+		return data.dateTimeColumn(column).valuesAsDouble();
+	}
+
+	return data.numericColumn(column).values();
+}
+
+QAbstractAxis* BasePlot::createAxis(const DataSet& data, int column)
+{
+	DataSet::EvaluationScope scope(data);
+	if (data.column(column).type()==BaseColumn::DATETIME)
+	{
+		//show time only if the data contains times
+		bool has_time = false;
+		foreach(char format, data.dateTimeColumn(column).formats())
+		{
+			if (format & DateTimeColumn::HAS_TIME)
+			{
+				has_time = true;
+				break;
+			}
+		}
+
+		QDateTimeAxis* axis = new QDateTimeAxis();
+		axis->setFormat(has_time ? "yyyy-MM-dd hh:mm" : "yyyy-MM-dd");
+		axis->setTitleText(data.column(column).headerOrIndex(column));
+		return axis;
+	}
+
+	QValueAxis* axis = new QValueAxis();
+	axis->setTitleText(data.column(column).headerOrIndex(column));
+	return axis;
+}
+
+void BasePlot::setAxisRange(QAbstractAxis* axis, double min, double max)
+{
+	QDateTimeAxis* datetime_axis = qobject_cast<QDateTimeAxis*>(axis);
+	if (datetime_axis!=nullptr)
+	{
+		datetime_axis->setRange(QDateTime::fromMSecsSinceEpoch((qint64)min, QTimeZone::utc()), QDateTime::fromMSecsSinceEpoch((qint64)max, QTimeZone::utc()));
+		return;
+	}
+
+	axis->setRange(min, max);
+}
@@ -8,6 +8,7 @@
 #include "Parameters.h"
 #include "ParameterEditor.h"
 #include "MyChartView.h"
+#include "DataSet.h"
 
 class BasePlot
 		: public QWidget
@@ -42,6 +43,13 @@ protected:
 	void addToToolbar(QToolButton* button);
 	void addSeparatorToToolbar();
 
+	///Returns the values of a numeric or date/time column (date/time values as milliseconds since epoch).
+	static QVector<double> columnValues(const DataSet& data, int column);
+	///Creates an axis for a column: date/time axis for date/time columns and value axis otherwise.
+	static QAbstractAxis* createAxis(const DataSet& data, int column);
+	///Sets the axis range. Handles date/time axes, where @p min and @p max are milliseconds since epoch.
+	static void setAxisRange(QAbstractAxis* axis, double min, double max);
+
 protected slots:
 	void showSettings();
 };
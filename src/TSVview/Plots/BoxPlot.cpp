@@ -31,7 +31,7 @@ BoxPlot::BoxPlot(QWidget *parent)
 	connect(&params_, SIGNAL(valueChanged(QString)), this, SLOT(plot()));
 }
 
-void BoxPlot::setData(DataSet& data, QList<int> cols, QString filename)
+void BoxPlot::setData(const DataSet& data, QList<int> cols, QString filename)
 {
 	filename_ = filename;
 	data_ = &data;
@@ -49,6 +49,7 @@ void BoxPlot::plot()
 
 	//init
 	QBitArray filter = data_->getRowFilter(false);
+	DataSet::EvaluationScope scope(*data_);
 
 	//visible data series
 	QBoxPlotSeries* series = new QBoxPlotSeries();
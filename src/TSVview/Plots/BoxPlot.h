@@ -12,13 +12,13 @@ class BoxPlot
 
 public:
 	BoxPlot(QWidget* parent = 0);
-	void setData(DataSet& data, QList<int> cols, QString filename);
+	void setData(const DataSet& data, QList<int> cols, QString filename);
 
 protected slots:
 	void plot();
 
 private:
-	DataSet* data_;
+	const DataSet* data_;
 	QList<int> cols_;
 };
 
@@ -27,10 +27,25 @@ void DataPlot::setData(const DataSet& data, QList<int> cols, QString filename)
 {
 	//init
 	filename_ = filename;
+	DataSet::EvaluationScope scope(data);
 	QStringList line_types = QStringList() << "none" << "solid" << "dotted" << "dashed";
 	params_.blockSignals(true);
 	params_.clear();
 
+	//date/time column is used as X axis
+	int x_col = -1;
+	for (int i=0; i<cols.count(); ++i)
+	{
+		if (data.column(cols[i]).type()==BaseColumn::DATETIME)
+		{
+			x_col = cols[i];
+			cols.removeAt(i);
+			break;
+		}
+	}
+	QVector<double> x_values;
+	if (x_col!=-1) x_values = columnValues(data, x_col);
+
 	//check if there are duplicates names of series - use indices then
 	QStringList names;
 	for (int i=0; i<cols.count(); ++i)
@@ -64,7 +79,7 @@ void DataPlot::setData(const DataSet& data, QList<int> cols, QString filename)
 			double value = col.value(i);
 			if (!BasicStatistics::isValidFloat(value)) continue;
 
-			series->append(pos, value);
+			series->append(x_col==-1 ? pos : x_values[i], value);
 			pos += 1.0;
 		}
 
@@ -84,10 +99,25 @@ void DataPlot::setData(const DataSet& data, QList<int> cols, QString filename)
 	}
 
 	//format axes
-	chart_->createDefaultAxes();
-	QValueAxis* x_axis = qobject_cast<QValueAxis*>(chart_->axes(Qt::Horizontal).at(0));
-	x_axis->setTitleText("data point");
-	x_axis->setLabelFormat("%i");
+	if (x_col==-1)
+	{
+		chart_->createDefaultAxes();
+		QValueAxis* x_axis = qobject_cast<QValueAxis*>(chart_->axes(Qt::Horizontal).at(0));
+		x_axis->setTitleText("data point");
+		x_axis->setLabelFormat("%i");
+	}
+	else
+	{
+		QAbstractAxis* x_axis = createAxis(data, x_col);
+		chart_->addAxis(x_axis, Qt::AlignBottom);
+		QValueAxis* y_axis = new QValueAxis();
+		chart_->addAxis(y_axis, Qt::AlignLeft);
+		foreach(QAbstractSeries* series, chart_->series())
+		{
+			series->attachAxis(x_axis);
+			series->attachAxis(y_axis);
+		}
+	}
 	QValueAxis* y_axis = qobject_cast<QValueAxis*>(chart_->axes(Qt::Vertical).at(0));
 	y_axis->setTitleText("value");
 
@@ -36,10 +36,11 @@ HistogramPlot::HistogramPlot(QWidget *parent)
 	chart_->setDropShadowEnabled(false);
 }
 
-void HistogramPlot::setData(DataSet& data, int column, QString filename)
+void HistogramPlot::setData(const DataSet& data, int column, QString filename)
 {
 	filename_ = filename;
 	filter_ = data.getRowFilter(false);
+	DataSet::EvaluationScope scope(data);
 	col_ = data.numericColumn(column).values();
 	name_ = data.column(column).headerOrIndex(column);
 
@@ -13,7 +13,7 @@ class HistogramPlot
 
 public:
 	HistogramPlot(QWidget *parent = 0);
-	void setData(DataSet& data, int column, QString filename);
+	void setData(const DataSet& data, int column, QString filename);
 
 protected slots:
 	void parameterChanged(QString parameter);
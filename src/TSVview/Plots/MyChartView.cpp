@@ -1,5 +1,7 @@
 #include "MyChartView.h"
 #include <QDebug>
+#include <QDateTime>
+#include <QTimeZone>
 
 MyChartView::MyChartView(QWidget* parent)
 	: QChartView(parent)
@@ -22,7 +24,15 @@ void MyChartView::mouseMoveEvent(QMouseEvent* event)
 		QPointF chart_item_pos = chart()->mapFromScene(scene_pos);
 		QPointF pos = chart()->mapToValue(chart_item_pos);
 
-		emit xPosition("x:"+QString::number(pos.x()));
+		QList<QAbstractAxis*> x_axes = chart()->axes(Qt::Horizontal);
+		if (!x_axes.isEmpty() && x_axes.at(0)->type()==QAbstractAxis::AxisTypeDateTime)
+		{
+			emit xPosition("x:"+QDateTime::fromMSecsSinceEpoch((qint64)pos.x(), QTimeZone::utc()).toString(Qt::ISODate));
+		}
+		else
+		{
+			emit xPosition("x:"+QString::number(pos.x()));
+		}
 		emit yPosition("y:"+QString::number(pos.y()));
 	}
 	QChartView::mouseMoveEvent(event);
@@ -39,17 +39,17 @@ ScatterPlot::ScatterPlot(QWidget *parent)
 void ScatterPlot::setData(const DataSet& data, int col1, int col2, QString filename)
 {
 	filter_ = data.getRowFilter(false);
-	col1_ = data.numericColumn(col1).values();
-	col2_ = data.numericColumn(col2).values();
+	col1_ = columnValues(data, col1);
+	col2_ = columnValues(data, col2);
 	filename_ = filename;
 
+	//create axes (date/time columns are shown on a time axis)
+	chart_->addAxis(createAxis(data, col1), Qt::AlignBottom);
+	chart_->addAxis(createAxis(data, col2), Qt::AlignLeft);
+
 	//create series of visible data
 	addSeries();
 
-	//set axes labels
-	chart_->axes(Qt::Horizontal).at(0)->setTitleText(data.numericColumn(col1).headerOrIndex(col1));
-	chart_->axes(Qt::Vertical).at(0)->setTitleText(data.numericColumn(col2).headerOrIndex(col2));
-
 	//show chart
 	chart_view_->setChart(chart_);
 }
@@ -133,8 +133,8 @@ void ScatterPlot::parameterChanged(QString parameter)
 
 		//reset zoom range
 		QRectF bb = getBoundingBox();
-		chart_->axes(Qt::Horizontal).at(0)->setRange(bb.x(), bb.x() + bb.width());
-		chart_->axes(Qt::Vertical).at(0)->setRange(bb.y() + bb.height(), bb.y());
+		setAxisRange(chart_->axes(Qt::Horizontal).at(0), bb.x(), bb.x() + bb.width());
+		setAxisRange(chart_->axes(Qt::Vertical).at(0), bb.y() + bb.height(), bb.y());
 	}
 	else if (parameter=="filtered color")
 	{
@@ -1,7 +1,7 @@
 # -------------------------------------------------
 # Project created by QtCreator 2010-03-29T13:28:53
 # -------------------------------------------------
-QT += core widgets gui xml svg qml charts
+QT += core widgets gui xml svg charts concurrent
 TARGET = TSVview
 TEMPLATE = app
 RC_FILE	 = icon.rc
@@ -35,14 +35,32 @@ SOURCES += \
     Base/BaseColumn.cpp \
     Base/NumericColumn.cpp \
     Base/StringColumn.cpp \
+    Base/DateTimeColumn.cpp \
+    Base/RadixSort.cpp \
+    Base/RowKeys.cpp \
+    Base/IntervalIndex.cpp \
+    Base/BgzfReader.cpp \
+    Base/BgzfWriter.cpp \
+    Base/ArrowFile.cpp \
+    Base/TabixIndex.cpp \
+    Base/PagedFile.cpp \
     FileIO/FilePreview.cpp \
     GoToDockWidget.cpp \
     FindDockWidget.cpp \
     FilterWidget.cpp \
+    ValueCountsWidget.cpp \
     Base/Filter.cpp \
     FilterDialog.cpp \
     Base/ReplacementDialog.cpp \
     Base/MergeDialog.cpp \
+    Base/SortDialog.cpp \
+    Base/PivotDialog.cpp \
+    Base/GroupBy.cpp \
+    Base/JoinDialog.cpp \
+    Base/Join.cpp \
+    Base/ValueCounts.cpp \
+    Base/Expression.cpp \
+    Base/VirtualColumn.cpp \
     Statistics/StatisticsSummary.cpp \
     Statistics/StatisticsSummaryWidget.cpp \
     AddColumnDialog.cpp \
@@ -67,14 +85,32 @@ HEADERS += \
     Base/BaseColumn.h \
     Base/NumericColumn.h \
     Base/StringColumn.h \
+    Base/DateTimeColumn.h \
+    Base/RadixSort.h \
+    Base/RowKeys.h \
+    Base/IntervalIndex.h \
+    Base/BgzfReader.h \
+    Base/BgzfWriter.h \
+    Base/ArrowFile.h \
+    Base/TabixIndex.h \
+    Base/PagedFile.h \
     FileIO/FilePreview.h \
     GoToDockWidget.h \
     FindDockWidget.h \
     FilterWidget.h \
+    ValueCountsWidget.h \
     Base/Filter.h \ 
     FilterDialog.h \
     Base/ReplacementDialog.h \
     Base/MergeDialog.h \
+    Base/SortDialog.h \
+    Base/PivotDialog.h \
+    Base/GroupBy.h \
+    Base/JoinDialog.h \
+    Base/Join.h \
+    Base/ValueCounts.h \
+    Base/Expression.h \
+    Base/VirtualColumn.h \
     Statistics/StatisticsSummary.h \
     Statistics/StatisticsSummaryWidget.h \
     AddColumnDialog.h \
@@ -88,9 +124,13 @@ FORMS += \
     GoToDockWidget.ui \
     FindDockWidget.ui \
     FilterWidget.ui \
+    ValueCountsWidget.ui \
     FilterDialog.ui \
     Base/ReplacementDialog.ui \
     Base/MergeDialog.ui \
+    Base/SortDialog.ui \
+    Base/PivotDialog.ui \
+    Base/JoinDialog.ui \
     Statistics/StatisticsSummaryWidget.ui \
     AddColumnDialog.ui \
     TextItemEditDialog.ui
@@ -0,0 +1,69 @@
+#include "ValueCountsWidget.h"
+#include "ValueCounts.h"
+#include <QApplication>
+#include <cmath>
+
+ValueCountsWidget::ValueCountsWidget(QWidget* parent)
+	: QDockWidget(parent)
+	, column_(-1)
+{
+	ui_.setupUi(this);
+	connect(ui_.counts, SIGNAL(cellDoubleClicked(int, int)), this, SLOT(valueDoubleClicked(int)));
+}
+
+void ValueCountsWidget::setColumn(const DataSet& dataset, int column)
+{
+	column_ = column;
+	show();
+	renderCounts(dataset);
+}
+
+void ValueCountsWidget::renderCounts(const DataSet& dataset)
+{
+	if (isHidden()) return;
+
+	ui_.counts->setSortingEnabled(false);
+	ui_.counts->setRowCount(0);
+	if (column_<0 || column_>=dataset.columnCount())
+	{
+		column_ = -1;
+		ui_.info->setText("No column selected.");
+		return;
+	}
+
+	//count values of filtered rows
+	QApplication::setOverrideCursor(Qt::BusyCursor);
+	const QBitArray rows = dataset.getRowFilter();
+	const QVector<ValueCounts::Entry> entries = ValueCounts::count(dataset, column_, rows);
+	const double total = rows.count(true);
+
+	const BaseColumn& column = dataset.column(column_);
+	const int shown = std::min((int)entries.count(), MAX_VALUES);
+	QString info = "Column: " + column.headerOrIndex(column_) + "\nDistinct values: " + QString::number(entries.count()) + " in " + QString::number(rows.count(true)) + " rows";
+	if (shown<entries.count()) info += "\nShowing the " + QString::number(shown) + " most frequent values";
+	ui_.info->setText(info);
+
+	//show values (counts and percentages are numbers, so that they are sorted numerically)
+	ui_.counts->setRowCount(shown);
+	for (int i=0; i<shown; ++i)
+	{
+		const ValueCounts::Entry& entry = entries[i];
+		ui_.counts->setItem(i, 0, new QTableWidgetItem(column.string(entry.row)));
+		QTableWidgetItem* item = new QTableWidgetItem();
+		item->setData(Qt::DisplayRole, entry.count);
+		ui_.counts->setItem(i, 1, item);
+		item = new QTableWidgetItem();
+		item->setData(Qt::DisplayRole, std::round(10000.0 * entry.count / total) / 100.0);
+		ui_.counts->setItem(i, 2, item);
+	}
+	ui_.counts->setSortingEnabled(true);
+	ui_.counts->resizeColumnToContents(0);
+	QApplication::restoreOverrideCursor();
+}
+
+void ValueCountsWidget::valueDoubleClicked(int row)
+{
+	if (column_==-1) return;
+
+	emit filterValue(column_, ui_.counts->item(row, 0)->text());
+}
@@ -0,0 +1,42 @@
+#ifndef VALUECOUNTSWIDGET_H
+#define VALUECOUNTSWIDGET_H
+
+#include <QDockWidget>
+#include "DataSet.h"
+#include "ui_ValueCountsWidget.h"
+
+///Dock widget that shows the distinct values of a column with counts and percentages (of the filtered rows).
+class ValueCountsWidget
+		: public QDockWidget
+{
+	Q_OBJECT
+
+public:
+	ValueCountsWidget(QWidget* parent = 0);
+
+	///Returns the column, or -1 if no column is set.
+	int column() const
+	{
+		return column_;
+	}
+	///Sets the column and counts its values.
+	void setColumn(const DataSet& dataset, int column);
+	///Counts the values of the column again, e.g. after the data or the filters changed. Does nothing if the widget is hidden.
+	void renderCounts(const DataSet& dataset);
+
+	///Maximum number of values shown (the most frequent ones).
+	static const int MAX_VALUES = 10000;
+
+signals:
+	///Emitted when a value is double-clicked.
+	void filterValue(int column, QString value);
+
+private slots:
+	void valueDoubleClicked(int row);
+
+private:
+	Ui::ValueCountsWidget ui_;
+	int column_;
+};
+
+#endif // VALUECOUNTSWIDGET_H